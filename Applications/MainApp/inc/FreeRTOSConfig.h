@@ -39,6 +39,8 @@
 
 #define configUSE_PREEMPTION					1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION	0
+#define configUSE_BITMAP_TASK_SELECTION			1	/* Constant time selection, whatever configMAX_PRIORITIES. */
+#define configUSE_PRIORITY_EVENT_LISTS			1	/* Constant time blocking on queues and semaphores. */
 #define configUSE_IDLE_HOOK						1
 #define configUSE_TICK_HOOK						1
 #define configUSE_DAEMON_TASK_STARTUP_HOOK		1
@@ -69,12 +71,57 @@ configMAX_PRIORITIES - 1. */
 #define configTIMER_QUEUE_LENGTH				20
 #define configTIMER_TASK_STACK_DEPTH			( configMINIMAL_STACK_SIZE * 2 )
 
+/* Active timers are kept in a timing wheel as well, so that starting, stopping
+and expiring them takes constant time however many are running. */
+#define configUSE_TIMER_WHEEL					1
+
 #define configMAX_PRIORITIES					( 7 )
 
+/* Delayed tasks are kept in a timing wheel, so that the periodic tasks of the
+application are delayed and woken in constant time. */
+#define configUSE_TIMING_WHEEL					1
+#define configTIMING_WHEEL_BITS					6
+
+/* The POSIX port takes its tick from a timer thread, so that critical sections
+do not cost two system calls each. */
+#define portUSE_TICK_THREAD						1
+
+/* Threads the POSIX port creates up front for the tasks: the seven tasks of
+the application and the one of a benchmark.  Deleted tasks give their thread
+back for the next task. */
+#define portTHREAD_POOL_SIZE					8
+
+/* The idle task stops the tick when no task is due for a few ticks. */
+#define configUSE_TICKLESS_IDLE					1
+
+/* Host threads of the POSIX port the processing workers run their DSP chains
+on, to process the channels on several host CPUs.  The hand over costs more
+than the default chain on a single CPU, "make HOST_CORES=0" runs the chains in
+the workers instead.  The workers wait for the host cores on the last task
+notification index. */
+#ifndef portHOST_CORES
+	#define portHOST_CORES						2
+#endif
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES	2
+
+/* Stream buffers exchange data without critical sections, so that the stdin
+reader thread can write the console input straight into one. */
+#define configUSE_LOCK_FREE_STREAM_BUFFERS		1
+
+/* Queue items can be written and read in the queue storage, exercised by the
+"selftest" command. */
+#define configUSE_QUEUE_IN_PLACE				1
+
+/* Message buffers any number of tasks can send to and receive from, exercised
+by the "selftest" command. */
+#define configUSE_SHARED_MESSAGE_BUFFERS		1
+
 /* Run time stats gathering configuration options. */
 unsigned long ulGetRunTimeCounterValue( void ); /* Prototype of function that returns run time counter. */
 void vConfigureTimerForRunTimeStats( void );	/* Prototype of function that initialises the run time counter. */
 #define configGENERATE_RUN_TIME_STATS			1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	vConfigureTimerForRunTimeStats()
+#define portGET_RUN_TIME_COUNTER_VALUE()		ulGetRunTimeCounterValue()
 
 /* Co-routine related configuration options. */
 #define configUSE_CO_ROUTINES 					0
@@ -86,6 +133,10 @@ readable ASCII form.  See the notes in the implementation of vTaskList() within
 FreeRTOS/Source/tasks.c for limitations. */
 #define configUSE_STATS_FORMATTING_FUNCTIONS	1
 
+/* Size of the buffer the FreeRTOS+CLI commands write their output to.  It has
+to hold the text form of all the processed values printed by "obter". */
+#define configCOMMAND_INT_MAX_OUTPUT_SIZE		16384
+
 /* Enables the test whereby a stack larger than the total heap size is
 requested. */
 #define configSTACK_DEPTH_TYPE uint32_t
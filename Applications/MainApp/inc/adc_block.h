@@ -0,0 +1,171 @@
+/*
+ * Block based hand-off of ADC samples between the acquisition and the
+ * processing tasks.
+ *
+ * Samples are written in place into fixed-size blocks taken from a static
+ * pool.  Only pointers to the blocks travel through the kernel queues, so
+ * ownership of a whole block moves from the producer to the consumer without
+ * copying the samples themselves.
+ *
+ * The producer can either manage blocks itself or write one sample at a time
+ * with xAdcBlockWrite(), which applies the overload policy of the pool when
+ * the consumer falls behind:
+ *   eAdcOverloadWait      - wait up to a timeout for a free block, then drop
+ *                           the sample.
+ *   eAdcOverloadOverwrite - take back the oldest block not yet received by
+ *                           the consumer and overwrite it, so the pool always
+ *                           holds the newest samples.
+ *   eAdcOverloadDecimate  - while few free blocks are left, keep only one
+ *                           sample out of a configurable factor, so the same
+ *                           blocks cover a longer time.
+ * Lost samples are counted in the pool statistics whatever the policy.
+ */
+
+#ifndef ADC_BLOCK_H
+#define ADC_BLOCK_H
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of samples carried by each block. */
+#ifndef adcBLOCK_SAMPLES
+    #define adcBLOCK_SAMPLES        100
+#endif
+
+/* Number of blocks owned by a pool.  This bounds the amount of data that can
+be in flight between the producer and the consumer. */
+#ifndef adcBLOCK_POOL_SIZE
+    #define adcBLOCK_POOL_SIZE      4
+#endif
+
+/* Decimation starts when no more than this many blocks are free. */
+#ifndef adcDECIMATE_LOW_WATER
+    #define adcDECIMATE_LOW_WATER   1
+#endif
+
+typedef enum
+{
+    eAdcOverloadWait = 0,
+    eAdcOverloadOverwrite,
+    eAdcOverloadDecimate
+} eAdcOverloadPolicy;
+
+typedef struct AdcBlock
+{
+    uint32_t ulSequence;                        /* Set by the pool each time the block is submitted. */
+    uint32_t ulCount;                           /* Number of valid entries in usSamples. */
+    uint32_t ulStride;                          /* Sample periods between two entries, more than 1 when decimated. */
+    uint32_t ulFirstTime;                       /* Run time clock when the first and the last samples were */
+    uint32_t ulLastTime;                        /* written by xAdcBlockWrite(). */
+    uint16_t usSamples[ adcBLOCK_SAMPLES ];
+} AdcBlock_t;
+
+/* Samples lost or delayed by the producer, in sample periods. */
+typedef struct AdcBlockStats
+{
+    uint32_t ulDropped;                         /* No block was available. */
+    uint32_t ulOverwritten;                     /* Discarded from a block taken back from the consumer. */
+    uint32_t ulDecimated;                       /* Skipped on purpose under pressure. */
+    uint32_t ulLate;                            /* Written after their sample period had passed. */
+} AdcBlockStats_t;
+
+typedef struct AdcBlockPool
+{
+    AdcBlock_t xBlocks[ adcBLOCK_POOL_SIZE ];
+
+    /* Blocks available to the producer. */
+    QueueHandle_t xFreeQueue;
+    StaticQueue_t xFreeQueueBuffer;
+    uint8_t ucFreeQueueStorage[ adcBLOCK_POOL_SIZE * sizeof( AdcBlock_t * ) ];
+
+    /* Filled blocks waiting for the consumer. */
+    QueueHandle_t xReadyQueue;
+    StaticQueue_t xReadyQueueBuffer;
+    uint8_t ucReadyQueueStorage[ adcBLOCK_POOL_SIZE * sizeof( AdcBlock_t * ) ];
+
+    uint32_t ulNextSequence;
+
+    /* State of xAdcBlockWrite(), only used by the producer. */
+    AdcBlock_t *pxFilling;
+    uint32_t ulPhase;
+
+    eAdcOverloadPolicy ePolicy;
+    TickType_t xWaitTicks;
+    uint32_t ulDecimateFactor;
+    AdcBlockStats_t xStats;
+} AdcBlockPool_t;
+
+/*
+ * Creates the queues of the pool and places every block on the free queue.
+ * pcName, if not NULL, is used to register the ready queue.  Returns pdFAIL
+ * if the queues could not be created.
+ */
+BaseType_t xAdcBlockPoolInit( AdcBlockPool_t *pxPool, const char *pcName );
+
+/*
+ * Producer side.  pxAdcBlockAcquire() returns an empty block, or NULL if none
+ * became free within xTicksToWait.  vAdcBlockSubmit() passes a filled block
+ * to the consumer; it never blocks as the ready queue can hold every block of
+ * the pool.
+ */
+AdcBlock_t *pxAdcBlockAcquire( AdcBlockPool_t *pxPool, TickType_t xTicksToWait );
+void vAdcBlockSubmit( AdcBlockPool_t *pxPool, AdcBlock_t *pxBlock );
+
+/*
+ * Consumer side.  pxAdcBlockReceive() returns the oldest filled block, or NULL
+ * if none arrived within xTicksToWait.  vAdcBlockRelease() gives a block back
+ * to the producer once its samples have been consumed.
+ */
+AdcBlock_t *pxAdcBlockReceive( AdcBlockPool_t *pxPool, TickType_t xTicksToWait );
+void vAdcBlockRelease( AdcBlockPool_t *pxPool, AdcBlock_t *pxBlock );
+
+/*
+ * Batched consumer side, one queue operation per batch.
+ * uxAdcBlockReceiveMultiple() takes up to uxMaxBlocks of the oldest filled
+ * blocks without blocking and returns how many it took.
+ * vAdcBlockReleaseMultiple() gives uxBlocks blocks back to the producer.
+ */
+UBaseType_t uxAdcBlockReceiveMultiple( AdcBlockPool_t *pxPool, AdcBlock_t **ppxBlocks, UBaseType_t uxMaxBlocks );
+void vAdcBlockReleaseMultiple( AdcBlockPool_t *pxPool, AdcBlock_t * const *ppxBlocks, UBaseType_t uxBlocks );
+
+/*
+ * Policy aware producer.  xAdcBlockWrite() appends one sample to the block
+ * being filled, taking a new block according to the overload policy when
+ * needed, and submits the block once it is full.  xLate tells that the sample
+ * was taken after its period.  Returns pdFAIL if the sample was not stored.
+ * The block records when its first and last samples were written, with the
+ * run time stats clock, so the consumer can measure their latency.
+ * vAdcBlockDrop() accounts for sample periods that were missed entirely.
+ */
+BaseType_t xAdcBlockWrite( AdcBlockPool_t *pxPool, uint16_t usSample, BaseType_t xLate );
+void vAdcBlockDrop( AdcBlockPool_t *pxPool, uint32_t ulSamples );
+
+/* Submits the block being filled by xAdcBlockWrite(), if it holds samples. */
+void vAdcBlockSubmitPartial( AdcBlockPool_t *pxPool );
+
+/*
+ * Selects the overload policy, eAdcOverloadWait by default with no wait.
+ * xWaitTicks is used by eAdcOverloadWait and ulDecimateFactor by
+ * eAdcOverloadDecimate.
+ */
+void vAdcBlockSetPolicy( AdcBlockPool_t *pxPool, eAdcOverloadPolicy ePolicy,
+                         TickType_t xWaitTicks, uint32_t ulDecimateFactor );
+
+/* Copies the loss counters. */
+void vAdcBlockGetStats( AdcBlockPool_t *pxPool, AdcBlockStats_t *pxStats );
+
+/* Returns every block waiting for the consumer to the free queue. */
+void vAdcBlockPoolFlush( AdcBlockPool_t *pxPool );
+
+/* Number of filled blocks waiting for the consumer. */
+UBaseType_t uxAdcBlocksReady( AdcBlockPool_t *pxPool );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADC_BLOCK_H */
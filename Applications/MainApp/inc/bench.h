@@ -0,0 +1,130 @@
+/*
+ * End-to-end benchmark of a channel pipeline.
+ *
+ * xBenchRun() feeds a channel from a synthetic source task for a given time,
+ * either at a fixed rate or as fast as the pipeline accepts samples, then
+ * waits for the workers to process what was produced.  Every sample is timed
+ * from its write into a block to the end of its processing (see latency.h),
+ * and the report gives the latency distribution together with the sustained
+ * throughput and the samples lost on the way.
+ *
+ * At a fixed rate the source never waits, so a pipeline that cannot keep up
+ * shows up as dropped samples.  As fast as possible, the source waits for
+ * free blocks, so the throughput is the one the pipeline can sustain.
+ *
+ * The channel must be processed by the channel scheduler, but not sampled by
+ * its acquisition task, and should have xWrap set so it never completes.
+ *
+ * xBenchRunSwitch() measures the cost of a context switch on its own, with
+ * two tasks handing a notification back and forth.
+ *
+ * xBenchRunChurn() measures the cost of creating a task, running it until it
+ * blocks and deleting it.
+ *
+ * xBenchRunJitter() measures how the periods of vTaskDelayUntil() land on the
+ * host clock, to tell how much the host delays the ticks and the tasks (see
+ * the host scheduling options of the POSIX port in portmacro.h).
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+#include "adc_block.h"
+#include "channel.h"
+#include "latency.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Frequency of the run time stats clock used for the timestamps. */
+#ifndef benchCLOCK_HZ
+    #define benchCLOCK_HZ       1000000UL
+#endif
+
+typedef struct BenchReport
+{
+    uint32_t ulRateHz;              /* 0 when run as fast as possible. */
+    uint32_t ulDuration;            /* Run time clock units the source ran for. */
+    uint64_t ullProduced;
+    uint64_t ullProcessed;
+    AdcBlockStats_t xLosses;
+    LatencyHistogram_t xLatency;
+} BenchReport_t;
+
+typedef struct BenchSwitchReport
+{
+    uint32_t ulSwitches;
+    uint32_t ulDuration;            /* Run time clock units for all of them. */
+} BenchSwitchReport_t;
+
+typedef struct BenchChurnReport
+{
+    uint32_t ulTasks;
+    uint32_t ulDuration;            /* Run time clock units for all of them. */
+} BenchChurnReport_t;
+
+typedef struct BenchJitterReport
+{
+    TickType_t xPeriod;
+    uint32_t ulPeriods;
+    uint32_t ulDuration;            /* Run time clock units for all of them. */
+    uint32_t ulMinInterval;         /* Shortest and longest period measured. */
+    uint32_t ulMaxInterval;
+    LatencyHistogram_t xJitter;     /* Distance of each period from xPeriod. */
+} BenchJitterReport_t;
+
+/*
+ * Runs the benchmark on pxChannel for xDuration ticks, with the source task
+ * at priority uxPriority and producing ulRateHz samples per second, or as many
+ * as possible if ulRateHz is 0.  Blocks the calling task until the report is
+ * complete.  The channel is reset first and its overload policy is restored
+ * afterwards.  Returns pdFAIL if the source task could not be created.
+ */
+BaseType_t xBenchRun( Channel_t *pxChannel, uint32_t ulRateHz, TickType_t xDuration,
+                      UBaseType_t uxPriority, BenchReport_t *pxReport );
+
+/* Writes the report as a single JSON object, returns the characters written. */
+size_t xBenchFormatJson( const BenchReport_t *pxReport, char *pcBuffer, size_t xBufferSize );
+
+/*
+ * Hands a notification ulRoundTrips times between the calling task and a task
+ * created at priority uxPriority, which must be above the priority of the
+ * caller, so that every hand over is a context switch.  Returns pdFAIL if the
+ * task could not be created.
+ */
+BaseType_t xBenchRunSwitch( uint32_t ulRoundTrips, UBaseType_t uxPriority, BenchSwitchReport_t *pxReport );
+
+size_t xBenchFormatSwitchJson( const BenchSwitchReport_t *pxReport, char *pcBuffer, size_t xBufferSize );
+
+/*
+ * Creates ulTasks tasks one after the other at priority uxPriority, which must
+ * be above the priority of the caller, so that each one runs until it blocks,
+ * and deletes each one before creating the next.  Returns pdFAIL if a task
+ * could not be created.
+ */
+BaseType_t xBenchRunChurn( uint32_t ulTasks, UBaseType_t uxPriority, BenchChurnReport_t *pxReport );
+
+size_t xBenchFormatChurnJson( const BenchChurnReport_t *pxReport, char *pcBuffer, size_t xBufferSize );
+
+/*
+ * Runs a task at priority uxPriority that waits ulPeriods periods of xPeriod
+ * ticks with vTaskDelayUntil(), timing each one on the run time stats clock.
+ * Blocks the calling task until the report is complete.  Returns pdFAIL if
+ * the task could not be created.
+ */
+BaseType_t xBenchRunJitter( TickType_t xPeriod, uint32_t ulPeriods, UBaseType_t uxPriority,
+                            BenchJitterReport_t *pxReport );
+
+size_t xBenchFormatJitterJson( const BenchJitterReport_t *pxReport, char *pcBuffer, size_t xBufferSize );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_H */
@@ -0,0 +1,142 @@
+/*
+ * Independent acquisition and processing pipelines, one per channel.
+ *
+ * Every channel owns its sample source and rate, its block pool (with its own
+ * overload policy and loss counters), its DSP chain, its buffer of processed
+ * values and its statistics.  The channel scheduler runs all of them with a
+ * fixed number of tasks, whatever the number of channels:
+ *
+ *  - one acquisition task ticks every kernel tick and takes a sample from each
+ *    channel that is due, catching up (and flagging the samples as late) if
+ *    it was delayed;
+ *  - when a channel submits a full block it is appended to a shared queue of
+ *    ready channels, unless it is already in it;
+ *  - a pool of worker tasks takes channels from that queue and processes at
+ *    most channelBATCH_MAX_BLOCKS blocks of one channel before putting it back
+ *    at the end of the queue, so busy channels cannot starve the others;
+ *  - the DSP chain of a batch runs on a host core of the POSIX port (see
+ *    vPortRunOnHostCore()), so the workers process their channels in
+ *    parallel on the host CPUs.
+ *
+ * The acquisition task samples every channel, so an eAdcOverloadWait policy
+ * with a timeout holds up all of them while it waits.
+ *
+ * A channel is processed by a single worker at a time.  Once its buffer of
+ * processed values is full the channel is complete: its blocks are no longer
+ * processed, and acquisition keeps going under the overload policy, until
+ * vChannelReset() is called.
+ */
+
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#include "adc_block.h"
+#include "dsp.h"
+#include "latency.h"
+#include "snapshot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of channels the scheduler can run. */
+#ifndef channelMAX_CHANNELS
+    #define channelMAX_CHANNELS             256
+#endif
+
+/* Blocks of one channel processed before a worker moves on to the next. */
+#ifndef channelBATCH_MAX_BLOCKS
+    #define channelBATCH_MAX_BLOCKS         adcBLOCK_POOL_SIZE
+#endif
+
+/* Sample periods a channel may fall behind before the acquisition task stops
+catching up and counts the missed periods as dropped. */
+#ifndef channelMAX_CATCH_UP_PERIODS
+    #define channelMAX_CATCH_UP_PERIODS     10
+#endif
+
+/* Returns the next raw sample of a channel. */
+typedef uint16_t ( *ChannelSource_t )( void *pvContext );
+
+/* Samples processed per batch, a batch being one turn of a worker. */
+typedef struct ChannelStats
+{
+    uint32_t ulBatches;
+    uint32_t ulLastBatch;
+    uint32_t ulMaxBatch;
+    uint64_t ullTotalSamples;
+} ChannelStats_t;
+
+typedef struct Channel
+{
+    const char *pcName;
+    TickType_t xPeriod;
+    TickType_t xNextSample;
+    ChannelSource_t pxSource;
+    void *pvSourceContext;
+
+    AdcBlockPool_t xPool;
+    uint32_t ulScheduledSequence;   /* Sequence of the next block the scheduler has not seen. */
+
+    /* Run over every block, the caller appends the stages after
+    xChannelInit().  The stages run on a host core and must not use the
+    FreeRTOS API. */
+    DspChain_t xChain;
+
+    Snapshot_t xSnapshot;
+    size_t xPosition;
+    volatile BaseType_t xComplete;
+    BaseType_t xWrap;               /* Set to pdTRUE to use the values as a ring that never completes. */
+    ChannelStats_t xStats;
+    LatencyHistogram_t xLatency;    /* From the write of each sample to the end of its processing. */
+
+    BaseType_t xScheduled;          /* In the queue of ready channels. */
+    SemaphoreHandle_t xLock;        /* Held by the worker processing the channel. */
+    StaticSemaphore_t xLockBuffer;
+} Channel_t;
+
+/*
+ * Prepares a channel sampling pxSource every xPeriod ticks into the
+ * xCapacity processed values of pfValues.  The DSP chain is left empty.
+ * Returns pdFAIL if the block pool could not be created.
+ */
+BaseType_t xChannelInit( Channel_t *pxChannel, const char *pcName, TickType_t xPeriod,
+                         ChannelSource_t pxSource, void *pvSourceContext,
+                         float *pfValues, size_t xCapacity );
+
+/*
+ * Creates the acquisition task and uxWorkers worker tasks running the xCount
+ * channels of pxChannels, which must stay valid for as long as the scheduler
+ * runs.  Can only be called once.  Returns pdFAIL if a task could not be
+ * created.
+ */
+BaseType_t xChannelSchedulerStart( Channel_t *pxChannels, size_t xCount, UBaseType_t uxWorkers,
+                                   UBaseType_t uxAcquisitionPriority, UBaseType_t uxWorkerPriority );
+
+/*
+ * Discards the pending blocks and processed values and restarts the capture,
+ * with new processing statistics and latency histogram.  The loss counters of
+ * the block pool keep counting.
+ */
+void vChannelReset( Channel_t *pxChannel );
+
+/*
+ * For channels that are not sampled by the acquisition task but by a task of
+ * their own: vChannelWrite() writes one sample and schedules the channel when
+ * a block is full, vChannelSubmitPartial() hands over the samples written so
+ * far.  Only one task may write to a channel.
+ */
+void vChannelWrite( Channel_t *pxChannel, uint16_t usSample, BaseType_t xLate );
+void vChannelSubmitPartial( Channel_t *pxChannel );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CHANNEL_H */
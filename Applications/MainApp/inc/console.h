@@ -27,6 +27,10 @@
 #ifndef CONSOLE_H
 #define CONSOLE_H
 
+#include <stddef.h>
+
+#include <FreeRTOS.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -35,8 +39,24 @@ extern "C" {
  * Example console I/O wrappers.
  *----------------------------------------------------------*/
 
+/* Simulated interrupt the stdin reader thread raises to wake console_read() */
+#ifndef consoleRX_INTERRUPT
+    #define consoleRX_INTERRUPT     2
+#endif
+
+/* Bytes of stdin buffered for console_read() */
+#ifndef consoleRX_BUFFER_SIZE
+    #define consoleRX_BUFFER_SIZE   256
+#endif
+
 void console_init(void);
 void console_print(const char *fmt, ...);
+void console_write(const char *buf, size_t len);
+
+/* Starts reading stdin. console_read() blocks until at least one byte is
+available or xTicksToWait expires, and returns the number of bytes read. */
+void console_input_init(void);
+size_t console_read(char *buf, size_t len, TickType_t xTicksToWait);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,160 @@
+/*
+ * Block DSP kernels used by the processing stage.
+ *
+ * Every kernel works in place on a block of float samples.  Kernels that can
+ * be expressed as a DspKernel_t can be linked together in a DspChain_t, which
+ * runs them in order over each block.  A kernel returns the number of samples
+ * left in the block, so stages such as the decimator or the FFT can shrink it.
+ *
+ * When the compiler targets AVX or SSE (the default on x86_64) the inner
+ * loops use the matching intrinsics; otherwise portable C versions are built.
+ */
+
+#ifndef DSP_H
+#define DSP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of stages in a chain. */
+#ifndef dspMAX_CHAIN_STAGES
+    #define dspMAX_CHAIN_STAGES     8
+#endif
+
+typedef size_t ( *DspKernel_t )( void *pvContext, float *pfBlock, size_t xLength );
+
+typedef struct DspStage
+{
+    DspKernel_t pxKernel;
+    void *pvContext;
+} DspStage_t;
+
+typedef struct DspChain
+{
+    DspStage_t xStages[ dspMAX_CHAIN_STAGES ];
+    size_t xNumStages;
+} DspChain_t;
+
+void vDspChainInit( DspChain_t *pxChain );
+
+/* Returns pdFAIL if the chain already holds dspMAX_CHAIN_STAGES stages. */
+BaseType_t xDspChainAppend( DspChain_t *pxChain, DspKernel_t pxKernel, void *pvContext );
+
+/* Runs every stage over the block and returns the resulting block length. */
+size_t xDspChainRun( const DspChain_t *pxChain, float *pfBlock, size_t xLength );
+
+/*-----------------------------------------------------------*/
+
+/* Converts raw ADC samples to floats. */
+void vDspConvertU16( const uint16_t *pusIn, float *pfOut, size_t xLength );
+
+/*-----------------------------------------------------------*/
+
+/* y = x * fGain + fOffset. */
+typedef struct DspGain
+{
+    float fGain;
+    float fOffset;
+} DspGain_t;
+
+void vDspGainOffset( float *pfBlock, size_t xLength, float fGain, float fOffset );
+size_t xDspGainKernel( void *pvContext, float *pfBlock, size_t xLength );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * FIR filter keeping its delay line between blocks.  The workspace passed to
+ * vDspFirInit() must hold dspFIR_WORKSPACE_SIZE() floats; it receives a copy
+ * of the coefficients (reversed, so the inner loop is a straight dot product)
+ * followed by the delay line.  Blocks must not be longer than xMaxBlock.
+ */
+#define dspFIR_WORKSPACE_SIZE( xTaps, xMaxBlock )    ( ( 2 * ( xTaps ) ) - 1 + ( xMaxBlock ) )
+
+typedef struct DspFir
+{
+    const float *pfReversedCoeffs;
+    float *pfDelayLine;
+    size_t xTaps;
+    size_t xMaxBlock;
+} DspFir_t;
+
+void vDspFirInit( DspFir_t *pxFir, const float *pfCoeffs, size_t xTaps,
+                  float *pfWorkspace, size_t xMaxBlock );
+size_t xDspFirKernel( void *pvContext, float *pfBlock, size_t xLength );
+
+/*
+ * Windowed-sinc (Hamming) low pass design with unity gain at DC.  fCutoff is
+ * relative to the sample rate and must be between 0 and 0.5.
+ */
+void vDspDesignLowPass( float *pfCoeffs, size_t xTaps, float fCutoff );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * IIR filter built from a cascade of biquads in transposed direct form II:
+ *   y = b0 * x + z1;  z1 = b1 * x - a1 * y + z2;  z2 = b2 * x - a2 * y.
+ * Each sample depends on the previous output, so this kernel is scalar.
+ */
+typedef struct DspBiquad
+{
+    float fB0, fB1, fB2;
+    float fA1, fA2;
+    float fZ1, fZ2;
+} DspBiquad_t;
+
+typedef struct DspIir
+{
+    DspBiquad_t *pxSections;
+    size_t xNumSections;
+} DspIir_t;
+
+size_t xDspIirKernel( void *pvContext, float *pfBlock, size_t xLength );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Keeps one sample out of every xFactor, carrying the phase over from one
+ * block to the next.  Run a low pass FIR before it to avoid aliasing.
+ */
+typedef struct DspDecimator
+{
+    size_t xFactor;
+    size_t xPhase;
+} DspDecimator_t;
+
+size_t xDspDecimateKernel( void *pvContext, float *pfBlock, size_t xLength );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Radix-2 FFT of xSize complex points (interleaved real and imaginary parts),
+ * computed in place.  xSize must be a power of two and pfTwiddles must hold
+ * xSize floats filled by vDspFftTwiddles().
+ */
+void vDspFftTwiddles( float *pfTwiddles, size_t xSize );
+void vDspFft( float *pfData, size_t xSize, const float *pfTwiddles );
+
+/*
+ * Chain stage replacing a block of xSize real samples with the magnitude of
+ * its first xSize / 2 frequency bins.  pfWork must hold 2 * xSize floats.
+ */
+typedef struct DspSpectrum
+{
+    size_t xSize;
+    float *pfWork;
+    const float *pfTwiddles;
+} DspSpectrum_t;
+
+size_t xDspSpectrumKernel( void *pvContext, float *pfBlock, size_t xLength );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_H */
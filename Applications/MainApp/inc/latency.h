@@ -0,0 +1,57 @@
+/*
+ * Latency histogram with a bounded relative error.
+ *
+ * Values below 2^latencySUB_BUCKET_BITS each have their own bucket.  Above
+ * that every power of two is split into 2^latencySUB_BUCKET_BITS buckets, so
+ * a bucket is never wider than 1/8th of the values it holds (with the default
+ * of 3 bits) and the whole 32 bit range fits in a few hundred counters.
+ * Percentiles are reported as the upper bound of their bucket; the maximum
+ * is exact.
+ *
+ * Values are in run time clock units (see portGET_RUN_TIME_COUNTER_VALUE()).
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define latencySUB_BUCKET_BITS      3
+#define latencyBUCKETS              ( ( 32 - latencySUB_BUCKET_BITS + 1 ) << latencySUB_BUCKET_BITS )
+
+typedef struct LatencyHistogram
+{
+    uint32_t ulBuckets[ latencyBUCKETS ];
+    uint64_t ullCount;
+    uint64_t ullSum;
+    uint32_t ulMax;
+} LatencyHistogram_t;
+
+void vLatencyReset( LatencyHistogram_t *pxHistogram );
+void vLatencyAdd( LatencyHistogram_t *pxHistogram, uint32_t ulValue );
+
+/*
+ * Adds the latency of ulCount samples completed at ulDone.  Only the creation
+ * times of the first and the last sample are known, the others are assumed
+ * to be evenly spaced between them.
+ */
+void vLatencyAddSpan( LatencyHistogram_t *pxHistogram, uint32_t ulFirst, uint32_t ulLast,
+                      uint32_t ulCount, uint32_t ulDone );
+
+/* Value below which ulPerMille thousandths of the values fall. */
+uint32_t ulLatencyPercentile( const LatencyHistogram_t *pxHistogram, uint32_t ulPerMille );
+
+/* Largest value counted in bucket uxIndex. */
+uint32_t ulLatencyBucketLimit( UBaseType_t uxIndex );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LATENCY_H */
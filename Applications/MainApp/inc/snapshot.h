@@ -0,0 +1,56 @@
+/*
+ * Consistent snapshots of the processed values and bulk export helpers.
+ *
+ * The buffer is protected by a sequence lock: the single writer makes the
+ * sequence odd while it updates the values and even again once done.  Readers
+ * copy the whole buffer and retry if the sequence was odd or changed during
+ * the copy, so they never block the writer and never see a half written
+ * batch.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Snapshot
+{
+    float *pfValues;
+    size_t xCapacity;
+    volatile uint32_t ulSequence;
+} Snapshot_t;
+
+void vSnapshotInit( Snapshot_t *pxSnapshot, float *pfValues, size_t xCapacity );
+
+/* Must bracket every update of pfValues.  Only one task may write at a time. */
+void vSnapshotWriteBegin( Snapshot_t *pxSnapshot );
+void vSnapshotWriteEnd( Snapshot_t *pxSnapshot );
+
+/* Copies the xCapacity values into pfOut as they were between two writes. */
+void vSnapshotRead( Snapshot_t *pxSnapshot, float *pfOut );
+
+/*
+ * Export formats.  An export too large for one buffer is written in pieces.
+ * The format functions write the values from index *pxNext into pcBuffer,
+ * stopping at the last whole value that fits in xBufferSize, and set *pxNext
+ * to the first value not written.  Start with *pxNext at 0 and call again
+ * until it reaches xCount.  They return the number of characters written.
+ * xBufferSize must hold at least one value.  xSnapshotSaveBinary() writes the
+ * raw floats to a file.
+ */
+size_t xSnapshotFormatText( const float *pfValues, size_t xCount, size_t *pxNext, char *pcBuffer, size_t xBufferSize );
+size_t xSnapshotFormatCsv( const float *pfValues, size_t xCount, size_t *pxNext, char *pcBuffer, size_t xBufferSize );
+BaseType_t xSnapshotSaveBinary( const float *pfValues, size_t xCount, const char *pcPath );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SNAPSHOT_H */
@@ -0,0 +1,113 @@
+/*
+ * Per-task CPU telemetry.
+ *
+ * xTelemetrySample() reads the run time counters of every task with
+ * uxTaskGetSystemState() and computes how much of the interval since the
+ * previous sample each task spent running.  The kernel counters are 32 bits
+ * wide, so only their differences are used: they are accumulated into 64 bit
+ * totals, which stay correct as long as samples are taken more often than the
+ * run time clock wraps.
+ *
+ * The per-interval loads are kept in a fixed-size history ring so that a
+ * whole run can be exported as CSV (one row per sample, one column per task)
+ * and the latest sample as JSON.
+ *
+ * Each task owns a slot, matched by its task number, for as long as it
+ * exists.  The slot of a deleted task is reused by the next new task, so
+ * older history rows of a reused slot belong to the previous task.  Tasks
+ * that find no free slot are not tracked, only counted, and the count is
+ * shown next to the loads of the others.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of tasks tracked at the same time. */
+#ifndef telemetryMAX_TASKS
+    #define telemetryMAX_TASKS          32
+#endif
+
+/* Extra room in the status array for tasks created while it is allocated. */
+#ifndef telemetrySTATUS_HEADROOM
+    #define telemetrySTATUS_HEADROOM    4
+#endif
+
+/* Number of samples kept in the history ring. */
+#ifndef telemetryHISTORY_DEPTH
+    #define telemetryHISTORY_DEPTH      64
+#endif
+
+typedef struct TelemetryTask
+{
+    char pcName[ configMAX_TASK_NAME_LEN ];
+    UBaseType_t uxTaskNumber;
+    UBaseType_t uxPriority;
+    eTaskState eState;
+    configSTACK_DEPTH_TYPE usStackHighWaterMark;
+    uint32_t ulLastCounter;     /* Kernel counter at the previous sample. */
+    uint64_t ullRunTime;        /* Total run time since the task was first seen. */
+    uint32_t ulLastDelta;       /* Run time during the last interval. */
+    BaseType_t xInUse;
+} TelemetryTask_t;
+
+/* Load of every slot during one interval, in hundredths of a percent. */
+typedef struct TelemetrySample
+{
+    uint32_t ulSequence;
+    TickType_t xTimestamp;
+    uint32_t ulInterval;        /* Length of the interval in run time clock units. */
+    uint16_t usLoad[ telemetryMAX_TASKS ];
+} TelemetrySample_t;
+
+typedef struct Telemetry
+{
+    TelemetryTask_t xTasks[ telemetryMAX_TASKS ];
+    TaskStatus_t *pxStatus;     /* Sized from the number of tasks, grows as needed. */
+    UBaseType_t uxStatusSize;
+    UBaseType_t uxUntracked;    /* Tasks left out of the last sample for lack of a slot. */
+    TelemetrySample_t xHistory[ telemetryHISTORY_DEPTH ];
+    size_t xHistoryHead;        /* Index the next sample is written to. */
+    size_t xHistoryCount;
+    uint32_t ulSequence;
+    uint32_t ulLastTotal;
+    uint64_t ullTotalRunTime;
+    BaseType_t xPrimed;
+    SemaphoreHandle_t xMutex;
+    StaticSemaphore_t xMutexBuffer;
+} Telemetry_t;
+
+void vTelemetryInit( Telemetry_t *pxTelemetry );
+
+/*
+ * Takes a sample.  The first call only records the starting counters.
+ * Returns pdFAIL if the status array could not be allocated.
+ */
+BaseType_t xTelemetrySample( Telemetry_t *pxTelemetry );
+
+/*
+ * Output formats, written into pcBuffer.  They return the number of
+ * characters written and stop at the last complete line or task that fits.
+ *   Text - human readable table of the last interval.
+ *   Csv  - the whole history, oldest sample first.
+ *   Json - the last interval with the totals of every task.
+ */
+size_t xTelemetryFormatText( Telemetry_t *pxTelemetry, char *pcBuffer, size_t xBufferSize );
+size_t xTelemetryFormatCsv( Telemetry_t *pxTelemetry, char *pcBuffer, size_t xBufferSize );
+size_t xTelemetryFormatJson( Telemetry_t *pxTelemetry, char *pcBuffer, size_t xBufferSize );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,31 @@
+/*
+ * Bounded text output shared by the report formatters.
+ *
+ * The formatters build their output a piece at a time into a fixed buffer
+ * and must never leave a half written piece behind, so that whatever fits is
+ * still well formed.
+ */
+
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Appends printf style output at pcBuffer[ *pxUsed ] and advances *pxUsed.
+ * Returns pdFAIL and appends nothing if the whole output does not fit, the
+ * buffer then stays terminated at *pxUsed.
+ */
+BaseType_t xTextAppend( char *pcBuffer, size_t xBufferSize, size_t *pxUsed, const char *pcFormat, ... );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TEXT_H */
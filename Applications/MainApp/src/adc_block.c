@@ -0,0 +1,280 @@
+/*
+ * Block based hand-off of ADC samples between the acquisition and the
+ * processing tasks.  See adc_block.h.
+ */
+
+#include <string.h>
+
+/* Microkernel includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "adc_block.h"
+
+BaseType_t xAdcBlockPoolInit( AdcBlockPool_t *pxPool, const char *pcName )
+{
+    AdcBlock_t *pxBlocks[ adcBLOCK_POOL_SIZE ];
+    AdcBlock_t *pxBlock;
+    UBaseType_t x;
+
+    configASSERT( pxPool != NULL );
+
+    pxPool->xFreeQueue = xQueueCreateStatic( adcBLOCK_POOL_SIZE,
+                                             sizeof( AdcBlock_t * ),
+                                             pxPool->ucFreeQueueStorage,
+                                             &( pxPool->xFreeQueueBuffer ) );
+    pxPool->xReadyQueue = xQueueCreateStatic( adcBLOCK_POOL_SIZE,
+                                              sizeof( AdcBlock_t * ),
+                                              pxPool->ucReadyQueueStorage,
+                                              &( pxPool->xReadyQueueBuffer ) );
+
+    if( ( pxPool->xFreeQueue == NULL ) || ( pxPool->xReadyQueue == NULL ) )
+    {
+        return pdFAIL;
+    }
+
+    if( pcName != NULL )
+    {
+        vQueueAddToRegistry( pxPool->xReadyQueue, pcName );
+    }
+
+    pxPool->ulNextSequence = 0;
+    pxPool->pxFilling = NULL;
+    pxPool->ulPhase = 0;
+    pxPool->ePolicy = eAdcOverloadWait;
+    pxPool->xWaitTicks = 0;
+    pxPool->ulDecimateFactor = 1;
+    memset( &( pxPool->xStats ), 0, sizeof( pxPool->xStats ) );
+
+    for( x = 0; x < adcBLOCK_POOL_SIZE; x++ )
+    {
+        pxBlock = &( pxPool->xBlocks[ x ] );
+        pxBlock->ulCount = 0;
+        pxBlock->ulSequence = 0;
+        pxBlock->ulStride = 1;
+        pxBlocks[ x ] = pxBlock;
+    }
+
+    ( void ) xQueueSendMultiple( pxPool->xFreeQueue, pxBlocks, adcBLOCK_POOL_SIZE, 0 );
+
+    return pdPASS;
+}
+
+AdcBlock_t *pxAdcBlockAcquire( AdcBlockPool_t *pxPool, TickType_t xTicksToWait )
+{
+    AdcBlock_t *pxBlock = NULL;
+
+    if( xQueueReceive( pxPool->xFreeQueue, &pxBlock, xTicksToWait ) != pdTRUE )
+    {
+        return NULL;
+    }
+
+    pxBlock->ulCount = 0;
+    pxBlock->ulStride = 1;
+
+    return pxBlock;
+}
+
+void vAdcBlockSubmit( AdcBlockPool_t *pxPool, AdcBlock_t *pxBlock )
+{
+    BaseType_t xSent;
+
+    pxBlock->ulSequence = pxPool->ulNextSequence++;
+
+    /* Every block is always in exactly one place, so the ready queue always
+    has room for the block being submitted. */
+    xSent = xQueueSend( pxPool->xReadyQueue, &pxBlock, 0 );
+    configASSERT( xSent == pdTRUE );
+    ( void ) xSent;
+}
+
+AdcBlock_t *pxAdcBlockReceive( AdcBlockPool_t *pxPool, TickType_t xTicksToWait )
+{
+    AdcBlock_t *pxBlock = NULL;
+
+    if( xQueueReceive( pxPool->xReadyQueue, &pxBlock, xTicksToWait ) != pdTRUE )
+    {
+        return NULL;
+    }
+
+    return pxBlock;
+}
+
+void vAdcBlockRelease( AdcBlockPool_t *pxPool, AdcBlock_t *pxBlock )
+{
+    BaseType_t xSent;
+
+    pxBlock->ulCount = 0;
+
+    xSent = xQueueSend( pxPool->xFreeQueue, &pxBlock, 0 );
+    configASSERT( xSent == pdTRUE );
+    ( void ) xSent;
+}
+
+UBaseType_t uxAdcBlockReceiveMultiple( AdcBlockPool_t *pxPool, AdcBlock_t **ppxBlocks, UBaseType_t uxMaxBlocks )
+{
+    return ( UBaseType_t ) xQueueReceiveMultiple( pxPool->xReadyQueue, ppxBlocks, uxMaxBlocks, 0 );
+}
+
+void vAdcBlockReleaseMultiple( AdcBlockPool_t *pxPool, AdcBlock_t * const *ppxBlocks, UBaseType_t uxBlocks )
+{
+    BaseType_t xSent;
+    UBaseType_t x;
+
+    if( uxBlocks == 0 )
+    {
+        return;
+    }
+
+    for( x = 0; x < uxBlocks; x++ )
+    {
+        ppxBlocks[ x ]->ulCount = 0;
+    }
+
+    /* The free queue has room for every block of the pool. */
+    xSent = xQueueSendMultiple( pxPool->xFreeQueue, ppxBlocks, uxBlocks, 0 );
+    configASSERT( xSent == ( BaseType_t ) uxBlocks );
+    ( void ) xSent;
+}
+
+/* Takes a block for xAdcBlockWrite() according to the overload policy. */
+static AdcBlock_t *prvAcquireForWrite( AdcBlockPool_t *pxPool )
+{
+    AdcBlock_t *pxBlock;
+
+    switch( pxPool->ePolicy )
+    {
+        case eAdcOverloadOverwrite:
+            pxBlock = pxAdcBlockAcquire( pxPool, 0 );
+
+            if( ( pxBlock == NULL ) &&
+                ( xQueueReceive( pxPool->xReadyQueue, &pxBlock, 0 ) == pdTRUE ) )
+            {
+                pxPool->xStats.ulOverwritten += pxBlock->ulCount * pxBlock->ulStride;
+                pxBlock->ulCount = 0;
+                pxBlock->ulStride = 1;
+            }
+            break;
+
+        case eAdcOverloadDecimate:
+            pxBlock = pxAdcBlockAcquire( pxPool, 0 );
+
+            if( ( pxBlock != NULL ) &&
+                ( uxQueueMessagesWaiting( pxPool->xFreeQueue ) < adcDECIMATE_LOW_WATER ) )
+            {
+                pxBlock->ulStride = pxPool->ulDecimateFactor;
+            }
+            break;
+
+        case eAdcOverloadWait:
+        default:
+            pxBlock = pxAdcBlockAcquire( pxPool, pxPool->xWaitTicks );
+            break;
+    }
+
+    pxPool->ulPhase = 0;
+
+    return pxBlock;
+}
+
+BaseType_t xAdcBlockWrite( AdcBlockPool_t *pxPool, uint16_t usSample, BaseType_t xLate )
+{
+    AdcBlock_t *pxBlock;
+
+    if( pxPool->pxFilling == NULL )
+    {
+        pxPool->pxFilling = prvAcquireForWrite( pxPool );
+
+        if( pxPool->pxFilling == NULL )
+        {
+            pxPool->xStats.ulDropped++;
+            return pdFAIL;
+        }
+    }
+
+    pxBlock = pxPool->pxFilling;
+
+    if( ( pxPool->ulPhase++ % pxBlock->ulStride ) != 0 )
+    {
+        pxPool->xStats.ulDecimated++;
+        return pdFAIL;
+    }
+
+    if( xLate != pdFALSE )
+    {
+        pxPool->xStats.ulLate++;
+    }
+
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+    {
+        pxBlock->ulLastTime = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE();
+
+        if( pxBlock->ulCount == 0 )
+        {
+            pxBlock->ulFirstTime = pxBlock->ulLastTime;
+        }
+    }
+    #endif
+
+    pxBlock->usSamples[ pxBlock->ulCount ] = usSample;
+    pxBlock->ulCount++;
+
+    if( pxBlock->ulCount == adcBLOCK_SAMPLES )
+    {
+        vAdcBlockSubmit( pxPool, pxBlock );
+        pxPool->pxFilling = NULL;
+    }
+
+    return pdPASS;
+}
+
+void vAdcBlockSubmitPartial( AdcBlockPool_t *pxPool )
+{
+    if( ( pxPool->pxFilling != NULL ) && ( pxPool->pxFilling->ulCount > 0 ) )
+    {
+        vAdcBlockSubmit( pxPool, pxPool->pxFilling );
+        pxPool->pxFilling = NULL;
+    }
+}
+
+void vAdcBlockDrop( AdcBlockPool_t *pxPool, uint32_t ulSamples )
+{
+    pxPool->xStats.ulDropped += ulSamples;
+}
+
+void vAdcBlockSetPolicy( AdcBlockPool_t *pxPool, eAdcOverloadPolicy ePolicy,
+                         TickType_t xWaitTicks, uint32_t ulDecimateFactor )
+{
+    configASSERT( ulDecimateFactor > 0 );
+
+    taskENTER_CRITICAL();
+    {
+        pxPool->ePolicy = ePolicy;
+        pxPool->xWaitTicks = xWaitTicks;
+        pxPool->ulDecimateFactor = ulDecimateFactor;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void vAdcBlockGetStats( AdcBlockPool_t *pxPool, AdcBlockStats_t *pxStats )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxStats = pxPool->xStats;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void vAdcBlockPoolFlush( AdcBlockPool_t *pxPool )
+{
+    AdcBlock_t *pxBlocks[ adcBLOCK_POOL_SIZE ];
+
+    vAdcBlockReleaseMultiple( pxPool, pxBlocks,
+                              uxAdcBlockReceiveMultiple( pxPool, pxBlocks, adcBLOCK_POOL_SIZE ) );
+}
+
+UBaseType_t uxAdcBlocksReady( AdcBlockPool_t *pxPool )
+{
+    return uxQueueMessagesWaiting( pxPool->xReadyQueue );
+}
@@ -0,0 +1,451 @@
+/*
+ * Channel pipeline benchmark.  See bench.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* Microkernel includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "bench.h"
+#include "text.h"
+
+/* Ticks given to the workers to process the last blocks once the source has
+stopped. */
+#define benchDRAIN_TICKS        pdMS_TO_TICKS( 1000 )
+
+typedef struct BenchJitter
+{
+    BenchJitterReport_t *pxReport;
+    TaskHandle_t xRunner;
+} BenchJitter_t;
+
+typedef struct BenchSource
+{
+    Channel_t *pxChannel;
+    uint32_t ulRateHz;
+    volatile BaseType_t xStop;
+    uint64_t ullProduced;
+    TaskHandle_t xRunner;
+} BenchSource_t;
+
+static void prvSourceTask( void *pvParameters )
+{
+    BenchSource_t *pxSource = ( BenchSource_t * ) pvParameters;
+    uint32_t ulStart = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE();
+    uint64_t ullDue;
+
+    while( pxSource->xStop == pdFALSE )
+    {
+        if( pxSource->ulRateHz == 0 )
+        {
+            vChannelWrite( pxSource->pxChannel, ( uint16_t ) ( pxSource->ullProduced & 0x3FF ), pdFALSE );
+            pxSource->ullProduced++;
+        }
+        else
+        {
+            /* Samples due since the start, written in one burst every tick
+            when the rate is above the tick rate. */
+            ullDue = ( ( uint64_t ) pxSource->ulRateHz *
+                       ( uint32_t ) ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() - ulStart ) ) / benchCLOCK_HZ;
+
+            while( pxSource->ullProduced < ullDue )
+            {
+                vChannelWrite( pxSource->pxChannel, ( uint16_t ) ( pxSource->ullProduced & 0x3FF ), pdFALSE );
+                pxSource->ullProduced++;
+            }
+
+            vTaskDelay( 1 );
+        }
+    }
+
+    vChannelSubmitPartial( pxSource->pxChannel );
+    xTaskNotifyGive( pxSource->xRunner );
+    vTaskDelete( NULL );
+}
+
+BaseType_t xBenchRun( Channel_t *pxChannel, uint32_t ulRateHz, TickType_t xDuration,
+                      UBaseType_t uxPriority, BenchReport_t *pxReport )
+{
+    AdcBlockPool_t *pxPool = &( pxChannel->xPool );
+    BenchSource_t xSource;
+    AdcBlockStats_t xBefore;
+    AdcBlockStats_t xAfter;
+    eAdcOverloadPolicy ePolicy = pxPool->ePolicy;
+    TickType_t xWaitTicks = pxPool->xWaitTicks;
+    uint32_t ulDecimateFactor = pxPool->ulDecimateFactor;
+    uint32_t ulStart;
+    TickType_t xDrain;
+
+    memset( pxReport, 0, sizeof( *pxReport ) );
+    pxReport->ulRateHz = ulRateHz;
+
+    vChannelReset( pxChannel );
+    vAdcBlockGetStats( pxPool, &xBefore );
+
+    /* As fast as possible the source waits for the workers, at a fixed rate
+    it never does. */
+    vAdcBlockSetPolicy( pxPool, eAdcOverloadWait, ( ulRateHz == 0 ) ? portMAX_DELAY : 0, 1 );
+
+    xSource.pxChannel = pxChannel;
+    xSource.ulRateHz = ulRateHz;
+    xSource.xStop = pdFALSE;
+    xSource.ullProduced = 0;
+    xSource.xRunner = xTaskGetCurrentTaskHandle();
+
+    ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+    ulStart = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE();
+
+    if( xTaskCreate( prvSourceTask, "Bench", configMINIMAL_STACK_SIZE * 4,
+                     &xSource, uxPriority, NULL ) != pdPASS )
+    {
+        vAdcBlockSetPolicy( pxPool, ePolicy, xWaitTicks, ulDecimateFactor );
+        return pdFAIL;
+    }
+
+    vTaskDelay( xDuration );
+    xSource.xStop = pdTRUE;
+    ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    pxReport->ulDuration = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() - ulStart;
+
+    /* Every block is received by a worker under the channel lock, so once
+    none is ready taking the lock waits for the last one to be processed. */
+    for( xDrain = 0; ( xDrain < benchDRAIN_TICKS ) && ( uxAdcBlocksReady( pxPool ) > 0 ); xDrain++ )
+    {
+        vTaskDelay( 1 );
+    }
+
+    xSemaphoreTake( pxChannel->xLock, portMAX_DELAY );
+    {
+        pxReport->ullProcessed = pxChannel->xStats.ullTotalSamples;
+        pxReport->xLatency = pxChannel->xLatency;
+    }
+    xSemaphoreGive( pxChannel->xLock );
+
+    vAdcBlockSetPolicy( pxPool, ePolicy, xWaitTicks, ulDecimateFactor );
+    vAdcBlockGetStats( pxPool, &xAfter );
+
+    pxReport->ullProduced = xSource.ullProduced;
+    pxReport->xLosses.ulDropped = xAfter.ulDropped - xBefore.ulDropped;
+    pxReport->xLosses.ulOverwritten = xAfter.ulOverwritten - xBefore.ulOverwritten;
+    pxReport->xLosses.ulDecimated = xAfter.ulDecimated - xBefore.ulDecimated;
+    pxReport->xLosses.ulLate = xAfter.ulLate - xBefore.ulLate;
+
+    return pdPASS;
+}
+
+/* Gives the notification straight back until it is deleted. */
+static void prvPongTask( void *pvParameters )
+{
+    TaskHandle_t xRunner = ( TaskHandle_t ) pvParameters;
+
+    for( ;; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        xTaskNotifyGive( xRunner );
+    }
+}
+
+BaseType_t xBenchRunSwitch( uint32_t ulRoundTrips, UBaseType_t uxPriority, BenchSwitchReport_t *pxReport )
+{
+    TaskHandle_t xPong;
+    uint32_t ulStart;
+    uint32_t x;
+
+    configASSERT( uxPriority > uxTaskPriorityGet( NULL ) );
+
+    memset( pxReport, 0, sizeof( *pxReport ) );
+
+    if( xTaskCreate( prvPongTask, "Pong", configMINIMAL_STACK_SIZE * 4,
+                     xTaskGetCurrentTaskHandle(), uxPriority, &xPong ) != pdPASS )
+    {
+        return pdFAIL;
+    }
+
+    ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+    ulStart = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE();
+
+    /* Switches to the pong task, which switches back when it blocks again. */
+    for( x = 0; x < ulRoundTrips; x++ )
+    {
+        xTaskNotifyGive( xPong );
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    }
+
+    pxReport->ulDuration = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() - ulStart;
+    pxReport->ulSwitches = ulRoundTrips * 2U;
+
+    vTaskDelete( xPong );
+
+    return pdPASS;
+}
+
+/* Blocks until it is deleted. */
+static void prvChurnTask( void *pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ;; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    }
+}
+
+BaseType_t xBenchRunChurn( uint32_t ulTasks, UBaseType_t uxPriority, BenchChurnReport_t *pxReport )
+{
+    TaskHandle_t xTask;
+    uint32_t ulStart;
+    uint32_t x;
+
+    configASSERT( uxPriority > uxTaskPriorityGet( NULL ) );
+
+    memset( pxReport, 0, sizeof( *pxReport ) );
+
+    ulStart = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE();
+
+    /* Each task runs as soon as it is created, and is back here once it
+     * blocks. */
+    for( x = 0; x < ulTasks; x++ )
+    {
+        if( xTaskCreate( prvChurnTask, "Churn", configMINIMAL_STACK_SIZE * 4,
+                         NULL, uxPriority, &xTask ) != pdPASS )
+        {
+            return pdFAIL;
+        }
+
+        vTaskDelete( xTask );
+    }
+
+    pxReport->ulDuration = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() - ulStart;
+    pxReport->ulTasks = ulTasks;
+
+    return pdPASS;
+}
+
+static void prvJitterTask( void *pvParameters )
+{
+    BenchJitter_t *pxJitter = ( BenchJitter_t * ) pvParameters;
+    BenchJitterReport_t *pxReport = pxJitter->pxReport;
+    uint32_t ulPeriodTime = ( uint32_t ) ( ( ( uint64_t ) pxReport->xPeriod * benchCLOCK_HZ ) / configTICK_RATE_HZ );
+    TickType_t xLastWake;
+    uint32_t ulStart;
+    uint32_t ulLast;
+    uint32_t ulNow;
+    uint32_t ulInterval;
+    uint32_t x;
+
+    /* Starts on a period boundary, the first wake is the reference. */
+    xLastWake = xTaskGetTickCount();
+    vTaskDelayUntil( &xLastWake, pxReport->xPeriod );
+    ulStart = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE();
+    ulLast = ulStart;
+
+    for( x = 0; x < pxReport->ulPeriods; x++ )
+    {
+        vTaskDelayUntil( &xLastWake, pxReport->xPeriod );
+        ulNow = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE();
+        ulInterval = ulNow - ulLast;
+        ulLast = ulNow;
+
+        vLatencyAdd( &( pxReport->xJitter ), ( ulInterval > ulPeriodTime ) ? ulInterval - ulPeriodTime
+                                                                             : ulPeriodTime - ulInterval );
+
+        if( ( x == 0 ) || ( ulInterval < pxReport->ulMinInterval ) )
+        {
+            pxReport->ulMinInterval = ulInterval;
+        }
+
+        if( ulInterval > pxReport->ulMaxInterval )
+        {
+            pxReport->ulMaxInterval = ulInterval;
+        }
+    }
+
+    pxReport->ulDuration = ulLast - ulStart;
+
+    xTaskNotifyGive( pxJitter->xRunner );
+    vTaskDelete( NULL );
+}
+
+BaseType_t xBenchRunJitter( TickType_t xPeriod, uint32_t ulPeriods, UBaseType_t uxPriority,
+                            BenchJitterReport_t *pxReport )
+{
+    BenchJitter_t xJitter;
+
+    memset( pxReport, 0, sizeof( *pxReport ) );
+    vLatencyReset( &( pxReport->xJitter ) );
+    pxReport->xPeriod = xPeriod;
+    pxReport->ulPeriods = ulPeriods;
+
+    xJitter.pxReport = pxReport;
+    xJitter.xRunner = xTaskGetCurrentTaskHandle();
+
+    ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+
+    if( xTaskCreate( prvJitterTask, "Jitter", configMINIMAL_STACK_SIZE * 4,
+                     &xJitter, uxPriority, NULL ) != pdPASS )
+    {
+        return pdFAIL;
+    }
+
+    ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+    return pdPASS;
+}
+
+static unsigned long long prvMicroseconds( uint64_t ullValue )
+{
+    return ( unsigned long long ) ( ( ullValue * 1000000ULL ) / benchCLOCK_HZ );
+}
+
+/* Appends the summary of the histogram as pcName, then its buckets. */
+static void prvAppendHistogram( char *pcBuffer, size_t xBufferSize, size_t *pxUsed,
+                                const char *pcName, const LatencyHistogram_t *pxLatency )
+{
+    const char *pcSeparator = "";
+    UBaseType_t x;
+    uint64_t ullMean = 0;
+
+    if( pxLatency->ullCount > 0 )
+    {
+        ullMean = pxLatency->ullSum / pxLatency->ullCount;
+    }
+
+    ( void ) xTextAppend( pcBuffer, xBufferSize, pxUsed,
+                          "\"%s\":{\"count\":%llu,\"mean\":%llu,\"p50\":%llu,\"p90\":%llu,"
+                          "\"p99\":%llu,\"p999\":%llu,\"max\":%llu},\"histogram_us\":[",
+                          pcName, ( unsigned long long ) pxLatency->ullCount, prvMicroseconds( ullMean ),
+                          prvMicroseconds( ulLatencyPercentile( pxLatency, 500 ) ),
+                          prvMicroseconds( ulLatencyPercentile( pxLatency, 900 ) ),
+                          prvMicroseconds( ulLatencyPercentile( pxLatency, 990 ) ),
+                          prvMicroseconds( ulLatencyPercentile( pxLatency, 999 ) ),
+                          prvMicroseconds( pxLatency->ulMax ) );
+
+    /* Only the buckets that counted something, as [upper bound, count]. */
+    for( x = 0; x < latencyBUCKETS; x++ )
+    {
+        if( pxLatency->ulBuckets[ x ] > 0 )
+        {
+            ( void ) xTextAppend( pcBuffer, xBufferSize, pxUsed, "%s[%llu,%lu]", pcSeparator,
+                                  prvMicroseconds( ulLatencyBucketLimit( x ) ),
+                                  ( unsigned long ) pxLatency->ulBuckets[ x ] );
+            pcSeparator = ",";
+        }
+    }
+
+    ( void ) xTextAppend( pcBuffer, xBufferSize, pxUsed, "]" );
+}
+
+size_t xBenchFormatJson( const BenchReport_t *pxReport, char *pcBuffer, size_t xBufferSize )
+{
+    size_t xUsed = 0;
+    uint64_t ullThroughput = 0;
+
+    if( xBufferSize == 0 )
+    {
+        return 0;
+    }
+
+    pcBuffer[ 0 ] = '\0';
+
+    if( pxReport->ulDuration > 0 )
+    {
+        ullThroughput = ( pxReport->ullProcessed * benchCLOCK_HZ ) / pxReport->ulDuration;
+    }
+
+    ( void ) xTextAppend( pcBuffer, xBufferSize, &xUsed,
+                          "{\"mode\":\"%s\",\"rate_hz\":%lu,\"duration_us\":%llu,"
+                          "\"produced\":%llu,\"processed\":%llu,"
+                          "\"dropped\":%lu,\"overwritten\":%lu,\"decimated\":%lu,\"late\":%lu,"
+                          "\"throughput_sps\":%llu,",
+                          ( pxReport->ulRateHz == 0 ) ? "max" : "fixed", ( unsigned long ) pxReport->ulRateHz,
+                          prvMicroseconds( pxReport->ulDuration ),
+                          ( unsigned long long ) pxReport->ullProduced, ( unsigned long long ) pxReport->ullProcessed,
+                          ( unsigned long ) pxReport->xLosses.ulDropped, ( unsigned long ) pxReport->xLosses.ulOverwritten,
+                          ( unsigned long ) pxReport->xLosses.ulDecimated, ( unsigned long ) pxReport->xLosses.ulLate,
+                          ( unsigned long long ) ullThroughput );
+
+    prvAppendHistogram( pcBuffer, xBufferSize, &xUsed, "latency_us", &( pxReport->xLatency ) );
+    ( void ) xTextAppend( pcBuffer, xBufferSize, &xUsed, "}\n" );
+
+    return xUsed;
+}
+
+size_t xBenchFormatSwitchJson( const BenchSwitchReport_t *pxReport, char *pcBuffer, size_t xBufferSize )
+{
+    size_t xUsed = 0;
+    uint64_t ullNanoseconds = 0;
+
+    if( xBufferSize == 0 )
+    {
+        return 0;
+    }
+
+    pcBuffer[ 0 ] = '\0';
+
+    if( pxReport->ulSwitches > 0 )
+    {
+        ullNanoseconds = ( ( uint64_t ) pxReport->ulDuration * 1000000000ULL ) /
+                         ( ( uint64_t ) benchCLOCK_HZ * pxReport->ulSwitches );
+    }
+
+    ( void ) xTextAppend( pcBuffer, xBufferSize, &xUsed,
+                          "{\"mode\":\"switch\",\"switches\":%lu,\"duration_us\":%llu,\"switch_ns\":%llu}\n",
+                          ( unsigned long ) pxReport->ulSwitches, prvMicroseconds( pxReport->ulDuration ),
+                          ( unsigned long long ) ullNanoseconds );
+
+    return xUsed;
+}
+
+size_t xBenchFormatChurnJson( const BenchChurnReport_t *pxReport, char *pcBuffer, size_t xBufferSize )
+{
+    size_t xUsed = 0;
+    uint64_t ullNanoseconds = 0;
+
+    if( xBufferSize == 0 )
+    {
+        return 0;
+    }
+
+    pcBuffer[ 0 ] = '\0';
+
+    if( pxReport->ulTasks > 0 )
+    {
+        ullNanoseconds = ( ( uint64_t ) pxReport->ulDuration * 1000000000ULL ) /
+                         ( ( uint64_t ) benchCLOCK_HZ * pxReport->ulTasks );
+    }
+
+    ( void ) xTextAppend( pcBuffer, xBufferSize, &xUsed,
+                          "{\"mode\":\"churn\",\"tasks\":%lu,\"duration_us\":%llu,\"task_ns\":%llu}\n",
+                          ( unsigned long ) pxReport->ulTasks, prvMicroseconds( pxReport->ulDuration ),
+                          ( unsigned long long ) ullNanoseconds );
+
+    return xUsed;
+}
+
+size_t xBenchFormatJitterJson( const BenchJitterReport_t *pxReport, char *pcBuffer, size_t xBufferSize )
+{
+    size_t xUsed = 0;
+
+    if( xBufferSize == 0 )
+    {
+        return 0;
+    }
+
+    pcBuffer[ 0 ] = '\0';
+
+    ( void ) xTextAppend( pcBuffer, xBufferSize, &xUsed,
+                          "{\"mode\":\"jitter\",\"period_us\":%llu,\"periods\":%lu,\"duration_us\":%llu,"
+                          "\"min_period_us\":%llu,\"max_period_us\":%llu,",
+                          prvMicroseconds( ( ( uint64_t ) pxReport->xPeriod * benchCLOCK_HZ ) / configTICK_RATE_HZ ),
+                          ( unsigned long ) pxReport->ulPeriods, prvMicroseconds( pxReport->ulDuration ),
+                          prvMicroseconds( pxReport->ulMinInterval ), prvMicroseconds( pxReport->ulMaxInterval ) );
+
+    prvAppendHistogram( pcBuffer, xBufferSize, &xUsed, "jitter_us", &( pxReport->xJitter ) );
+    ( void ) xTextAppend( pcBuffer, xBufferSize, &xUsed, "}\n" );
+
+    return xUsed;
+}
@@ -0,0 +1,385 @@
+/*
+ * Channel pipelines and the scheduler running them.  See channel.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* Microkernel includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include "console.h"
+#include "channel.h"
+
+/* Channels run by the scheduler. */
+static Channel_t *pxSchedulerChannels = NULL;
+static size_t xSchedulerChannelCount = 0;
+
+/* Channels with blocks waiting to be processed.  A channel is in the queue at
+most once, so the queue can hold all of them. */
+static QueueHandle_t xReadyChannels = NULL;
+static StaticQueue_t xReadyChannelsBuffer;
+static uint8_t ucReadyChannelsStorage[ channelMAX_CHANNELS * sizeof( Channel_t * ) ];
+
+/* One turn of a worker: the blocks taken from a channel and the values the
+DSP chain made of them, adcBLOCK_SAMPLES per block. */
+typedef struct ChannelBatch
+{
+    Channel_t *pxChannel;
+    AdcBlock_t *pxBlocks[ channelBATCH_MAX_BLOCKS ];
+    size_t xLengths[ channelBATCH_MAX_BLOCKS ];
+    uint32_t ulBlocks;
+    float pfValues[ channelBATCH_MAX_BLOCKS * adcBLOCK_SAMPLES ];
+} ChannelBatch_t;
+
+static void prvAcquisitionTask( void *pvParameters );
+static void prvWorkerTask( void *pvParameters );
+
+BaseType_t xChannelInit( Channel_t *pxChannel, const char *pcName, TickType_t xPeriod,
+                         ChannelSource_t pxSource, void *pvSourceContext,
+                         float *pfValues, size_t xCapacity )
+{
+    configASSERT( ( pxChannel != NULL ) && ( pxSource != NULL ) && ( xPeriod > 0 ) );
+
+    memset( pxChannel, 0, sizeof( *pxChannel ) );
+
+    if( xAdcBlockPoolInit( &( pxChannel->xPool ), pcName ) != pdPASS )
+    {
+        return pdFAIL;
+    }
+
+    pxChannel->xLock = xSemaphoreCreateMutexStatic( &( pxChannel->xLockBuffer ) );
+    configASSERT( pxChannel->xLock != NULL );
+
+    pxChannel->pcName = pcName;
+    pxChannel->xPeriod = xPeriod;
+    pxChannel->pxSource = pxSource;
+    pxChannel->pvSourceContext = pvSourceContext;
+
+    vDspChainInit( &( pxChannel->xChain ) );
+    vSnapshotInit( &( pxChannel->xSnapshot ), pfValues, xCapacity );
+
+    return pdPASS;
+}
+
+/* Appends the channel to the ready queue unless it is already there. */
+static void prvScheduleChannel( Channel_t *pxChannel )
+{
+    BaseType_t xAlreadyScheduled;
+
+    taskENTER_CRITICAL();
+    {
+        xAlreadyScheduled = pxChannel->xScheduled;
+        pxChannel->xScheduled = pdTRUE;
+    }
+    taskEXIT_CRITICAL();
+
+    if( xAlreadyScheduled == pdFALSE )
+    {
+        ( void ) xQueueSend( xReadyChannels, &pxChannel, 0 );
+    }
+}
+
+/* Schedules the channel if a block was submitted since it was last
+scheduled. */
+static void prvScheduleSubmitted( Channel_t *pxChannel )
+{
+    uint32_t ulSequence = pxChannel->xPool.ulNextSequence;
+
+    if( ( ulSequence != pxChannel->ulScheduledSequence ) && ( pxChannel->xComplete == pdFALSE ) )
+    {
+        pxChannel->ulScheduledSequence = ulSequence;
+        prvScheduleChannel( pxChannel );
+    }
+}
+
+void vChannelWrite( Channel_t *pxChannel, uint16_t usSample, BaseType_t xLate )
+{
+    ( void ) xAdcBlockWrite( &( pxChannel->xPool ), usSample, xLate );
+    prvScheduleSubmitted( pxChannel );
+}
+
+void vChannelSubmitPartial( Channel_t *pxChannel )
+{
+    vAdcBlockSubmitPartial( &( pxChannel->xPool ) );
+    prvScheduleSubmitted( pxChannel );
+}
+
+/* Takes the samples that are due on one channel. */
+static void prvSampleChannel( Channel_t *pxChannel, TickType_t xNow )
+{
+    AdcBlockPool_t *pxPool = &( pxChannel->xPool );
+    TickType_t xDue;
+
+    /* Nothing to do until the next sample time, which is compared as a
+    difference so that tick count overflows are harmless. */
+    if( ( xNow - pxChannel->xNextSample ) > ( portMAX_DELAY >> 1 ) )
+    {
+        return;
+    }
+
+    xDue = ( ( xNow - pxChannel->xNextSample ) / pxChannel->xPeriod ) + 1;
+
+    if( xDue > channelMAX_CATCH_UP_PERIODS )
+    {
+        vAdcBlockDrop( pxPool, ( uint32_t ) ( xDue - 1 ) );
+        pxChannel->xNextSample += ( xDue - 1 ) * pxChannel->xPeriod;
+        xDue = 1;
+    }
+
+    while( xDue-- > 0 )
+    {
+        ( void ) xAdcBlockWrite( pxPool, pxChannel->pxSource( pxChannel->pvSourceContext ),
+                                 ( pxChannel->xNextSample != xNow ) ? pdTRUE : pdFALSE );
+        pxChannel->xNextSample += pxChannel->xPeriod;
+    }
+
+    prvScheduleSubmitted( pxChannel );
+}
+
+static void prvAcquisitionTask( void *pvParameters )
+{
+    TickType_t xLastWakeTime;
+    TickType_t xNow;
+    size_t x;
+
+    ( void ) pvParameters;
+
+    xLastWakeTime = xTaskGetTickCount();
+
+    for( x = 0; x < xSchedulerChannelCount; x++ )
+    {
+        pxSchedulerChannels[ x ].xNextSample = xLastWakeTime + 1;
+    }
+
+    for( ;; )
+    {
+        xTaskDelayUntil( &xLastWakeTime, 1 );
+        xNow = xTaskGetTickCount();
+
+        for( x = 0; x < xSchedulerChannelCount; x++ )
+        {
+            prvSampleChannel( &( pxSchedulerChannels[ x ] ), xNow );
+        }
+    }
+}
+
+/* Runs the DSP chain of the channel over every block of the batch, on a host
+core (see vPortRunOnHostCore()). */
+static void prvRunBatch( void *pvParameters )
+{
+    ChannelBatch_t *pxBatch = ( ChannelBatch_t * ) pvParameters;
+    AdcBlock_t *pxBlock;
+    float *pfBlock;
+    uint32_t x;
+
+    for( x = 0; x < pxBatch->ulBlocks; x++ )
+    {
+        pxBlock = pxBatch->pxBlocks[ x ];
+        pfBlock = &( pxBatch->pfValues[ x * adcBLOCK_SAMPLES ] );
+
+        /* The samples are read straight from the block written by the
+        acquisition task. */
+        vDspConvertU16( pxBlock->usSamples, pfBlock, pxBlock->ulCount );
+        pxBatch->xLengths[ x ] = xDspChainRun( &( pxBatch->pxChannel->xChain ), pfBlock, pxBlock->ulCount );
+    }
+}
+
+/* Processes up to channelBATCH_MAX_BLOCKS blocks.  Returns pdTRUE if more are
+waiting.  Called with the channel lock held. */
+static BaseType_t prvProcessChannel( Channel_t *pxChannel, ChannelBatch_t *pxBatch )
+{
+    AdcBlockPool_t *pxPool = &( pxChannel->xPool );
+    Snapshot_t *pxSnapshot = &( pxChannel->xSnapshot );
+    AdcBlock_t *pxBlock;
+    uint32_t ulBatchBlocks = 0;
+    uint32_t ulBatchSamples = 0;
+    uint32_t x;
+    size_t xProcessed;
+    size_t xCopied;
+    const float *pfNext;
+
+    pxBatch->pxChannel = pxChannel;
+    pxBatch->ulBlocks = 0;
+
+    /* Up to a batch of the waiting blocks in one queue operation. */
+    if( pxChannel->xComplete == pdFALSE )
+    {
+        pxBatch->ulBlocks = ( uint32_t ) uxAdcBlockReceiveMultiple( pxPool, pxBatch->pxBlocks, channelBATCH_MAX_BLOCKS );
+    }
+
+    /* The whole batch at once, so that the hand over to the host core costs
+    little next to the processing. */
+    if( pxBatch->ulBlocks > 0 )
+    {
+        vPortRunOnHostCore( prvRunBatch, pxBatch );
+    }
+
+    for( x = 0; x < pxBatch->ulBlocks; x++ )
+    {
+        pxBlock = pxBatch->pxBlocks[ x ];
+
+        /* Blocks after the one completing the channel are only released. */
+        if( pxChannel->xComplete != pdFALSE )
+        {
+            continue;
+        }
+
+        xProcessed = pxBatch->xLengths[ x ];
+        ulBatchSamples += pxBlock->ulCount;
+
+        /* Copied in two parts when a ring wraps around. */
+        pfNext = &( pxBatch->pfValues[ x * adcBLOCK_SAMPLES ] );
+        vSnapshotWriteBegin( pxSnapshot );
+
+        do
+        {
+            xCopied = pxSnapshot->xCapacity - pxChannel->xPosition;
+
+            if( xCopied > xProcessed )
+            {
+                xCopied = xProcessed;
+            }
+
+            memcpy( &( pxSnapshot->pfValues[ pxChannel->xPosition ] ), pfNext, xCopied * sizeof( float ) );
+            pxChannel->xPosition += xCopied;
+            pfNext += xCopied;
+            xProcessed -= xCopied;
+
+            if( ( pxChannel->xWrap != pdFALSE ) && ( pxChannel->xPosition >= pxSnapshot->xCapacity ) )
+            {
+                pxChannel->xPosition = 0;
+            }
+        } while( ( pxChannel->xWrap != pdFALSE ) && ( xProcessed > 0 ) );
+
+        vSnapshotWriteEnd( pxSnapshot );
+
+        #if ( configGENERATE_RUN_TIME_STATS == 1 )
+        {
+            vLatencyAddSpan( &( pxChannel->xLatency ), pxBlock->ulFirstTime, pxBlock->ulLastTime,
+                             pxBlock->ulCount, ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() );
+        }
+        #endif
+
+        ulBatchBlocks++;
+
+        if( pxChannel->xPosition >= pxSnapshot->xCapacity )
+        {
+            pxChannel->xComplete = pdTRUE;
+            console_print("-All ADC values of %s were processed- ", pxChannel->pcName);
+        }
+    }
+
+    /* The whole batch goes back to the producer in one queue operation. */
+    vAdcBlockReleaseMultiple( pxPool, pxBatch->pxBlocks, ( UBaseType_t ) pxBatch->ulBlocks );
+
+    if( ulBatchBlocks > 0 )
+    {
+        pxChannel->xStats.ulBatches++;
+        pxChannel->xStats.ulLastBatch = ulBatchSamples;
+        pxChannel->xStats.ullTotalSamples += ulBatchSamples;
+
+        if( ulBatchSamples > pxChannel->xStats.ulMaxBatch )
+        {
+            pxChannel->xStats.ulMaxBatch = ulBatchSamples;
+        }
+    }
+
+    return ( ( pxChannel->xComplete == pdFALSE ) && ( uxAdcBlocksReady( pxPool ) > 0 ) ) ? pdTRUE : pdFALSE;
+}
+
+static void prvWorkerTask( void *pvParameters )
+{
+    Channel_t *pxChannel;
+    BaseType_t xMore;
+    ChannelBatch_t *pxBatch;
+
+    ( void ) pvParameters;
+
+    /* Too large for the stack of the task. */
+    pxBatch = ( ChannelBatch_t * ) pvPortMalloc( sizeof( ChannelBatch_t ) );
+    configASSERT( pxBatch != NULL );
+
+    for( ;; )
+    {
+        ( void ) xQueueReceive( xReadyChannels, &pxChannel, portMAX_DELAY );
+
+        xSemaphoreTake( pxChannel->xLock, portMAX_DELAY );
+
+        /* Cleared first, so a block submitted while this batch is processed
+        schedules the channel again. */
+        taskENTER_CRITICAL();
+        {
+            pxChannel->xScheduled = pdFALSE;
+        }
+        taskEXIT_CRITICAL();
+
+        xMore = prvProcessChannel( pxChannel, pxBatch );
+        xSemaphoreGive( pxChannel->xLock );
+
+        /* Back to the end of the queue, behind the channels already waiting. */
+        if( xMore != pdFALSE )
+        {
+            prvScheduleChannel( pxChannel );
+        }
+    }
+}
+
+BaseType_t xChannelSchedulerStart( Channel_t *pxChannels, size_t xCount, UBaseType_t uxWorkers,
+                                   UBaseType_t uxAcquisitionPriority, UBaseType_t uxWorkerPriority )
+{
+    char cName[ configMAX_TASK_NAME_LEN ];
+    UBaseType_t x;
+
+    configASSERT( ( xReadyChannels == NULL ) && ( xCount <= channelMAX_CHANNELS ) && ( uxWorkers > 0 ) );
+
+    pxSchedulerChannels = pxChannels;
+    xSchedulerChannelCount = xCount;
+    xReadyChannels = xQueueCreateStatic( channelMAX_CHANNELS, sizeof( Channel_t * ),
+                                         ucReadyChannelsStorage, &xReadyChannelsBuffer );
+    configASSERT( xReadyChannels != NULL );
+    vQueueAddToRegistry( xReadyChannels, "ReadyChannels" );
+
+    if( xTaskCreate( prvAcquisitionTask, "ADCRead", configMINIMAL_STACK_SIZE * 10,
+                     NULL, uxAcquisitionPriority, NULL ) != pdPASS )
+    {
+        return pdFAIL;
+    }
+
+    for( x = 0; x < uxWorkers; x++ )
+    {
+        snprintf( cName, sizeof( cName ), "Proc%u", ( unsigned ) x );
+
+        if( xTaskCreate( prvWorkerTask, cName, configMINIMAL_STACK_SIZE * 10,
+                         NULL, uxWorkerPriority, NULL ) != pdPASS )
+        {
+            return pdFAIL;
+        }
+    }
+
+    return pdPASS;
+}
+
+void vChannelReset( Channel_t *pxChannel )
+{
+    Snapshot_t *pxSnapshot = &( pxChannel->xSnapshot );
+
+    xSemaphoreTake( pxChannel->xLock, portMAX_DELAY );
+    {
+        /* Discard blocks not processed yet */
+        vAdcBlockPoolFlush( &( pxChannel->xPool ) );
+
+        vSnapshotWriteBegin( pxSnapshot );
+        memset( pxSnapshot->pfValues, 0, pxSnapshot->xCapacity * sizeof( float ) );
+        vSnapshotWriteEnd( pxSnapshot );
+
+        pxChannel->xPosition = 0;
+        pxChannel->xComplete = pdFALSE;
+        memset( &( pxChannel->xStats ), 0, sizeof( pxChannel->xStats ) );
+        vLatencyReset( &( pxChannel->xLatency ) );
+    }
+    xSemaphoreGive( pxChannel->xLock );
+}
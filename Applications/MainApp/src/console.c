@@ -26,17 +26,51 @@
 
 /*-----------------------------------------------------------
  * Example console I/O wrappers.
+ *
+ * Input is read from stdin by a host thread, which cannot call the FreeRTOS
+ * API.  With configUSE_LOCK_FREE_STREAM_BUFFERS set to 1 it writes the bytes
+ * straight into the stream buffer that tasks block on with console_read(),
+ * without taking any lock, and only raises a simulated interrupt to notify a
+ * task that is waiting for them.  Otherwise it places the bytes in a lock free
+ * ring and raises a simulated interrupt, whose handler moves them into the
+ * stream buffer.
  *----------------------------------------------------------*/
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
 
 #include <FreeRTOS.h>
 #include <semphr.h>
+#include <stream_buffer.h>
+
+#include "console.h"
 
 SemaphoreHandle_t xStdioMutex;
 StaticSemaphore_t xStdioMutexBuffer;
 
+/* Bytes received from stdin and not yet read by a task */
+static StreamBufferHandle_t xRxStream;
+static StaticStreamBuffer_t xRxStreamBuffer;
+static uint8_t ucRxStreamStorage[ consoleRX_BUFFER_SIZE + 1 ];
+
+#if ( configUSE_LOCK_FREE_STREAM_BUFFERS != 1 )
+
+    /* Ring written by the stdin reader thread and read by the Rx interrupt.
+     * The indexes run freely and are only masked when used. */
+    #define consoleHOST_RING_SIZE 256
+    static uint8_t ucHostRing[ consoleHOST_RING_SIZE ];
+    static uint32_t ulHostHead;
+    static uint32_t ulHostTail;
+#endif
+
+static pthread_t xReaderThread;
+
+static void *prvStdinReaderThread( void *pvParameters );
+static uint32_t prvRxInterruptHandler( void );
+
 void console_init(void)
 {
     xStdioMutex = xSemaphoreCreateMutexStatic(&xStdioMutexBuffer);
@@ -56,3 +90,170 @@ void console_print(const char *fmt, ...)
 
     va_end(vargs);
 }
+
+void console_write(const char *buf, size_t len)
+{
+    xSemaphoreTake(xStdioMutex, portMAX_DELAY);
+
+    fwrite(buf, 1, len, stdout);
+
+    xSemaphoreGive(xStdioMutex);
+}
+
+void console_input_init(void)
+{
+    sigset_t xAllSignals, xOldSignals;
+
+    xRxStream = xStreamBufferCreateStatic( sizeof( ucRxStreamStorage ), 1, ucRxStreamStorage, &xRxStreamBuffer );
+    vPortSetInterruptHandler( consoleRX_INTERRUPT, prvRxInterruptHandler );
+
+    /* The reader thread must never run a signal handler, as it is not a
+    task, so it is created with every signal blocked. */
+    sigfillset( &xAllSignals );
+    pthread_sigmask( SIG_SETMASK, &xAllSignals, &xOldSignals );
+    pthread_create( &xReaderThread, NULL, prvStdinReaderThread, NULL );
+    pthread_sigmask( SIG_SETMASK, &xOldSignals, NULL );
+}
+
+size_t console_read(char *buf, size_t len, TickType_t xTicksToWait)
+{
+    return xStreamBufferReceive( xRxStream, buf, len, xTicksToWait );
+}
+
+#if ( configUSE_LOCK_FREE_STREAM_BUFFERS == 1 )
+
+static void *prvStdinReaderThread( void *pvParameters )
+{
+    uint8_t ucBuffer[ 64 ];
+    ssize_t xRead;
+    size_t x, xSent;
+    BaseType_t xTaskWaiting;
+
+    ( void ) pvParameters;
+
+    vPortSetHostThreadPolicy( ePortThreadIO, 0 );
+
+    for( ;; )
+    {
+        xRead = read( STDIN_FILENO, ucBuffer, sizeof( ucBuffer ) );
+
+        if( xRead <= 0 )
+        {
+            /* End of input. */
+            break;
+        }
+
+        for( x = 0; x < ( size_t ) xRead; x += xSent )
+        {
+            xSent = xStreamBufferSendLockFree( xRxStream, &ucBuffer[ x ], ( size_t ) xRead - x, &xTaskWaiting );
+
+            if( xTaskWaiting != pdFALSE )
+            {
+                /* Only an interrupt can notify the task. */
+                vPortGenerateSimulatedInterrupt( consoleRX_INTERRUPT );
+            }
+
+            if( xSent == 0 )
+            {
+                /* Wait for a task to make room. */
+                usleep( 1000 );
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static uint32_t prvRxInterruptHandler( void )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    ( void ) xStreamBufferSendCompletedFromISR( xRxStream, &xHigherPriorityTaskWoken );
+
+    return ( uint32_t ) xHigherPriorityTaskWoken;
+}
+
+#else /* configUSE_LOCK_FREE_STREAM_BUFFERS */
+
+static void *prvStdinReaderThread( void *pvParameters )
+{
+    uint8_t ucBuffer[ 64 ];
+    ssize_t xRead, x;
+    uint32_t ulTail;
+
+    ( void ) pvParameters;
+
+    vPortSetHostThreadPolicy( ePortThreadIO, 0 );
+
+    for( ;; )
+    {
+        xRead = read( STDIN_FILENO, ucBuffer, sizeof( ucBuffer ) );
+
+        if( xRead <= 0 )
+        {
+            /* End of input. */
+            break;
+        }
+
+        for( x = 0; x < xRead; x++ )
+        {
+            /* Wait for the interrupt handler to make room. */
+            for( ;; )
+            {
+                ulTail = __atomic_load_n( &ulHostTail, __ATOMIC_ACQUIRE );
+
+                if( ( ulHostHead - ulTail ) < consoleHOST_RING_SIZE )
+                {
+                    break;
+                }
+
+                vPortGenerateSimulatedInterrupt( consoleRX_INTERRUPT );
+                usleep( 1000 );
+            }
+
+            ucHostRing[ ulHostHead % consoleHOST_RING_SIZE ] = ucBuffer[ x ];
+            __atomic_store_n( &ulHostHead, ulHostHead + 1, __ATOMIC_RELEASE );
+        }
+
+        vPortGenerateSimulatedInterrupt( consoleRX_INTERRUPT );
+    }
+
+    return NULL;
+}
+
+static uint32_t prvRxInterruptHandler( void )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint32_t ulHead, ulTail, ulContiguous;
+    size_t xSent;
+
+    ulHead = __atomic_load_n( &ulHostHead, __ATOMIC_ACQUIRE );
+    ulTail = ulHostTail;
+
+    while( ulTail != ulHead )
+    {
+        ulContiguous = consoleHOST_RING_SIZE - ( ulTail % consoleHOST_RING_SIZE );
+
+        if( ulContiguous > ulHead - ulTail )
+        {
+            ulContiguous = ulHead - ulTail;
+        }
+
+        xSent = xStreamBufferSendFromISR( xRxStream, &ucHostRing[ ulTail % consoleHOST_RING_SIZE ],
+                                          ulContiguous, &xHigherPriorityTaskWoken );
+        ulTail += xSent;
+
+        if( xSent < ulContiguous )
+        {
+            /* The stream buffer is full, the reader thread raises the
+            interrupt again while bytes are left in the ring. */
+            break;
+        }
+    }
+
+    __atomic_store_n( &ulHostTail, ulTail, __ATOMIC_RELEASE );
+
+    return ( uint32_t ) xHigherPriorityTaskWoken;
+}
+
+#endif /* configUSE_LOCK_FREE_STREAM_BUFFERS */
@@ -0,0 +1,425 @@
+/*
+ * Block DSP kernels used by the processing stage.  See dsp.h.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#if defined( __AVX__ )
+    #include <immintrin.h>
+#elif defined( __SSE2__ )
+    #include <emmintrin.h>
+#endif
+
+/* Microkernel includes */
+#include "FreeRTOS.h"
+
+#include "dsp.h"
+
+#define dspPI    3.14159265358979f
+
+/*-----------------------------------------------------------*/
+
+void vDspChainInit( DspChain_t *pxChain )
+{
+    pxChain->xNumStages = 0;
+}
+
+BaseType_t xDspChainAppend( DspChain_t *pxChain, DspKernel_t pxKernel, void *pvContext )
+{
+    if( pxChain->xNumStages >= dspMAX_CHAIN_STAGES )
+    {
+        return pdFAIL;
+    }
+
+    pxChain->xStages[ pxChain->xNumStages ].pxKernel = pxKernel;
+    pxChain->xStages[ pxChain->xNumStages ].pvContext = pvContext;
+    pxChain->xNumStages++;
+
+    return pdPASS;
+}
+
+size_t xDspChainRun( const DspChain_t *pxChain, float *pfBlock, size_t xLength )
+{
+    size_t x;
+
+    for( x = 0; ( x < pxChain->xNumStages ) && ( xLength > 0 ); x++ )
+    {
+        xLength = pxChain->xStages[ x ].pxKernel( pxChain->xStages[ x ].pvContext, pfBlock, xLength );
+    }
+
+    return xLength;
+}
+/*-----------------------------------------------------------*/
+
+void vDspConvertU16( const uint16_t *pusIn, float *pfOut, size_t xLength )
+{
+    size_t x = 0;
+
+    #if defined( __SSE2__ )
+    {
+        const __m128i xZero = _mm_setzero_si128();
+
+        for( ; x + 8 <= xLength; x += 8 )
+        {
+            __m128i xRaw = _mm_loadu_si128( ( const __m128i * ) &pusIn[ x ] );
+
+            _mm_storeu_ps( &pfOut[ x ], _mm_cvtepi32_ps( _mm_unpacklo_epi16( xRaw, xZero ) ) );
+            _mm_storeu_ps( &pfOut[ x + 4 ], _mm_cvtepi32_ps( _mm_unpackhi_epi16( xRaw, xZero ) ) );
+        }
+    }
+    #endif
+
+    for( ; x < xLength; x++ )
+    {
+        pfOut[ x ] = ( float ) pusIn[ x ];
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vDspGainOffset( float *pfBlock, size_t xLength, float fGain, float fOffset )
+{
+    size_t x = 0;
+
+    #if defined( __AVX__ )
+    {
+        const __m256 xGain = _mm256_set1_ps( fGain );
+        const __m256 xOffset = _mm256_set1_ps( fOffset );
+
+        for( ; x + 8 <= xLength; x += 8 )
+        {
+            __m256 xData = _mm256_loadu_ps( &pfBlock[ x ] );
+            _mm256_storeu_ps( &pfBlock[ x ], _mm256_add_ps( _mm256_mul_ps( xData, xGain ), xOffset ) );
+        }
+    }
+    #elif defined( __SSE2__ )
+    {
+        const __m128 xGain = _mm_set1_ps( fGain );
+        const __m128 xOffset = _mm_set1_ps( fOffset );
+
+        for( ; x + 4 <= xLength; x += 4 )
+        {
+            __m128 xData = _mm_loadu_ps( &pfBlock[ x ] );
+            _mm_storeu_ps( &pfBlock[ x ], _mm_add_ps( _mm_mul_ps( xData, xGain ), xOffset ) );
+        }
+    }
+    #endif
+
+    for( ; x < xLength; x++ )
+    {
+        pfBlock[ x ] = ( pfBlock[ x ] * fGain ) + fOffset;
+    }
+}
+
+size_t xDspGainKernel( void *pvContext, float *pfBlock, size_t xLength )
+{
+    DspGain_t *pxGain = ( DspGain_t * ) pvContext;
+
+    vDspGainOffset( pfBlock, xLength, pxGain->fGain, pxGain->fOffset );
+
+    return xLength;
+}
+/*-----------------------------------------------------------*/
+
+static float prvDotProduct( const float *pfA, const float *pfB, size_t xLength )
+{
+    size_t x = 0;
+    float fSum = 0.0f;
+
+    #if defined( __AVX__ )
+    {
+        __m256 xAcc = _mm256_setzero_ps();
+        __m128 xHalf;
+
+        for( ; x + 8 <= xLength; x += 8 )
+        {
+            xAcc = _mm256_add_ps( xAcc, _mm256_mul_ps( _mm256_loadu_ps( &pfA[ x ] ), _mm256_loadu_ps( &pfB[ x ] ) ) );
+        }
+
+        xHalf = _mm_add_ps( _mm256_castps256_ps128( xAcc ), _mm256_extractf128_ps( xAcc, 1 ) );
+        xHalf = _mm_add_ps( xHalf, _mm_movehl_ps( xHalf, xHalf ) );
+        xHalf = _mm_add_ss( xHalf, _mm_shuffle_ps( xHalf, xHalf, 1 ) );
+        fSum = _mm_cvtss_f32( xHalf );
+    }
+    #elif defined( __SSE2__ )
+    {
+        __m128 xAcc = _mm_setzero_ps();
+
+        for( ; x + 4 <= xLength; x += 4 )
+        {
+            xAcc = _mm_add_ps( xAcc, _mm_mul_ps( _mm_loadu_ps( &pfA[ x ] ), _mm_loadu_ps( &pfB[ x ] ) ) );
+        }
+
+        xAcc = _mm_add_ps( xAcc, _mm_movehl_ps( xAcc, xAcc ) );
+        xAcc = _mm_add_ss( xAcc, _mm_shuffle_ps( xAcc, xAcc, 1 ) );
+        fSum = _mm_cvtss_f32( xAcc );
+    }
+    #endif
+
+    for( ; x < xLength; x++ )
+    {
+        fSum += pfA[ x ] * pfB[ x ];
+    }
+
+    return fSum;
+}
+
+void vDspFirInit( DspFir_t *pxFir, const float *pfCoeffs, size_t xTaps,
+                  float *pfWorkspace, size_t xMaxBlock )
+{
+    size_t x;
+
+    configASSERT( xTaps > 0 );
+
+    /* Reverse the coefficients so y[n] = sum(h[k] * x[n - k]) becomes a dot
+    product over consecutive samples of the delay line. */
+    for( x = 0; x < xTaps; x++ )
+    {
+        pfWorkspace[ x ] = pfCoeffs[ xTaps - 1 - x ];
+    }
+
+    pxFir->pfReversedCoeffs = pfWorkspace;
+    pxFir->pfDelayLine = &pfWorkspace[ xTaps ];
+    pxFir->xTaps = xTaps;
+    pxFir->xMaxBlock = xMaxBlock;
+
+    memset( pxFir->pfDelayLine, 0, ( xTaps - 1 + xMaxBlock ) * sizeof( float ) );
+}
+
+size_t xDspFirKernel( void *pvContext, float *pfBlock, size_t xLength )
+{
+    DspFir_t *pxFir = ( DspFir_t * ) pvContext;
+    size_t xHistory = pxFir->xTaps - 1;
+    size_t x;
+
+    configASSERT( xLength <= pxFir->xMaxBlock );
+
+    /* The delay line holds the last xTaps - 1 inputs of the previous block
+    followed by this block. */
+    memcpy( &pxFir->pfDelayLine[ xHistory ], pfBlock, xLength * sizeof( float ) );
+
+    for( x = 0; x < xLength; x++ )
+    {
+        pfBlock[ x ] = prvDotProduct( pxFir->pfReversedCoeffs, &pxFir->pfDelayLine[ x ], pxFir->xTaps );
+    }
+
+    memmove( pxFir->pfDelayLine, &pxFir->pfDelayLine[ xLength ], xHistory * sizeof( float ) );
+
+    return xLength;
+}
+
+void vDspDesignLowPass( float *pfCoeffs, size_t xTaps, float fCutoff )
+{
+    float fCentre = ( float ) ( xTaps - 1 ) / 2.0f;
+    float fSum = 0.0f;
+    float fOffset, fWindow;
+    size_t x;
+
+    for( x = 0; x < xTaps; x++ )
+    {
+        fOffset = ( float ) x - fCentre;
+
+        if( fOffset == 0.0f )
+        {
+            pfCoeffs[ x ] = 2.0f * fCutoff;
+        }
+        else
+        {
+            pfCoeffs[ x ] = sinf( 2.0f * dspPI * fCutoff * fOffset ) / ( dspPI * fOffset );
+        }
+
+        if( xTaps > 1 )
+        {
+            fWindow = 0.54f - 0.46f * cosf( 2.0f * dspPI * ( float ) x / ( float ) ( xTaps - 1 ) );
+            pfCoeffs[ x ] *= fWindow;
+        }
+
+        fSum += pfCoeffs[ x ];
+    }
+
+    for( x = 0; x < xTaps; x++ )
+    {
+        pfCoeffs[ x ] /= fSum;
+    }
+}
+/*-----------------------------------------------------------*/
+
+size_t xDspIirKernel( void *pvContext, float *pfBlock, size_t xLength )
+{
+    DspIir_t *pxIir = ( DspIir_t * ) pvContext;
+    DspBiquad_t *pxSection;
+    float fIn, fOut;
+    size_t xSection, x;
+
+    for( xSection = 0; xSection < pxIir->xNumSections; xSection++ )
+    {
+        pxSection = &pxIir->pxSections[ xSection ];
+
+        for( x = 0; x < xLength; x++ )
+        {
+            fIn = pfBlock[ x ];
+            fOut = ( pxSection->fB0 * fIn ) + pxSection->fZ1;
+            pxSection->fZ1 = ( pxSection->fB1 * fIn ) - ( pxSection->fA1 * fOut ) + pxSection->fZ2;
+            pxSection->fZ2 = ( pxSection->fB2 * fIn ) - ( pxSection->fA2 * fOut );
+            pfBlock[ x ] = fOut;
+        }
+    }
+
+    return xLength;
+}
+/*-----------------------------------------------------------*/
+
+size_t xDspDecimateKernel( void *pvContext, float *pfBlock, size_t xLength )
+{
+    DspDecimator_t *pxDecimator = ( DspDecimator_t * ) pvContext;
+    size_t xOut = 0;
+    size_t x;
+
+    configASSERT( pxDecimator->xFactor > 0 );
+
+    for( x = 0; x < xLength; x++ )
+    {
+        if( pxDecimator->xPhase == 0 )
+        {
+            pfBlock[ xOut++ ] = pfBlock[ x ];
+        }
+
+        pxDecimator->xPhase++;
+
+        if( pxDecimator->xPhase == pxDecimator->xFactor )
+        {
+            pxDecimator->xPhase = 0;
+        }
+    }
+
+    return xOut;
+}
+/*-----------------------------------------------------------*/
+
+void vDspFftTwiddles( float *pfTwiddles, size_t xSize )
+{
+    size_t x;
+
+    /* W(k) = exp(-j * 2 * pi * k / N) for k < N / 2. */
+    for( x = 0; x < xSize / 2; x++ )
+    {
+        pfTwiddles[ 2 * x ] = cosf( 2.0f * dspPI * ( float ) x / ( float ) xSize );
+        pfTwiddles[ ( 2 * x ) + 1 ] = -sinf( 2.0f * dspPI * ( float ) x / ( float ) xSize );
+    }
+}
+
+static void prvBitReverse( float *pfData, size_t xSize )
+{
+    size_t i, j = 0, xBit;
+    float fTemp;
+
+    for( i = 1; i < xSize; i++ )
+    {
+        for( xBit = xSize >> 1; ( j & xBit ) != 0; xBit >>= 1 )
+        {
+            j ^= xBit;
+        }
+
+        j |= xBit;
+
+        if( i < j )
+        {
+            fTemp = pfData[ 2 * i ];
+            pfData[ 2 * i ] = pfData[ 2 * j ];
+            pfData[ 2 * j ] = fTemp;
+            fTemp = pfData[ ( 2 * i ) + 1 ];
+            pfData[ ( 2 * i ) + 1 ] = pfData[ ( 2 * j ) + 1 ];
+            pfData[ ( 2 * j ) + 1 ] = fTemp;
+        }
+    }
+}
+
+void vDspFft( float *pfData, size_t xSize, const float *pfTwiddles )
+{
+    size_t xSpan, xHalf, xStride, i, j;
+    float fUr, fUi, fVr, fVi, fWr, fWi, fTr, fTi;
+
+    configASSERT( ( xSize & ( xSize - 1 ) ) == 0 );
+
+    prvBitReverse( pfData, xSize );
+
+    for( xSpan = 2; xSpan <= xSize; xSpan <<= 1 )
+    {
+        xHalf = xSpan >> 1;
+        xStride = xSize / xSpan;
+
+        for( i = 0; i < xSize; i += xSpan )
+        {
+            j = 0;
+
+            #if defined( __SSE2__ )
+            {
+                /* Two butterflies at a time: each register holds two
+                interleaved complex values. */
+                const __m128 xNegateReal = _mm_castsi128_ps( _mm_set_epi32( 0, ( int ) 0x80000000, 0, ( int ) 0x80000000 ) );
+                __m128 xU, xV, xW, xProd;
+
+                for( ; j + 2 <= xHalf; j += 2 )
+                {
+                    xW = _mm_loadl_pi( _mm_setzero_ps(), ( const __m64 * ) &pfTwiddles[ 2 * j * xStride ] );
+                    xW = _mm_loadh_pi( xW, ( const __m64 * ) &pfTwiddles[ 2 * ( j + 1 ) * xStride ] );
+                    xU = _mm_loadu_ps( &pfData[ 2 * ( i + j ) ] );
+                    xV = _mm_loadu_ps( &pfData[ 2 * ( i + j + xHalf ) ] );
+
+                    /* (vr + j vi)(wr + j wi) = (vr wr - vi wi) + j (vi wr + vr wi) */
+                    xProd = _mm_mul_ps( xV, _mm_shuffle_ps( xW, xW, _MM_SHUFFLE( 2, 2, 0, 0 ) ) );
+                    xV = _mm_mul_ps( _mm_shuffle_ps( xV, xV, _MM_SHUFFLE( 2, 3, 0, 1 ) ),
+                                     _mm_shuffle_ps( xW, xW, _MM_SHUFFLE( 3, 3, 1, 1 ) ) );
+                    xProd = _mm_add_ps( xProd, _mm_xor_ps( xV, xNegateReal ) );
+
+                    _mm_storeu_ps( &pfData[ 2 * ( i + j ) ], _mm_add_ps( xU, xProd ) );
+                    _mm_storeu_ps( &pfData[ 2 * ( i + j + xHalf ) ], _mm_sub_ps( xU, xProd ) );
+                }
+            }
+            #endif
+
+            for( ; j < xHalf; j++ )
+            {
+                fWr = pfTwiddles[ 2 * j * xStride ];
+                fWi = pfTwiddles[ ( 2 * j * xStride ) + 1 ];
+                fUr = pfData[ 2 * ( i + j ) ];
+                fUi = pfData[ ( 2 * ( i + j ) ) + 1 ];
+                fVr = pfData[ 2 * ( i + j + xHalf ) ];
+                fVi = pfData[ ( 2 * ( i + j + xHalf ) ) + 1 ];
+
+                fTr = ( fVr * fWr ) - ( fVi * fWi );
+                fTi = ( fVi * fWr ) + ( fVr * fWi );
+
+                pfData[ 2 * ( i + j ) ] = fUr + fTr;
+                pfData[ ( 2 * ( i + j ) ) + 1 ] = fUi + fTi;
+                pfData[ 2 * ( i + j + xHalf ) ] = fUr - fTr;
+                pfData[ ( 2 * ( i + j + xHalf ) ) + 1 ] = fUi - fTi;
+            }
+        }
+    }
+}
+
+size_t xDspSpectrumKernel( void *pvContext, float *pfBlock, size_t xLength )
+{
+    DspSpectrum_t *pxSpectrum = ( DspSpectrum_t * ) pvContext;
+    float *pfWork = pxSpectrum->pfWork;
+    size_t x;
+
+    configASSERT( xLength == pxSpectrum->xSize );
+
+    for( x = 0; x < xLength; x++ )
+    {
+        pfWork[ 2 * x ] = pfBlock[ x ];
+        pfWork[ ( 2 * x ) + 1 ] = 0.0f;
+    }
+
+    vDspFft( pfWork, xLength, pxSpectrum->pfTwiddles );
+
+    for( x = 0; x < xLength / 2; x++ )
+    {
+        pfBlock[ x ] = sqrtf( ( pfWork[ 2 * x ] * pfWork[ 2 * x ] ) +
+                              ( pfWork[ ( 2 * x ) + 1 ] * pfWork[ ( 2 * x ) + 1 ] ) );
+    }
+
+    return xLength / 2;
+}
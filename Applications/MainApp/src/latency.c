@@ -0,0 +1,113 @@
+/*
+ * Latency histogram.  See latency.h.
+ */
+
+#include <string.h>
+
+/* Microkernel includes */
+#include "FreeRTOS.h"
+
+#include "latency.h"
+
+#define latencySUB_BUCKETS      ( 1UL << latencySUB_BUCKET_BITS )
+
+static UBaseType_t prvBucketIndex( uint32_t ulValue )
+{
+    uint32_t ulMsb;
+
+    if( ulValue < latencySUB_BUCKETS )
+    {
+        return ( UBaseType_t ) ulValue;
+    }
+
+    ulMsb = 31UL - ( uint32_t ) __builtin_clz( ulValue );
+
+    return ( UBaseType_t ) ( ( ( ulMsb - latencySUB_BUCKET_BITS + 1UL ) << latencySUB_BUCKET_BITS ) +
+                             ( ( ulValue >> ( ulMsb - latencySUB_BUCKET_BITS ) ) & ( latencySUB_BUCKETS - 1UL ) ) );
+}
+
+uint32_t ulLatencyBucketLimit( UBaseType_t uxIndex )
+{
+    uint32_t ulShift;
+    uint64_t ullLower;
+
+    if( uxIndex < latencySUB_BUCKETS )
+    {
+        return ( uint32_t ) uxIndex;
+    }
+
+    ulShift = ( uint32_t ) ( uxIndex >> latencySUB_BUCKET_BITS ) - 1UL;
+    ullLower = ( uint64_t ) ( latencySUB_BUCKETS + ( uxIndex & ( latencySUB_BUCKETS - 1UL ) ) ) << ulShift;
+
+    return ( uint32_t ) ( ullLower + ( 1ULL << ulShift ) - 1ULL );
+}
+
+void vLatencyReset( LatencyHistogram_t *pxHistogram )
+{
+    memset( pxHistogram, 0, sizeof( *pxHistogram ) );
+}
+
+void vLatencyAdd( LatencyHistogram_t *pxHistogram, uint32_t ulValue )
+{
+    pxHistogram->ulBuckets[ prvBucketIndex( ulValue ) ]++;
+    pxHistogram->ullCount++;
+    pxHistogram->ullSum += ulValue;
+
+    if( ulValue > pxHistogram->ulMax )
+    {
+        pxHistogram->ulMax = ulValue;
+    }
+}
+
+void vLatencyAddSpan( LatencyHistogram_t *pxHistogram, uint32_t ulFirst, uint32_t ulLast,
+                      uint32_t ulCount, uint32_t ulDone )
+{
+    uint32_t ulSpan = ulLast - ulFirst;
+    uint32_t ulCreated;
+    uint32_t x;
+
+    for( x = 0; x < ulCount; x++ )
+    {
+        ulCreated = ulFirst;
+
+        if( ulCount > 1 )
+        {
+            ulCreated += ( uint32_t ) ( ( ( uint64_t ) ulSpan * x ) / ( ulCount - 1 ) );
+        }
+
+        vLatencyAdd( pxHistogram, ulDone - ulCreated );
+    }
+}
+
+uint32_t ulLatencyPercentile( const LatencyHistogram_t *pxHistogram, uint32_t ulPerMille )
+{
+    uint64_t ullTarget;
+    uint64_t ullSeen = 0;
+    UBaseType_t x;
+
+    if( pxHistogram->ullCount == 0 )
+    {
+        return 0;
+    }
+
+    /* Rank of the value, rounded up so that p1000 is the last one. */
+    ullTarget = ( ( pxHistogram->ullCount * ulPerMille ) + 999U ) / 1000U;
+
+    if( ullTarget == 0 )
+    {
+        ullTarget = 1;
+    }
+
+    for( x = 0; x < latencyBUCKETS; x++ )
+    {
+        ullSeen += pxHistogram->ulBuckets[ x ];
+
+        if( ullSeen >= ullTarget )
+        {
+            /* The bucket limit can be above the largest value seen. */
+            return ( ulLatencyBucketLimit( x ) < pxHistogram->ulMax ) ? ulLatencyBucketLimit( x ) : pxHistogram->ulMax;
+        }
+    }
+
+    return pxHistogram->ulMax;
+}
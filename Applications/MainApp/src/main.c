@@ -14,6 +14,9 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+
 /* Local includes. */
 #include "console.h"
 
@@ -21,7 +24,6 @@
 
 /*-----------------------------------------------------------*/
 extern void main_app( void );
-static void traceOnEnter( void );
 
 /*
  * Prototypes for the standard FreeRTOS application hook (callback) functions
@@ -45,6 +47,13 @@ void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer,
  */
 static void prvSaveTraceFile( void );
 
+/*
+ * Implements the "trace" command, which saves the trace recorded so far.
+ */
+static BaseType_t prvTraceCommand( char *pcWriteBuffer,
+                                   size_t xWriteBufferLen,
+                                   const char *pcCommandString );
+
 /*-----------------------------------------------------------*/
 
 /* When configSUPPORT_STATIC_ALLOCATION is set to 1 the application writer can
@@ -57,6 +66,14 @@ StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
 /* Notes if the trace is running or not. */
 static BaseType_t xTraceRunning = pdTRUE;
 
+static const CLI_Command_Definition_t xTraceCommand =
+{
+    "trace",
+    "trace: Stops the trace recorder and saves it to Trace.dump\r\n",
+    prvTraceCommand,
+    0
+};
+
 /*-----------------------------------------------------------*/
 
 int main( void )
@@ -76,6 +93,8 @@ int main( void )
 
     console_init();
     console_print("Starting main application\n\n");
+
+    FreeRTOS_CLIRegisterCommand( &xTraceCommand );
     main_app();
 
     return 0;
@@ -112,8 +131,9 @@ void vApplicationIdleHook( void )
     because it is the responsibility of the idle task to clean up memory
     allocated by the kernel to any task that has since deleted itself. */
 
+#if ( portUSE_VIRTUAL_TIME == 0 )
     usleep(15000);
-    traceOnEnter();
+#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -143,25 +163,28 @@ void vApplicationTickHook( void )
     /* Some timer functionality */
 }
 
-void traceOnEnter()
+static BaseType_t prvTraceCommand( char *pcWriteBuffer,
+                                   size_t xWriteBufferLen,
+                                   const char *pcCommandString )
 {
-    int ret;
-    struct timeval tv = { 0L, 0L };
-    fd_set fds;
-    FD_ZERO(&fds);
-    FD_SET(0, &fds);
-    ret = select(1, &fds, NULL, NULL, &tv);
-    if ( ret > 0 )
-    {
+    ( void ) pcCommandString;
+
+    /* Input used to be polled from the idle hook for this, stdin is now
+    only read by the console. */
     if( xTraceRunning == pdTRUE )
     {
+        xTraceRunning = pdFALSE;
         prvSaveTraceFile();
+        snprintf( pcWriteBuffer, xWriteBufferLen, "\n" );
     }
-    /* clear the buffer */
-    char buffer[200];
-    read(1, &buffer, 200);
+    else
+    {
+        snprintf( pcWriteBuffer, xWriteBufferLen, "Trace already saved\r\n" );
     }
+
+    return pdFALSE;
 }
+/*-----------------------------------------------------------*/
 
 void vLoggingPrintf( const char *pcFormat,
                      ... )
@@ -7,6 +7,7 @@
 /*Libs to generate random includes*/
 #include <stdio.h> 
 #include <stdlib.h> 
+#include <string.h> 
 #include <time.h> 
 
 /* Microkernel includes */
@@ -16,12 +17,94 @@
 #include "semphr.h"
 #include "console.h"
 #include "queue.h"
+#include "adc_block.h"
+#include "dsp.h"
+#include "snapshot.h"
+#include "channel.h"
+#include "telemetry.h"
+#include "bench.h"
+#include "FreeRTOS_CLI.h"
+#include "QueueInPlace.h"
+#include "SharedMessageBuffer.h"
+
+/* Builds the DSP chain run on the blocks of every channel */
+static void prvSetupProcessingChain(void);
+
+/* Commands of the serial interface */
+static BaseType_t prvObterCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+static BaseType_t prvZerarCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+static BaseType_t prvCpuCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+static BaseType_t prvOverloadCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+static BaseType_t prvCanaisCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+static BaseType_t prvBenchCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+static BaseType_t prvSelftestCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+
+static const CLI_Command_Definition_t xObterCommand =
+{
+    "obter",
+    "obter [csv|bin] [channel]: Prints the processed values of a channel (the first by default), as CSV, or saves them to adc_values_<channel>.bin\r\n",
+    prvObterCommand,
+    -1
+};
+
+static const CLI_Command_Definition_t xZerarCommand =
+{
+    "zerar",
+    "zerar: Clears the processed values of every channel and restarts the capture\r\n",
+    prvZerarCommand,
+    0
+};
+
+static const CLI_Command_Definition_t xCpuCommand =
+{
+    "cpu",
+    "cpu [csv|json]: Prints the CPU load of each task, the load history as CSV or the last sample as JSON\r\n",
+    prvCpuCommand,
+    -1
+};
+
+static const CLI_Command_Definition_t xOverloadCommand =
+{
+    "overload",
+    "overload [wait <ms>|overwrite|decimate <factor>]: Shows or selects what the acquisition does when processing falls behind\r\n",
+    prvOverloadCommand,
+    -1
+};
+
+static const CLI_Command_Definition_t xCanaisCommand =
+{
+    "canais",
+    "canais: Lists the channels with their rate, progress and statistics\r\n",
+    prvCanaisCommand,
+    0
+};
+
+static const CLI_Command_Definition_t xBenchCommand =
+{
+    "bench",
+    "bench [rate_hz|max] [seconds]: Feeds the BENCH channel with synthetic samples (1000 Hz for 2 s by default) and prints its latency and throughput as JSON\r\n"
+    "bench switch [round_trips]: Ping-pongs between two tasks (100000 round trips by default) and prints the time per context switch as JSON\r\n"
+    "bench churn [tasks]: Creates, runs and deletes tasks one after the other (10000 by default) and prints the time per task as JSON\r\n"
+    "bench jitter [period_ms] [seconds]: Times the periods of a vTaskDelayUntil() loop (10 ms for 2 s by default) and prints their jitter as JSON\r\n",
+    prvBenchCommand,
+    -1
+};
+
+static const CLI_Command_Definition_t xSelftestCommand =
+{
+    "selftest",
+    "selftest: Starts the kernel self test tasks on the first call, then prints as JSON whether they made progress without errors since the previous call\r\n",
+    prvSelftestCommand,
+    0
+};
 
 /* Task prototypes */
-static void prvADCRead(void *pvParameters);
 static void prvSerialInterface(void *pvParameters);
-static void prvProcessing(void *pvParameters);
 static void prvStats(void *pvParameters);
+static void prvPrintHostCores(void);
+
+/* Simulated ADC input of every channel */
+static uint16_t prvReadAdc(void *pvContext);
 
 #define PI 3.141592
 #define BUFFER_SIZE 1000
@@ -31,28 +114,96 @@ static void prvStats(void *pvParameters);
 #define prioProcessing      (tskIDLE_PRIORITY + 3) // Low Priority
 #define prioSerialInterface (tskIDLE_PRIORITY + 3) // Low Priority
 #define prioStats           (tskIDLE_PRIORITY + 3) // Low Priority
+#define prioBenchSource     (tskIDLE_PRIORITY + 4) // High Priority
+#define prioSelftest        (tskIDLE_PRIORITY + 1) // Below the application
 
 /* Some definitions */
 #define pdTICKS_TO_MS( xTicks ) ( ( xTicks * 1000 ) / configTICK_RATE_HZ )
 
+/* Number of tasks processing the blocks of all the channels */
+#ifndef procWORKER_TASKS
+    #define procWORKER_TASKS 2
+#endif
+
+/* Set to 1 to low pass filter the samples before scaling them. procFIR_CUTOFF
+   is relative to the sample rate of each channel. */
+#ifndef procUSE_LOW_PASS_FILTER
+    #define procUSE_LOW_PASS_FILTER 0
+#endif
+#define procFIR_TAPS   31
+#define procFIR_CUTOFF 0.1f
+
+/* What the acquisition does when a channel has no empty block left (see
+   adc_block.h). The wait and the decimation factor are only used by their own
+   policy. A wait holds up the sampling of every channel. */
+#ifndef acqOVERLOAD_POLICY
+    #define acqOVERLOAD_POLICY eAdcOverloadOverwrite
+#endif
+#define acqOVERLOAD_WAIT_MS    0
+#define acqDECIMATE_FACTOR     4
+
 /* Define if tasks are periodic */
-#define pTaskADCRead pdMS_TO_TICKS(1);
-#define pTaskADCProc pdMS_TO_TICKS(100);
 #define pTaskStats   pdMS_TO_TICKS(3000);
-#define pTaskSerialInterface pdMS_TO_TICKS(1);
 
 /* Handle for Tasks (optional for Linux) */
-TaskHandle_t xHandleADCRead = NULL;
-TaskHandle_t xHandleProcessing = NULL;
 TaskHandle_t xHandleSerialInterface = NULL;
 TaskHandle_t xHandleStats = NULL;
 
-float processed_adc_values[BUFFER_SIZE];
-uint32_t proc_current_position = 0;
+/* Channels acquired by the application, each one with its own pipeline (see
+   channel.h) */
+typedef struct ChannelConfig
+{
+    const char *pcName;
+    uint32_t ulPeriodMs;
+} ChannelConfig_t;
+
+static const ChannelConfig_t xChannelTable[] =
+{
+    { "ADC0", 1 },
+    { "ADC1", 2 },
+    { "ADC2", 5 },
+    { "ADC3", 10 },
+};
+
+#define NUM_CHANNELS ( sizeof(xChannelTable) / sizeof(xChannelTable[0]) )
+
+static Channel_t xChannels[NUM_CHANNELS];
+
+/* Processed values of every channel */
+static float processed_adc_values[NUM_CHANNELS][BUFFER_SIZE];
+
+/* Channel fed by the "bench" command instead of the acquisition task. It has
+   the same processing chain as the others and its values wrap around, so it
+   can run for as long as needed */
+static Channel_t xBenchChannel;
+static float fBenchValues[BUFFER_SIZE];
+
+/* Copy of one channel's processed values used by the "obter" command, and
+   the next value it prints, as the export takes several calls */
+static float fSnapshotValues[BUFFER_SIZE];
+static size_t xSnapshotNext = 0;
+
+/* Next channel printed by the "canais" command, which prints one per call */
+static size_t xChannelListIndex = 0;
+
+/* Per-task CPU load, sampled by prvStats */
+static Telemetry_t xTelemetry;
+static char cTelemetryText[64 + (telemetryMAX_TASKS * 64)];
+
+/* Processing chain stages. The gain has no state and is shared, the filter
+   keeps a delay line and needs one instance per channel */
+static DspGain_t xProcGain = { PI, 0.0f };
+#if ( procUSE_LOW_PASS_FILTER == 1 )
+    static float fProcFirCoeffs[procFIR_TAPS];
+    static float fProcFirWorkspace[NUM_CHANNELS][dspFIR_WORKSPACE_SIZE(procFIR_TAPS, adcBLOCK_SAMPLES)];
+    static DspFir_t xProcFir[NUM_CHANNELS];
+    static float fBenchFirWorkspace[dspFIR_WORKSPACE_SIZE(procFIR_TAPS, adcBLOCK_SAMPLES)];
+    static DspFir_t xBenchFir;
+#endif
 
 int main_app()
 {
-    QueueHandle_t xQueue;
+    size_t x;
 
     /* Initializing console */
     console_init();
@@ -60,36 +211,50 @@ int main_app()
     /* Seed random numbers */
     srand(time(0));
 
-    /* Creating queue */
-    console_print("Creating Queues... \n");
-    xQueue = xQueueCreate(BUFFER_SIZE, BUFFER_SIZE);
-    
-    if (xQueue == NULL)
+    /* Creating queues */
+    console_print("Creating %u channels... \n", (unsigned) NUM_CHANNELS);
+
+    for (x = 0; x < NUM_CHANNELS; x++)
+    {
+        if (xChannelInit(&xChannels[x], xChannelTable[x].pcName, pdMS_TO_TICKS(xChannelTable[x].ulPeriodMs),
+                         prvReadAdc, NULL, processed_adc_values[x], BUFFER_SIZE) != pdPASS)
+        {
+            console_print("Failed on create queue (memory), the program has stopped. Ctrl + C to finish. \n"); 
+            for (;;);
+        }
+
+        vAdcBlockSetPolicy(&xChannels[x].xPool, acqOVERLOAD_POLICY, pdMS_TO_TICKS(acqOVERLOAD_WAIT_MS), acqDECIMATE_FACTOR);
+    }
+
+    if (xChannelInit(&xBenchChannel, "BENCH", 1, prvReadAdc, NULL, fBenchValues, BUFFER_SIZE) != pdPASS)
     {
         console_print("Failed on create queue (memory), the program has stopped. Ctrl + C to finish. \n"); 
         for (;;);
-    } 
-    else
-    {
-        /* Setting name to Queue */
-        vQueueAddToRegistry( xQueue, "Queue-01" );
-        console_print("Queue created... \n");
     }
-    
-    /* Creating tasks */
-    xTaskCreate(prvADCRead,                      /* Task Function */
-                "ADCRead",                       /* Name of task (for debugging propose only) */
-                configMINIMAL_STACK_SIZE * 10,   /* Memory Stack */
-                xQueue,                          /* Used to pass a parameter to the task */
-                prioADCRead,                     /* Priority of Task */
-                &xHandleADCRead);                /* Microcontroller use a Task Handle (optional on Linux) */
 
-    xTaskCreate(prvProcessing,                   /* Task Function */
-                "Processing",                    /* Name of task (for debugging propose only) */
-                configMINIMAL_STACK_SIZE * 10,   /* Memory Stack */
-                xQueue,                          /* Used to pass a parameter to the task */
-                prioProcessing,                  /* Priority of Task */
-                &xHandleProcessing);             /* Microcontroller use a Task Handle (optional on Linux) */
+    xBenchChannel.xWrap = pdTRUE;
+
+    console_print("Channels created... \n");
+
+    prvSetupProcessingChain();
+    vTelemetryInit(&xTelemetry);
+
+    /* Commands accepted by prvSerialInterface */
+    FreeRTOS_CLIRegisterCommand(&xObterCommand);
+    FreeRTOS_CLIRegisterCommand(&xZerarCommand);
+    FreeRTOS_CLIRegisterCommand(&xCpuCommand);
+    FreeRTOS_CLIRegisterCommand(&xOverloadCommand);
+    FreeRTOS_CLIRegisterCommand(&xCanaisCommand);
+    FreeRTOS_CLIRegisterCommand(&xBenchCommand);
+    FreeRTOS_CLIRegisterCommand(&xSelftestCommand);
+    
+    /* Creating tasks: one acquisition task and procWORKER_TASKS processing
+       tasks shared by all the channels */
+    if (xChannelSchedulerStart(xChannels, NUM_CHANNELS, procWORKER_TASKS, prioADCRead, prioProcessing) != pdPASS)
+    {
+        console_print("Failed on create tasks (memory), the program has stopped. Ctrl + C to finish. \n"); 
+        for (;;);
+    }
 
     xTaskCreate(prvSerialInterface,              /* Task Function */
                 "SerialInterface",               /* Name of task (for debugging propose only) */
@@ -107,6 +272,9 @@ int main_app()
 
     console_print("Starting scheduling, use Ctrl + C on any moment to finish ... \n");
 
+    /* Start reading commands from stdin */
+    console_input_init();
+
     /* Initializing Scheduler */
     vTaskStartScheduler();
 
@@ -114,133 +282,452 @@ int main_app()
     for(;;);
 }
 
-static void prvADCRead(void *pvParameters)
+static void prvSetupProcessingChain(void)
 {
-    TickType_t xLastWakeTime;
-    const TickType_t xFrequency = pTaskADCRead;
-    xLastWakeTime = xTaskGetTickCount();
+    size_t x;
 
-    /* Queue variables */
-    QueueHandle_t xQueue = NULL;
+#if ( procUSE_LOW_PASS_FILTER == 1 )
+    vDspDesignLowPass(fProcFirCoeffs, procFIR_TAPS, procFIR_CUTOFF);
+#endif
 
-    /* Struct message for queue */
-    uint8_t raw_adc_values[BUFFER_SIZE];
-    uint32_t raw_current_position = 0;
+    for (x = 0; x < NUM_CHANNELS; x++)
+    {
+#if ( procUSE_LOW_PASS_FILTER == 1 )
+        vDspFirInit(&xProcFir[x], fProcFirCoeffs, procFIR_TAPS, fProcFirWorkspace[x], adcBLOCK_SAMPLES);
+        xDspChainAppend(&xChannels[x].xChain, xDspFirKernel, &xProcFir[x]);
+#endif
 
-    /* Restoring xQueue from higher context. */
-    xQueue = (QueueHandle_t) pvParameters;
+        xDspChainAppend(&xChannels[x].xChain, xDspGainKernel, &xProcGain);
+    }
 
-    /* Checking parameter passed to task */
-    configASSERT(xQueue != NULL);
+#if ( procUSE_LOW_PASS_FILTER == 1 )
+    vDspFirInit(&xBenchFir, fProcFirCoeffs, procFIR_TAPS, fBenchFirWorkspace, adcBLOCK_SAMPLES);
+    xDspChainAppend(&xBenchChannel.xChain, xDspFirKernel, &xBenchFir);
+#endif
 
-    /* Inform tasks information */
-    console_print("\n******* %s STATS *******", pcTaskGetName(xHandleADCRead));
-    console_print("\n Task Priority: %d", uxTaskPriorityGet(xHandleADCRead));
-    console_print("\n Queue Name: %s", pcQueueGetName(xQueue));
-    console_print("\n Queue Space Used: %d", uxQueueMessagesWaiting(xQueue));
-    console_print("\n Queue Space Avaliable: %d", uxQueueSpacesAvailable(xQueue));
-    console_print("\n******************************\n");
+    xDspChainAppend(&xBenchChannel.xChain, xDspGainKernel, &xProcGain);
+}
 
-    for (;;)
-    {   
-        /* Gets time since last execution */
-        xLastWakeTime = xTaskGetTickCount();
+static uint16_t prvReadAdc(void *pvContext)
+{
+    (void) pvContext;
 
-        /* Executes every 1 ms */
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
-        /*
-        console_print("\n\n");
-        console_print("[ADCRead] running at %lld ms after vTaskStartScheduler() called. \n", pdTICKS_TO_MS(xTaskGetTickCount()));
-        */
-        
-        /* Read ADC value - 10 bits resolution is considered */
-        raw_adc_values[raw_current_position] = rand() % 1023;
-        
-        /*
-        console_print("-Sending- ");
-        console_print(" Message ID : [%d]", raw_current_position);
-        console_print(" ADC value  : [%d]", raw_adc_values[raw_current_position]);
-        */
-
-        /* Send the message */
-        if(xQueueSend(xQueue, ( void * ) &raw_adc_values, pdMS_TO_TICKS(0)) == pdTRUE && raw_current_position < BUFFER_SIZE)
+    /* Read ADC value - 10 bits resolution is considered */
+    return rand() % 1023;
+}
+
+/* Whether a command parameter is exactly pcWord, not just a prefix of it */
+static BaseType_t prvParameterIs(const char *pcParameter, BaseType_t xParameterLength, const char *pcWord)
+{
+    return (pcParameter != NULL && strlen(pcWord) == (size_t) xParameterLength &&
+            strncmp(pcParameter, pcWord, xParameterLength) == 0) ? pdTRUE : pdFALSE;
+}
+
+/* Reads a whole command parameter as a decimal number, pdFAIL if it is
+   missing or has anything else in it */
+static BaseType_t prvParameterToInt(const char *pcParameter, BaseType_t xParameterLength, int *piValue)
+{
+    char *pcEnd;
+    long lValue;
+
+    if(pcParameter == NULL || xParameterLength == 0)
+    {
+        return pdFAIL;
+    }
+
+    lValue = strtol(pcParameter, &pcEnd, 10);
+
+    if(pcEnd != pcParameter + xParameterLength || lValue < -2147483647L || lValue > 2147483647L)
+    {
+        return pdFAIL;
+    }
+
+    *piValue = (int) lValue;
+    return pdPASS;
+}
+
+/* Finds a channel by name or index, NULL if there is none */
+static Channel_t *prvFindChannel(const char *pcName, BaseType_t xNameLength)
+{
+    char *pcEnd;
+    unsigned long ulIndex;
+    size_t x;
+
+    for (x = 0; x < NUM_CHANNELS; x++)
+    {
+        if (strlen(xChannels[x].pcName) == (size_t) xNameLength &&
+            strncmp(xChannels[x].pcName, pcName, xNameLength) == 0)
         {
-            /* Increments current vector position thus the next reading does not overwrite information */
-            raw_current_position++;
-        } else {
-            console_print("\n-ADC vector is full-\n");
+            return &xChannels[x];
+        }
+    }
+
+    ulIndex = strtoul(pcName, &pcEnd, 10);
+    if (pcEnd == pcName + xNameLength && ulIndex < NUM_CHANNELS)
+    {
+        return &xChannels[ulIndex];
+    }
 
-            /* Suspend current task. No new ADC information is read until users types "zerar" */
-            vTaskSuspend( xHandleADCRead );
+    return NULL;
+}
+
+static BaseType_t prvObterCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString)
+{
+    const char *pcParameter;
+    BaseType_t xParameterLength;
+    const char *pcFormat = NULL;
+    Channel_t *pxChannel = &xChannels[0];
+    char cFileName[32];
+    UBaseType_t uxParameter;
+
+    /* The format and the channel can be given in any order */
+    for(uxParameter = 1; uxParameter <= 2; uxParameter++)
+    {
+        pcParameter = FreeRTOS_CLIGetParameter(pcCommandString, uxParameter, &xParameterLength);
 
-            /* Deinit current position */
-            raw_current_position = 0;
+        if(pcParameter == NULL)
+        {
+            break;
+        }
+
+        if(prvParameterIs(pcParameter, xParameterLength, "csv") || prvParameterIs(pcParameter, xParameterLength, "bin"))
+        {
+            pcFormat = pcParameter;
+        }
+        else if((pxChannel = prvFindChannel(pcParameter, xParameterLength)) == NULL)
+        {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Unknown format or channel, use obter [csv|bin] [channel]\n\n");
+            return pdFALSE;
         }
     }
+
+    if(pcFormat == NULL || prvParameterIs(pcFormat, 3, "csv"))
+    {
+        /* Readers work on a consistent copy, the processing tasks are never
+           stalled. The copy is taken on the first call and printed over as
+           many calls as needed */
+        if(xSnapshotNext == 0)
+        {
+            vSnapshotRead(&pxChannel->xSnapshot, fSnapshotValues);
+        }
+
+        if(pcFormat == NULL)
+        {
+            /* print current ADC processed values */
+            xSnapshotFormatText(fSnapshotValues, BUFFER_SIZE, &xSnapshotNext, pcWriteBuffer, xWriteBufferLen);
+        }
+        else
+        {
+            xSnapshotFormatCsv(fSnapshotValues, BUFFER_SIZE, &xSnapshotNext, pcWriteBuffer, xWriteBufferLen);
+        }
+
+        if(xSnapshotNext < BUFFER_SIZE)
+        {
+            return pdTRUE;
+        }
+
+        xSnapshotNext = 0;
+    }
+    else
+    {
+        vSnapshotRead(&pxChannel->xSnapshot, fSnapshotValues);
+
+        /* Raw float32 values in host byte order */
+        snprintf(cFileName, sizeof(cFileName), "adc_values_%s.bin", pxChannel->pcName);
+
+        if(xSnapshotSaveBinary(fSnapshotValues, BUFFER_SIZE, cFileName) == pdPASS)
+        {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "%d values saved to %s\n\n", BUFFER_SIZE, cFileName);
+        }
+        else
+        {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Failed to save %s\n\n", cFileName);
+        }
+    }
+
+    return pdFALSE;
 }
 
-static void prvProcessing(void *pvParameters)
+static BaseType_t prvCpuCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString)
 {
-    TickType_t xLastWakeTime;
-    const TickType_t xFrequency = pTaskADCProc;
-
-    /* Queue variables */
-    QueueHandle_t xQueue = NULL;
-    uint8_t received_adc_values[BUFFER_SIZE];
-        
-    /* Restoring xQueue from higher context. */
-    xQueue = (QueueHandle_t) pvParameters;
-        
-    /* Checking parameter passed to  task */
-    configASSERT(xQueue != NULL);
-
-    /* Inform tasks information */
-    console_print("\n******* %s STATS *******", pcTaskGetName(xHandleProcessing));
-    console_print("\n Task Priority: %d", uxTaskPriorityGet(xHandleProcessing));
-    console_print("\n Queue Name: %s", pcQueueGetName(xQueue));
-    console_print("\n Queue Space Used: %d", uxQueueMessagesWaiting(xQueue));
-    console_print("\n Queue Space Avaliable: %d", uxQueueSpacesAvailable(xQueue));
-    console_print("\n******************************\n");
+    const char *pcFormat;
+    BaseType_t xFormatLength;
+
+    pcFormat = FreeRTOS_CLIGetParameter(pcCommandString, 1, &xFormatLength);
 
-    for (;;)
+    if(pcFormat == NULL)
     {
-        /* Gets time since last execution */
-        xLastWakeTime = xTaskGetTickCount();
+        xTelemetryFormatText(&xTelemetry, pcWriteBuffer, xWriteBufferLen);
+    }
+    else if(prvParameterIs(pcFormat, xFormatLength, "csv"))
+    {
+        xTelemetryFormatCsv(&xTelemetry, pcWriteBuffer, xWriteBufferLen);
+    }
+    else if(prvParameterIs(pcFormat, xFormatLength, "json"))
+    {
+        xTelemetryFormatJson(&xTelemetry, pcWriteBuffer, xWriteBufferLen);
+    }
+    else
+    {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Unknown format, use cpu [csv|json]\n\n");
+    }
 
-        /* Executes every 100 ms */
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+    return pdFALSE;
+}
 
-        /*
-        console_print("\n\n");
-        console_print("[Processing] running at %lld ms after vTaskStartScheduler() called. \n", pdTICKS_TO_MS(xTaskGetTickCount()));
-        */
-
-        if(xQueueReceive( xQueue,( void * ) &received_adc_values, pdMS_TO_TICKS(0)) == pdTRUE){
-            /*
-            console_print("-Received- ");
-            console_print(" Message ID : [%d]", proc_current_position);
-            console_print(" ADC value : [%d]", received_adc_values[proc_current_position]);
-            */
-            
-            processed_adc_values[proc_current_position] = received_adc_values[proc_current_position] * PI;
-            /* console_print(" Processed value : [%.2f]", processed_adc_values[proc_current_position]); */
-            proc_current_position++;
-        } else {
-            console_print("-All ADC values were processed- ");
-            /* Back to initial position */ 
-            proc_current_position = 0;
-
-            /* Suspend current task. No new ADC information is processed until users types "zerar" */
-            vTaskSuspend( xHandleProcessing );
+static BaseType_t prvOverloadCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString)
+{
+    static const char * const pcPolicyNames[] = { "wait", "overwrite", "decimate" };
+    AdcBlockPool_t *pxPool = &xChannels[0].xPool;
+    eAdcOverloadPolicy ePolicy = pxPool->ePolicy;
+    TickType_t xWaitTicks = pxPool->xWaitTicks;
+    uint32_t ulDecimateFactor = pxPool->ulDecimateFactor;
+    const char *pcPolicy;
+    const char *pcValue;
+    BaseType_t xPolicyLength;
+    BaseType_t xValueLength;
+    int iValue = 0;
+    BaseType_t xValueValid;
+    size_t x;
+
+    pcPolicy = FreeRTOS_CLIGetParameter(pcCommandString, 1, &xPolicyLength);
+    pcValue = FreeRTOS_CLIGetParameter(pcCommandString, 2, &xValueLength);
+    xValueValid = prvParameterToInt(pcValue, xValueLength, &iValue);
+
+    if(pcPolicy == NULL)
+    {
+        /* Only show the current policy */
+    }
+    else if(prvParameterIs(pcPolicy, xPolicyLength, "wait") && xValueValid == pdPASS && iValue >= 0)
+    {
+        ePolicy = eAdcOverloadWait;
+        xWaitTicks = pdMS_TO_TICKS(iValue);
+    }
+    else if(prvParameterIs(pcPolicy, xPolicyLength, "overwrite") && pcValue == NULL)
+    {
+        ePolicy = eAdcOverloadOverwrite;
+    }
+    else if(prvParameterIs(pcPolicy, xPolicyLength, "decimate") && xValueValid == pdPASS && iValue > 1)
+    {
+        ePolicy = eAdcOverloadDecimate;
+        ulDecimateFactor = (uint32_t) iValue;
+    }
+    else
+    {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Use overload [wait <ms>|overwrite|decimate <factor>], factor above 1\n\n");
+        return pdFALSE;
+    }
+
+    /* Same policy on every channel */
+    for(x = 0; x < NUM_CHANNELS; x++)
+    {
+        vAdcBlockSetPolicy(&xChannels[x].xPool, ePolicy, xWaitTicks, ulDecimateFactor);
+    }
+
+    snprintf(pcWriteBuffer, xWriteBufferLen, "Overload policy: %s (wait %u ms, decimate by %u)\n\n",
+             pcPolicyNames[ePolicy], (unsigned) pdTICKS_TO_MS(xWaitTicks), (unsigned) ulDecimateFactor);
+
+    return pdFALSE;
+}
+
+static BaseType_t prvCanaisCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString)
+{
+    Channel_t *pxChannel;
+    AdcBlockStats_t xAcqStats;
+    int iLen = 0;
+
+    (void) pcCommandString;
+
+    /* Called again by the CLI until pdFALSE is returned, one channel per call */
+    if(xChannelListIndex == 0)
+    {
+        iLen = snprintf(pcWriteBuffer, xWriteBufferLen, "%-12s %7s %9s %8s %8s %8s %11s %10s %8s\n",
+                        "Channel", "Period", "Processed", "Batches", "Dropped", "Overwr.", "Decimated", "Late", "Ready");
+    }
+
+    pxChannel = &xChannels[xChannelListIndex];
+    vAdcBlockGetStats(&pxChannel->xPool, &xAcqStats);
+
+    snprintf(pcWriteBuffer + iLen, xWriteBufferLen - iLen, "%-12s %4u ms %4u/%-4u %8u %8u %8u %11u %10u %8u\n",
+             pxChannel->pcName, (unsigned) pdTICKS_TO_MS(pxChannel->xPeriod),
+             (unsigned) pxChannel->xPosition, (unsigned) BUFFER_SIZE, pxChannel->xStats.ulBatches,
+             xAcqStats.ulDropped, xAcqStats.ulOverwritten, xAcqStats.ulDecimated, xAcqStats.ulLate,
+             (unsigned) uxAdcBlocksReady(&pxChannel->xPool));
+
+    if(++xChannelListIndex < NUM_CHANNELS)
+    {
+        return pdTRUE;
+    }
+
+    xChannelListIndex = 0;
+    return pdFALSE;
+}
+
+static BaseType_t prvBenchCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString)
+{
+    static BenchReport_t xReport;
+    static BenchJitterReport_t xJitterReport;
+    BenchSwitchReport_t xSwitchReport;
+    BenchChurnReport_t xChurnReport;
+    const char *pcRate;
+    const char *pcSeconds;
+    BaseType_t xRateLength;
+    BaseType_t xSecondsLength;
+    int iRate = 1000;
+    int iSeconds = 2;
+    BaseType_t xValid = pdTRUE;
+
+    pcRate = FreeRTOS_CLIGetParameter(pcCommandString, 1, &xRateLength);
+    pcSeconds = FreeRTOS_CLIGetParameter(pcCommandString, 2, &xSecondsLength);
+
+    if(pcRate != NULL && prvParameterIs(pcRate, xRateLength, "switch"))
+    {
+        iRate = 100000;
+
+        if((pcSeconds != NULL && prvParameterToInt(pcSeconds, xSecondsLength, &iRate) != pdPASS) || iRate <= 0)
+        {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Use bench switch [round_trips]\n\n");
         }
+        else if(xBenchRunSwitch((uint32_t) iRate, prioBenchSource, &xSwitchReport) != pdPASS)
+        {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Failed on create the benchmark task (memory)\n\n");
+        }
+        else
+        {
+            xBenchFormatSwitchJson(&xSwitchReport, pcWriteBuffer, xWriteBufferLen);
+        }
+
+        return pdFALSE;
+    }
+
+    if(pcRate != NULL && prvParameterIs(pcRate, xRateLength, "churn"))
+    {
+        iRate = 10000;
+
+        if((pcSeconds != NULL && prvParameterToInt(pcSeconds, xSecondsLength, &iRate) != pdPASS) || iRate <= 0)
+        {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Use bench churn [tasks]\n\n");
+        }
+        else if(xBenchRunChurn((uint32_t) iRate, prioBenchSource, &xChurnReport) != pdPASS)
+        {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Failed on create the benchmark task (memory)\n\n");
+        }
+        else
+        {
+            xBenchFormatChurnJson(&xChurnReport, pcWriteBuffer, xWriteBufferLen);
+        }
+
+        return pdFALSE;
+    }
+
+    if(pcRate != NULL && prvParameterIs(pcRate, xRateLength, "jitter"))
+    {
+        BaseType_t xJitterSecondsLength;
+        const char *pcJitterSeconds = FreeRTOS_CLIGetParameter(pcCommandString, 3, &xJitterSecondsLength);
+
+        iRate = 10;
+
+        if((pcSeconds != NULL && prvParameterToInt(pcSeconds, xSecondsLength, &iRate) != pdPASS) ||
+           (pcJitterSeconds != NULL && prvParameterToInt(pcJitterSeconds, xJitterSecondsLength, &iSeconds) != pdPASS) ||
+           iRate <= 0 || iSeconds <= 0 || iSeconds > 60 || pdMS_TO_TICKS(iRate) == 0)
+        {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Use bench jitter [period_ms] [seconds], with 1 to 60 seconds\n\n");
+        }
+        else if(xBenchRunJitter(pdMS_TO_TICKS(iRate), (uint32_t) ((iSeconds * 1000) / iRate), prioBenchSource, &xJitterReport) != pdPASS)
+        {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Failed on create the benchmark task (memory)\n\n");
+        }
+        else
+        {
+            xBenchFormatJitterJson(&xJitterReport, pcWriteBuffer, xWriteBufferLen);
+        }
+
+        return pdFALSE;
+    }
+
+    if(pcRate != NULL && prvParameterIs(pcRate, xRateLength, "max"))
+    {
+        iRate = 0;
+    }
+    else if(pcRate != NULL && (prvParameterToInt(pcRate, xRateLength, &iRate) != pdPASS || iRate <= 0))
+    {
+        xValid = pdFALSE;
+    }
+
+    if(pcSeconds != NULL && prvParameterToInt(pcSeconds, xSecondsLength, &iSeconds) != pdPASS)
+    {
+        xValid = pdFALSE;
+    }
+
+    if(xValid == pdFALSE || iSeconds <= 0 || iSeconds > 60)
+    {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Use bench [rate_hz|max] [seconds], 1 to 60 seconds\n\n");
+        return pdFALSE;
+    }
+
+    /* Blocks the serial interface until the run is over */
+    if(xBenchRun(&xBenchChannel, (uint32_t) iRate, pdMS_TO_TICKS(iSeconds * 1000), prioBenchSource, &xReport) != pdPASS)
+    {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Failed on create the benchmark task (memory)\n\n");
+        return pdFALSE;
     }
+
+    xBenchFormatJson(&xReport, pcWriteBuffer, xWriteBufferLen);
+
+    return pdFALSE;
+}
+
+static BaseType_t prvSelftestCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString)
+{
+    static BaseType_t xStarted = pdFALSE;
+
+    (void) pcCommandString;
+
+    /* The tasks of the kernel demos run from then on, below the application */
+    if(xStarted == pdFALSE)
+    {
+        vStartQueueInPlaceTasks(prioSelftest);
+        vStartSharedMessageBufferTasks(prioSelftest);
+        xStarted = pdTRUE;
+
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Self test tasks started, run selftest again to check them\n\n");
+        return pdFALSE;
+    }
+
+    snprintf(pcWriteBuffer, xWriteBufferLen, "{\"queue_in_place\": %s, \"shared_message_buffer\": %s}\n\n",
+             (xAreQueueInPlaceTasksStillRunning() == pdPASS) ? "true" : "false",
+             (xAreSharedMessageBufferTasksStillRunning() == pdPASS) ? "true" : "false");
+
+    return pdFALSE;
+}
+
+static BaseType_t prvZerarCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString)
+{
+    size_t x;
+
+    (void) pcCommandString;
+
+    /* Acquisition keeps running, each channel is reset while no worker
+       processes it */
+    for(x = 0; x < NUM_CHANNELS; x++)
+    {
+        vChannelReset(&xChannels[x]);
+    }
+
+    pcWriteBuffer[0] = '\0';
+    (void) xWriteBufferLen;
+
+    return pdFALSE;
 }
 
 void prvSerialInterface(void *pvParameters)
 {
-    char msg[20];
-    TickType_t xLastWakeTime;
-    const TickType_t xFrequency = pTaskSerialInterface;
+    char msg[64];
+    size_t xMsgLength = 0;
+    char cRxBuffer[32];
+    size_t xReceived;
+    char *pcOutput = FreeRTOS_CLIGetOutputBuffer();
+    BaseType_t xMoreOutput;
 
     console_print("\n******* %s STATS *******", pcTaskGetName(xHandleSerialInterface));
     console_print("\n Task Priority: %d", uxTaskPriorityGet(xHandleSerialInterface));
@@ -248,61 +735,132 @@ void prvSerialInterface(void *pvParameters)
 
     for (;;) 
     {
-        /* Polling serial interface to check if user insert some information */
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        /* Blocked until the stdin reader thread delivers new characters */
+        xReceived = console_read(cRxBuffer, sizeof(cRxBuffer), portMAX_DELAY);
 
-        /* Read serial interface */
-        gets( msg );
-
-        /* Verify if some command from the pre-defined protocol was written */
-        if(strcmp(msg,"obter") == 0) 
+        for(size_t i = 0; i < xReceived; i++)
         {
-            /* print current ADC processed values */
-            console_print("[ ");
-
-            for(int loop = 0; loop < BUFFER_SIZE; loop++)
-              console_print("%.2f ", processed_adc_values[loop]);
-
-            console_print("]\n\n");
+            if(cRxBuffer[i] == '\r')
+            {
+                continue;
+            }
+
+            if(cRxBuffer[i] != '\n')
+            {
+                /* Characters beyond the line buffer are dropped */
+                if(xMsgLength < sizeof(msg) - 1)
+                {
+                    msg[xMsgLength++] = cRxBuffer[i];
+                }
+                continue;
+            }
+
+            msg[xMsgLength] = '\0';
+
+            if(xMsgLength > 0)
+            {
+                /* Commands are registered with FreeRTOS_CLIRegisterCommand() */
+                do
+                {
+                    xMoreOutput = FreeRTOS_CLIProcessCommand(msg, pcOutput, configCOMMAND_INT_MAX_OUTPUT_SIZE);
+                    console_write(pcOutput, strlen(pcOutput));
+                } while(xMoreOutput != pdFALSE);
+            }
 
             /* Deinit information read from serial interface */
             memset(msg, 0, sizeof(msg));
+            xMsgLength = 0;
         }
-        else if (strcmp(msg,"zerar") == 0) 
-        {
-            /* Deinit ADC reading and processing tasks */
-            vTaskSuspend( xHandleADCRead );
-            vTaskResume( xHandleADCRead );
+    }
+}
 
-            vTaskSuspend( xHandleProcessing );
-            vTaskResume( xHandleProcessing );
-            
-            /* Deinit information read from serial interface */
-            memset(msg, 0, sizeof(msg));
-            /* Deinit processed values vector */
-            memset(processed_adc_values, 0, sizeof(processed_adc_values));
-            /* Back to initial position */
-            proc_current_position = 0;
-        }
+/* Load of each host core running the DSP chains since the previous call,
+   the run time clock counting microseconds */
+static void prvPrintHostCores(void)
+{
+#if ( portHOST_CORES > 0 )
+    static uint64_t ullLastBusyTime[portHOST_CORES];
+    static uint32_t ulLastTime;
+    uint32_t ulNow = (uint32_t) portGET_RUN_TIME_COUNTER_VALUE();
+    uint64_t ullBusyTime;
+    UBaseType_t x;
+
+    console_print("Host cores:");
+
+    for(x = 0; x < portHOST_CORES; x++)
+    {
+        ullBusyTime = ullPortGetHostCoreBusyTime(x);
+        console_print(" %.2f%%", (ulNow != ulLastTime) ? (ullBusyTime - ullLastBusyTime[x]) / (10.0 * (ulNow - ulLastTime)) : 0.0);
+        ullLastBusyTime[x] = ullBusyTime;
     }
+
+    console_print("\n");
+    ulLastTime = ulNow;
+#endif
 }
 
 void prvStats(void *pvParameters)
 {
-    char msg[256];
+    AdcBlockStats_t xAcqStats;
+    AdcBlockStats_t xAcqTotals;
+    ChannelStats_t xProcTotals;
+    size_t xComplete;
+    size_t xLength;
+    size_t x;
     TickType_t xLastWakeTime;
     const TickType_t xFrequency = pTaskStats;
 
     console_print("\n******* %s STATS *******", pcTaskGetName(xHandleStats));
     console_print("\n Task Priority: %d", uxTaskPriorityGet(xHandleStats));
     console_print("\n******************************\n\n");
+
+    /* Starting point of the first interval */
+    xTelemetrySample(&xTelemetry);
+    xLastWakeTime = xTaskGetTickCount();
  
     for (;;) 
     {
         /* Print process consumption every 3 seconds */
         vTaskDelayUntil(&xLastWakeTime, xFrequency);
 
-        vTaskGetRunTimeStats( ( char * ) msg );
-        console_print("\n\nvTaskGetRunTimeStats INFO: \n%s\n", msg);
+        if(xTelemetrySample(&xTelemetry) != pdPASS)
+        {
+            console_print("\nCPU telemetry: no memory for the task status\n");
+        }
+
+        xLength = xTelemetryFormatText(&xTelemetry, cTelemetryText, sizeof(cTelemetryText));
+        console_print("\n\nCPU load over the last %u ms:\n", (unsigned) pdTICKS_TO_MS(xFrequency));
+        console_write(cTelemetryText, xLength);
+        prvPrintHostCores();
+
+        /* Totals over all the channels, "canais" shows each of them */
+        memset(&xAcqTotals, 0, sizeof(xAcqTotals));
+        memset(&xProcTotals, 0, sizeof(xProcTotals));
+        xComplete = 0;
+
+        for(x = 0; x < NUM_CHANNELS; x++)
+        {
+            vAdcBlockGetStats(&xChannels[x].xPool, &xAcqStats);
+            xAcqTotals.ulDropped += xAcqStats.ulDropped;
+            xAcqTotals.ulOverwritten += xAcqStats.ulOverwritten;
+            xAcqTotals.ulDecimated += xAcqStats.ulDecimated;
+            xAcqTotals.ulLate += xAcqStats.ulLate;
+
+            xProcTotals.ulBatches += xChannels[x].xStats.ulBatches;
+            xProcTotals.ullTotalSamples += xChannels[x].xStats.ullTotalSamples;
+            if(xChannels[x].xStats.ulMaxBatch > xProcTotals.ulMaxBatch)
+            {
+                xProcTotals.ulMaxBatch = xChannels[x].xStats.ulMaxBatch;
+            }
+
+            xComplete += (xChannels[x].xComplete != pdFALSE);
+        }
+
+        console_print("Processing: %u/%u channels complete, %u batches, %u max, %.1f avg samples/batch\n",
+                      (unsigned) xComplete, (unsigned) NUM_CHANNELS, xProcTotals.ulBatches, xProcTotals.ulMaxBatch,
+                      xProcTotals.ulBatches ? (double) xProcTotals.ullTotalSamples / xProcTotals.ulBatches : 0.0);
+
+        console_print("Acquisition: %u dropped, %u overwritten, %u decimated, %u late samples\n",
+                      xAcqTotals.ulDropped, xAcqTotals.ulOverwritten, xAcqTotals.ulDecimated, xAcqTotals.ulLate);
     }
 }
@@ -28,21 +28,22 @@
  * Utility functions required to gather run time statistics.  See:
  * http://www.freertos.org/rtos-run-time-stats.html
  *
- * Note that this is a simulated port, where simulated time is a lot slower than
- * real time, therefore the run time counter values have no real meaningful
- * units.
+ * The counter is in microseconds of monotonic host time.  The kernel keeps it
+ * in 32 bits, so it wraps after about 71 minutes; the telemetry module
+ * accumulates the differences between samples in 64 bits to cope with that.
  *
- * Also note that it is assumed this demo is going to be used for short periods
- * of time only, and therefore timer overflows are not handled.
+ * On virtual time (portUSE_VIRTUAL_TIME) it counts the microseconds of the
+ * ticks instead, so it only advances while every task is blocked.
 */
 
 #include <time.h>
 
 /* FreeRTOS includes. */
 #include <FreeRTOS.h>
+#include <task.h>
 
-/* Time at start of day (in ns). */
-static unsigned long ulStartTimeNs;
+/* Time at start of day (in us). */
+static unsigned long long ullStartTimeUs;
 
 /*-----------------------------------------------------------*/
 
@@ -51,17 +52,21 @@ void vConfigureTimerForRunTimeStats( void )
 struct timespec xNow;
 
 	clock_gettime(CLOCK_MONOTONIC, &xNow);
-	ulStartTimeNs = xNow.tv_sec * 1000000000ul + xNow.tv_nsec;
+	ullStartTimeUs = xNow.tv_sec * 1000000ull + xNow.tv_nsec / 1000;
 }
 /*-----------------------------------------------------------*/
 
 unsigned long ulGetRunTimeCounterValue( void )
 {
+#if ( portUSE_VIRTUAL_TIME == 1 )
+	return ( unsigned long ) ( xTaskGetTickCount() * ( 1000000UL / configTICK_RATE_HZ ) );
+#else
 struct timespec xNow;
 
 	/* Time at start. */
 	clock_gettime(CLOCK_MONOTONIC, &xNow);
 
-	return xNow.tv_sec * 1000000000ul + xNow.tv_nsec - ulStartTimeNs;
+	return ( unsigned long ) ( xNow.tv_sec * 1000000ull + xNow.tv_nsec / 1000 - ullStartTimeUs );
+#endif
 }
 /*-----------------------------------------------------------*/
@@ -0,0 +1,155 @@
+/*
+ * Consistent snapshots of the processed values and bulk export helpers.  See
+ * snapshot.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* Microkernel includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "snapshot.h"
+
+void vSnapshotInit( Snapshot_t *pxSnapshot, float *pfValues, size_t xCapacity )
+{
+    pxSnapshot->pfValues = pfValues;
+    pxSnapshot->xCapacity = xCapacity;
+    pxSnapshot->ulSequence = 0;
+}
+
+void vSnapshotWriteBegin( Snapshot_t *pxSnapshot )
+{
+    pxSnapshot->ulSequence++;
+    portMEMORY_BARRIER();
+}
+
+void vSnapshotWriteEnd( Snapshot_t *pxSnapshot )
+{
+    portMEMORY_BARRIER();
+    pxSnapshot->ulSequence++;
+}
+
+void vSnapshotRead( Snapshot_t *pxSnapshot, float *pfOut )
+{
+    uint32_t ulSequence;
+
+    for( ;; )
+    {
+        ulSequence = pxSnapshot->ulSequence;
+        portMEMORY_BARRIER();
+
+        if( ( ulSequence & 1UL ) != 0 )
+        {
+            /* The writer was preempted in the middle of an update, let it
+            finish. */
+            taskYIELD();
+            continue;
+        }
+
+        memcpy( pfOut, pxSnapshot->pfValues, pxSnapshot->xCapacity * sizeof( float ) );
+        portMEMORY_BARRIER();
+
+        if( pxSnapshot->ulSequence == ulSequence )
+        {
+            break;
+        }
+    }
+}
+
+size_t xSnapshotFormatText( const float *pfValues, size_t xCount, size_t *pxNext, char *pcBuffer, size_t xBufferSize )
+{
+    static const char pcClose[] = "]\n\n";
+    size_t xUsed = 0;
+    size_t xValuesSize;
+    size_t x;
+    int iLen;
+
+    pcBuffer[ 0 ] = '\0';
+
+    if( *pxNext == 0 )
+    {
+        iLen = snprintf( pcBuffer, xBufferSize, "[ " );
+        xUsed = ( size_t ) iLen;
+    }
+
+    /* Room is kept for the closing bracket, so it always fits after the last
+    value. */
+    xValuesSize = xBufferSize - sizeof( pcClose ) + 1;
+
+    for( x = *pxNext; x < xCount; x++ )
+    {
+        iLen = snprintf( &pcBuffer[ xUsed ], xValuesSize - xUsed, "%.2f ", pfValues[ x ] );
+
+        if( ( iLen < 0 ) || ( ( size_t ) iLen >= xValuesSize - xUsed ) )
+        {
+            pcBuffer[ xUsed ] = '\0';
+            break;
+        }
+
+        xUsed += ( size_t ) iLen;
+    }
+
+    *pxNext = x;
+
+    if( x == xCount )
+    {
+        iLen = snprintf( &pcBuffer[ xUsed ], xBufferSize - xUsed, "%s", pcClose );
+        xUsed += ( size_t ) iLen;
+    }
+
+    return xUsed;
+}
+
+size_t xSnapshotFormatCsv( const float *pfValues, size_t xCount, size_t *pxNext, char *pcBuffer, size_t xBufferSize )
+{
+    size_t xUsed = 0;
+    size_t x;
+    int iLen;
+
+    pcBuffer[ 0 ] = '\0';
+
+    if( *pxNext == 0 )
+    {
+        iLen = snprintf( pcBuffer, xBufferSize, "index,value\n" );
+        xUsed = ( size_t ) iLen;
+    }
+
+    for( x = *pxNext; x < xCount; x++ )
+    {
+        iLen = snprintf( &pcBuffer[ xUsed ], xBufferSize - xUsed, "%u,%.4f\n", ( unsigned ) x, pfValues[ x ] );
+
+        if( ( iLen < 0 ) || ( ( size_t ) iLen >= xBufferSize - xUsed ) )
+        {
+            /* Only whole records are written, the rest goes in the next
+            call. */
+            pcBuffer[ xUsed ] = '\0';
+            break;
+        }
+
+        xUsed += ( size_t ) iLen;
+    }
+
+    *pxNext = x;
+
+    return xUsed;
+}
+
+BaseType_t xSnapshotSaveBinary( const float *pfValues, size_t xCount, const char *pcPath )
+{
+    FILE *pxFile;
+    size_t xWritten;
+
+    pxFile = fopen( pcPath, "wb" );
+
+    if( pxFile == NULL )
+    {
+        return pdFAIL;
+    }
+
+    xWritten = fwrite( pfValues, sizeof( float ), xCount, pxFile );
+    fclose( pxFile );
+
+    return ( xWritten == xCount ) ? pdPASS : pdFAIL;
+}
@@ -0,0 +1,397 @@
+/*
+ * Per-task CPU telemetry built on uxTaskGetSystemState().  See telemetry.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* Microkernel includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "telemetry.h"
+#include "text.h"
+
+/* Loads are kept in hundredths of a percent. */
+#define telemetryFULL_LOAD      10000U
+
+/* Longest CSV row or JSON task entry. */
+#define telemetryLINE_SIZE      ( 32 + ( telemetryMAX_TASKS * ( configMAX_TASK_NAME_LEN + 8 ) ) )
+
+static const char *prvStateName( eTaskState eState )
+{
+    switch( eState )
+    {
+        case eRunning:   return "running";
+        case eReady:     return "ready";
+        case eBlocked:   return "blocked";
+        case eSuspended: return "suspended";
+        case eDeleted:   return "deleted";
+        default:         return "invalid";
+    }
+}
+
+static TelemetryTask_t *prvFindSlot( Telemetry_t *pxTelemetry, UBaseType_t uxTaskNumber, BaseType_t xInUse )
+{
+    TelemetryTask_t *pxTask;
+    size_t x;
+
+    for( x = 0; x < telemetryMAX_TASKS; x++ )
+    {
+        pxTask = &( pxTelemetry->xTasks[ x ] );
+
+        if( ( pxTask->xInUse == xInUse ) &&
+            ( ( xInUse == pdFALSE ) || ( pxTask->uxTaskNumber == uxTaskNumber ) ) )
+        {
+            return pxTask;
+        }
+    }
+
+    return NULL;
+}
+
+void vTelemetryInit( Telemetry_t *pxTelemetry )
+{
+    memset( pxTelemetry, 0, sizeof( *pxTelemetry ) );
+    pxTelemetry->xMutex = xSemaphoreCreateMutexStatic( &( pxTelemetry->xMutexBuffer ) );
+    configASSERT( pxTelemetry->xMutex != NULL );
+}
+
+BaseType_t xTelemetrySample( Telemetry_t *pxTelemetry )
+{
+    TelemetrySample_t *pxSample;
+    TelemetryTask_t *pxTask;
+    TaskStatus_t *pxStatus;
+    UBaseType_t uxCount;
+    uint32_t ulTotal;
+    uint32_t ulInterval;
+    uint32_t ulLoad;
+    UBaseType_t uxUntracked = 0;
+    BaseType_t xSeen[ telemetryMAX_TASKS ];
+    UBaseType_t x;
+
+    /* Only the sampling task uses the status array, it is read outside of
+    the mutex as the kernel suspends the scheduler anyway. */
+    if( pxTelemetry->uxStatusSize < uxTaskGetNumberOfTasks() )
+    {
+        vPortFree( pxTelemetry->pxStatus );
+        pxTelemetry->uxStatusSize = uxTaskGetNumberOfTasks() + telemetrySTATUS_HEADROOM;
+        pxTelemetry->pxStatus = pvPortMalloc( pxTelemetry->uxStatusSize * sizeof( TaskStatus_t ) );
+
+        if( pxTelemetry->pxStatus == NULL )
+        {
+            pxTelemetry->uxStatusSize = 0;
+            return pdFAIL;
+        }
+    }
+
+    uxCount = uxTaskGetSystemState( pxTelemetry->pxStatus, pxTelemetry->uxStatusSize, &ulTotal );
+
+    if( uxCount == 0 )
+    {
+        /* More tasks were created than the headroom allows for, the array
+        grows on the next sample. */
+        pxTelemetry->uxStatusSize = 0;
+        return pdFAIL;
+    }
+
+    xSemaphoreTake( pxTelemetry->xMutex, portMAX_DELAY );
+
+    ulInterval = ulTotal - pxTelemetry->ulLastTotal;
+    pxTelemetry->ulLastTotal = ulTotal;
+    memset( xSeen, 0, sizeof( xSeen ) );
+
+    /* Match the tasks that were already known, then free the slots of
+    deleted tasks before giving slots to new ones. */
+    for( x = 0; x < uxCount; x++ )
+    {
+        pxTask = prvFindSlot( pxTelemetry, pxTelemetry->pxStatus[ x ].xTaskNumber, pdTRUE );
+
+        if( pxTask != NULL )
+        {
+            xSeen[ pxTask - pxTelemetry->xTasks ] = pdTRUE;
+        }
+    }
+
+    for( x = 0; x < telemetryMAX_TASKS; x++ )
+    {
+        if( xSeen[ x ] == pdFALSE )
+        {
+            pxTelemetry->xTasks[ x ].xInUse = pdFALSE;
+            pxTelemetry->xTasks[ x ].ulLastDelta = 0;
+        }
+    }
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        pxStatus = &( pxTelemetry->pxStatus[ x ] );
+        pxTask = prvFindSlot( pxTelemetry, pxStatus->xTaskNumber, pdTRUE );
+
+        if( pxTask == NULL )
+        {
+            /* New task, it has run since it was created. */
+            pxTask = prvFindSlot( pxTelemetry, 0, pdFALSE );
+
+            if( pxTask == NULL )
+            {
+                uxUntracked++;
+                continue;
+            }
+
+            pxTask->xInUse = pdTRUE;
+            pxTask->uxTaskNumber = pxStatus->xTaskNumber;
+            pxTask->ulLastCounter = 0;
+            pxTask->ullRunTime = 0;
+            strncpy( pxTask->pcName, pxStatus->pcTaskName, configMAX_TASK_NAME_LEN - 1 );
+            pxTask->pcName[ configMAX_TASK_NAME_LEN - 1 ] = '\0';
+        }
+
+        pxTask->ulLastDelta = pxStatus->ulRunTimeCounter - pxTask->ulLastCounter;
+        pxTask->ulLastCounter = pxStatus->ulRunTimeCounter;
+        pxTask->ullRunTime += pxTask->ulLastDelta;
+        pxTask->uxPriority = pxStatus->uxCurrentPriority;
+        pxTask->eState = pxStatus->eCurrentState;
+        pxTask->usStackHighWaterMark = pxStatus->usStackHighWaterMark;
+    }
+
+    pxTelemetry->uxUntracked = uxUntracked;
+
+    if( pxTelemetry->xPrimed == pdFALSE )
+    {
+        /* Nothing to compare against yet. */
+        pxTelemetry->xPrimed = pdTRUE;
+        pxTelemetry->ullTotalRunTime = ulTotal;
+        xSemaphoreGive( pxTelemetry->xMutex );
+        return pdPASS;
+    }
+
+    pxTelemetry->ullTotalRunTime += ulInterval;
+
+    pxSample = &( pxTelemetry->xHistory[ pxTelemetry->xHistoryHead ] );
+    pxSample->ulSequence = pxTelemetry->ulSequence++;
+    pxSample->xTimestamp = xTaskGetTickCount();
+    pxSample->ulInterval = ulInterval;
+
+    for( x = 0; x < telemetryMAX_TASKS; x++ )
+    {
+        ulLoad = 0;
+
+        if( ( ulInterval != 0 ) && ( pxTelemetry->xTasks[ x ].xInUse != pdFALSE ) )
+        {
+            ulLoad = ( uint32_t ) ( ( ( uint64_t ) pxTelemetry->xTasks[ x ].ulLastDelta * telemetryFULL_LOAD ) / ulInterval );
+
+            /* The counters are read one after the other, so a task can
+            appear to run slightly longer than the interval. */
+            if( ulLoad > telemetryFULL_LOAD )
+            {
+                ulLoad = telemetryFULL_LOAD;
+            }
+        }
+
+        pxSample->usLoad[ x ] = ( uint16_t ) ulLoad;
+    }
+
+    pxTelemetry->xHistoryHead = ( pxTelemetry->xHistoryHead + 1 ) % telemetryHISTORY_DEPTH;
+
+    if( pxTelemetry->xHistoryCount < telemetryHISTORY_DEPTH )
+    {
+        pxTelemetry->xHistoryCount++;
+    }
+
+    xSemaphoreGive( pxTelemetry->xMutex );
+
+    return pdPASS;
+}
+
+static const TelemetrySample_t *prvLastSample( const Telemetry_t *pxTelemetry )
+{
+    if( pxTelemetry->xHistoryCount == 0 )
+    {
+        return NULL;
+    }
+
+    return &( pxTelemetry->xHistory[ ( pxTelemetry->xHistoryHead + telemetryHISTORY_DEPTH - 1 ) % telemetryHISTORY_DEPTH ] );
+}
+
+size_t xTelemetryFormatText( Telemetry_t *pxTelemetry, char *pcBuffer, size_t xBufferSize )
+{
+    const TelemetrySample_t *pxSample;
+    const TelemetryTask_t *pxTask;
+    size_t xUsed = 0;
+    size_t x;
+
+    if( xBufferSize == 0 )
+    {
+        return 0;
+    }
+
+    pcBuffer[ 0 ] = '\0';
+    xSemaphoreTake( pxTelemetry->xMutex, portMAX_DELAY );
+    pxSample = prvLastSample( pxTelemetry );
+
+    if( pxSample != NULL )
+    {
+        ( void ) xTextAppend( pcBuffer, xBufferSize, &xUsed, "%-*s %4s %9s %6s %7s %12s\n",
+                              configMAX_TASK_NAME_LEN, "Task", "Prio", "State", "Stack", "CPU%", "Run time" );
+
+        for( x = 0; x < telemetryMAX_TASKS; x++ )
+        {
+            pxTask = &( pxTelemetry->xTasks[ x ] );
+
+            if( pxTask->xInUse == pdFALSE )
+            {
+                continue;
+            }
+
+            if( xTextAppend( pcBuffer, xBufferSize, &xUsed, "%-*s %4u %9s %6u %3u.%02u%% %12llu\n",
+                             configMAX_TASK_NAME_LEN, pxTask->pcName, ( unsigned ) pxTask->uxPriority,
+                             prvStateName( pxTask->eState ), ( unsigned ) pxTask->usStackHighWaterMark,
+                             pxSample->usLoad[ x ] / 100U, pxSample->usLoad[ x ] % 100U,
+                             ( unsigned long long ) pxTask->ullRunTime ) == pdFAIL )
+            {
+                break;
+            }
+        }
+
+        if( ( x == telemetryMAX_TASKS ) && ( pxTelemetry->uxUntracked != 0 ) )
+        {
+            ( void ) xTextAppend( pcBuffer, xBufferSize, &xUsed, "%u more tasks not tracked, telemetryMAX_TASKS is %u\n",
+                                  ( unsigned ) pxTelemetry->uxUntracked, ( unsigned ) telemetryMAX_TASKS );
+        }
+    }
+
+    xSemaphoreGive( pxTelemetry->xMutex );
+
+    return xUsed;
+}
+
+size_t xTelemetryFormatCsv( Telemetry_t *pxTelemetry, char *pcBuffer, size_t xBufferSize )
+{
+    const TelemetrySample_t *pxSample;
+    char cLine[ telemetryLINE_SIZE ];
+    size_t xLineUsed;
+    size_t xUsed = 0;
+    size_t xIndex;
+    size_t x;
+    size_t y;
+
+    if( xBufferSize == 0 )
+    {
+        return 0;
+    }
+
+    pcBuffer[ 0 ] = '\0';
+    xSemaphoreTake( pxTelemetry->xMutex, portMAX_DELAY );
+
+    /* Header, one column per slot named after its current task. */
+    xLineUsed = 0;
+    ( void ) xTextAppend( cLine, sizeof( cLine ), &xLineUsed, "sample,tick_ms,interval" );
+
+    for( x = 0; x < telemetryMAX_TASKS; x++ )
+    {
+        if( pxTelemetry->xTasks[ x ].xInUse != pdFALSE )
+        {
+            ( void ) xTextAppend( cLine, sizeof( cLine ), &xLineUsed, ",%s", pxTelemetry->xTasks[ x ].pcName );
+        }
+    }
+
+    if( xTextAppend( pcBuffer, xBufferSize, &xUsed, "%s\n", cLine ) == pdPASS )
+    {
+        xIndex = ( pxTelemetry->xHistoryHead + telemetryHISTORY_DEPTH - pxTelemetry->xHistoryCount ) % telemetryHISTORY_DEPTH;
+
+        for( y = 0; y < pxTelemetry->xHistoryCount; y++ )
+        {
+            pxSample = &( pxTelemetry->xHistory[ xIndex ] );
+            xIndex = ( xIndex + 1 ) % telemetryHISTORY_DEPTH;
+
+            xLineUsed = 0;
+            ( void ) xTextAppend( cLine, sizeof( cLine ), &xLineUsed, "%u,%u,%u",
+                                  ( unsigned ) pxSample->ulSequence,
+                                  ( unsigned ) ( ( ( uint64_t ) pxSample->xTimestamp * 1000U ) / configTICK_RATE_HZ ),
+                                  ( unsigned ) pxSample->ulInterval );
+
+            for( x = 0; x < telemetryMAX_TASKS; x++ )
+            {
+                if( pxTelemetry->xTasks[ x ].xInUse != pdFALSE )
+                {
+                    ( void ) xTextAppend( cLine, sizeof( cLine ), &xLineUsed, ",%u.%02u",
+                                          pxSample->usLoad[ x ] / 100U, pxSample->usLoad[ x ] % 100U );
+                }
+            }
+
+            if( xTextAppend( pcBuffer, xBufferSize, &xUsed, "%s\n", cLine ) == pdFAIL )
+            {
+                break;
+            }
+        }
+    }
+
+    xSemaphoreGive( pxTelemetry->xMutex );
+
+    return xUsed;
+}
+
+size_t xTelemetryFormatJson( Telemetry_t *pxTelemetry, char *pcBuffer, size_t xBufferSize )
+{
+    const TelemetrySample_t *pxSample;
+    const TelemetryTask_t *pxTask;
+    size_t xUsed = 0;
+    size_t xClose;
+    size_t x;
+    BaseType_t xFirst = pdTRUE;
+
+    /* Room is kept for the closing brackets so the output is always valid. */
+    if( xBufferSize < 4 )
+    {
+        return 0;
+    }
+
+    xClose = xBufferSize - 3;
+    pcBuffer[ 0 ] = '\0';
+    xSemaphoreTake( pxTelemetry->xMutex, portMAX_DELAY );
+    pxSample = prvLastSample( pxTelemetry );
+
+    if( pxSample == NULL )
+    {
+        ( void ) xTextAppend( pcBuffer, xBufferSize, &xUsed, "{}\n" );
+    }
+    else if( xTextAppend( pcBuffer, xClose, &xUsed,
+                          "{\"sample\":%u,\"tick_ms\":%u,\"interval\":%u,\"total_run_time\":%llu,\"untracked\":%u,\"tasks\":[",
+                          ( unsigned ) pxSample->ulSequence,
+                          ( unsigned ) ( ( ( uint64_t ) pxSample->xTimestamp * 1000U ) / configTICK_RATE_HZ ),
+                          ( unsigned ) pxSample->ulInterval,
+                          ( unsigned long long ) pxTelemetry->ullTotalRunTime,
+                          ( unsigned ) pxTelemetry->uxUntracked ) == pdPASS )
+    {
+        for( x = 0; x < telemetryMAX_TASKS; x++ )
+        {
+            pxTask = &( pxTelemetry->xTasks[ x ] );
+
+            if( pxTask->xInUse == pdFALSE )
+            {
+                continue;
+            }
+
+            if( xTextAppend( pcBuffer, xClose, &xUsed,
+                             "%s{\"name\":\"%s\",\"number\":%u,\"priority\":%u,\"state\":\"%s\","
+                             "\"stack_hwm\":%u,\"cpu\":%u.%02u,\"run_time\":%llu}",
+                             ( xFirst == pdTRUE ) ? "" : ",", pxTask->pcName,
+                             ( unsigned ) pxTask->uxTaskNumber, ( unsigned ) pxTask->uxPriority,
+                             prvStateName( pxTask->eState ), ( unsigned ) pxTask->usStackHighWaterMark,
+                             pxSample->usLoad[ x ] / 100U, pxSample->usLoad[ x ] % 100U,
+                             ( unsigned long long ) pxTask->ullRunTime ) == pdFAIL )
+            {
+                break;
+            }
+
+            xFirst = pdFALSE;
+        }
+
+        ( void ) xTextAppend( pcBuffer, xBufferSize, &xUsed, "]}\n" );
+    }
+
+    xSemaphoreGive( pxTelemetry->xMutex );
+
+    return xUsed;
+}
@@ -0,0 +1,36 @@
+/*
+ * Bounded text output.  See text.h.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+
+/* Microkernel includes */
+#include "FreeRTOS.h"
+
+#include "text.h"
+
+BaseType_t xTextAppend( char *pcBuffer, size_t xBufferSize, size_t *pxUsed, const char *pcFormat, ... )
+{
+    va_list xArgs;
+    int iLen;
+
+    if( *pxUsed >= xBufferSize )
+    {
+        return pdFAIL;
+    }
+
+    va_start( xArgs, pcFormat );
+    iLen = vsnprintf( &pcBuffer[ *pxUsed ], xBufferSize - *pxUsed, pcFormat, xArgs );
+    va_end( xArgs );
+
+    if( ( iLen < 0 ) || ( ( size_t ) iLen >= xBufferSize - *pxUsed ) )
+    {
+        pcBuffer[ *pxUsed ] = '\0';
+        return pdFAIL;
+    }
+
+    *pxUsed += ( size_t ) iLen;
+
+    return pdPASS;
+}
@@ -660,6 +660,9 @@ static void * prvLinuxPcapRecvThread( void * pvParam )
     sigfillset( &set );
     pthread_sigmask( SIG_SETMASK, &set, NULL );
 
+    /* Host scheduling and CPUs of the I/O threads of the simulator. */
+    vPortSetHostThreadPolicy( ePortThreadIO, 0 );
+
     for( ; ; )
     {
         ret = pcap_dispatch( pxOpenedInterfaceHandle, 1,
@@ -697,6 +700,8 @@ static void * prvLinuxPcapSendThread( void * pvParam )
     sigfillset( &set );
     pthread_sigmask( SIG_SETMASK, &set, NULL );
 
+    vPortSetHostThreadPolicy( ePortThreadIO, 0 );
+
     for( ; ; )
     {
         /* Wait until notified of something to send. */
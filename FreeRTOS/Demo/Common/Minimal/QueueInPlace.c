@@ -0,0 +1,490 @@
+/*
+ * FreeRTOS V202104.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * Tests the functions that access the storage of a queue in place:
+ * xQueueReserveSend(), xQueueCommitSend() and xQueueAbortSend() on the sending
+ * side, xQueuePeekAcquire(), xQueueReleaseReceive() and xQueueAbortReceive()
+ * on the receiving side.
+ *
+ * The controller task checks, on a queue of its own, what the functions do when
+ * the queue is empty, when it is full, and when a slot is already reserved or
+ * an item already acquired.
+ *
+ * qipNUM_PRODUCERS producer tasks share a second queue.  Each writes numbered
+ * items in place, and gives back some of the slots it reserved with
+ * xQueueAbortSend() after scribbling over them.  The consumer task reads the
+ * items in place or by copy, gives some back with xQueueAbortReceive() before
+ * acquiring them again, and checks that it gets the items of each producer in
+ * sequence, and nothing of the aborted slots.
+ */
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Demo program include files. */
+#include "QueueInPlace.h"
+
+/* Exclude the entire file if configUSE_QUEUE_IN_PLACE is 0. */
+#if( configUSE_QUEUE_IN_PLACE == 1 )
+
+/* The number of tasks sending to the shared queue. */
+#define qipNUM_PRODUCERS			( 3 )
+
+/* The lengths of the shared queue and of the queue of the controller task. */
+#define qipSHARED_QUEUE_LENGTH		( 4 )
+#define qipCONTROL_QUEUE_LENGTH		( 3 )
+
+/* Bytes of each item that are checked by the receiver. */
+#define qipPAYLOAD_BYTES			( 24 )
+
+/* One reservation in qipABORT_SEND_RATE is aborted by the producers, one
+acquired item in qipABORT_RECEIVE_RATE is given back by the consumer, and one
+item in qipCOPY_RECEIVE_RATE is received by copy instead of in place. */
+#define qipABORT_SEND_RATE			( 7UL )
+#define qipABORT_RECEIVE_RATE		( 5UL )
+#define qipCOPY_RECEIVE_RATE		( 3UL )
+
+/* Block times.  The shared queue is never left full or empty for long, so a
+task that times out on it only skips a loop, and is then reported by
+xAreQueueInPlaceTasksStillRunning() if the queue stays stuck. */
+#define qipDONT_BLOCK				( ( TickType_t ) 0 )
+#define qipSHORT_DELAY				( ( TickType_t ) 2 )
+#define qipSHARED_BLOCK_TIME		pdMS_TO_TICKS( 500UL )
+#define qipCONTROLLER_DELAY			pdMS_TO_TICKS( 50UL )
+
+/* The items sent through both queues. */
+typedef struct QIP_ITEM
+{
+	uint32_t ulProducer;
+	uint32_t ulSequence;
+	uint8_t ucPayload[ qipPAYLOAD_BYTES ];
+} QipItem_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The single task tests, run by the controller task on its own queue.
+ */
+static void prvControllerTask( void *pvParameters );
+
+/*
+ * The tasks that send to and receive from the shared queue.
+ */
+static void prvProducerTask( void *pvParameters );
+static void prvConsumerTask( void *pvParameters );
+
+/*
+ * Write an item, and check an item is the one expected.
+ */
+static void prvFillItem( QipItem_t *pxItem, uint32_t ulProducer, uint32_t ulSequence );
+static BaseType_t prvIsExpectedItem( const QipItem_t *pxItem, uint32_t ulProducer, uint32_t ulSequence );
+
+/*
+ * Latch an error if xCondition is pdFALSE.
+ */
+static void prvCheck( BaseType_t xCondition );
+
+/*-----------------------------------------------------------*/
+
+/* The queue used by the controller task, and the queue shared by the producer
+and consumer tasks. */
+static QueueHandle_t xControlQueue = NULL;
+static QueueHandle_t xSharedQueue = NULL;
+
+/* Incremented by each task on each loop.  xAreQueueInPlaceTasksStillRunning()
+checks they are all still incrementing. */
+static volatile uint32_t ulControllerCycles = 0UL;
+static volatile uint32_t ulProducerCycles[ qipNUM_PRODUCERS ] = { 0UL };
+static volatile uint32_t ulConsumerCycles = 0UL;
+
+/* Set to pdTRUE if any task finds an error. */
+static volatile BaseType_t xErrorDetected = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartQueueInPlaceTasks( UBaseType_t uxPriority )
+{
+UBaseType_t uxProducer;
+
+	xControlQueue = xQueueCreate( qipCONTROL_QUEUE_LENGTH, sizeof( QipItem_t ) );
+	xSharedQueue = xQueueCreate( qipSHARED_QUEUE_LENGTH, sizeof( QipItem_t ) );
+
+	if( ( xControlQueue != NULL ) && ( xSharedQueue != NULL ) )
+	{
+		/* The queue registry is provided as a means for kernel aware
+		debuggers to locate queues and has no purpose if a kernel aware
+		debugger is not being used. */
+		vQueueAddToRegistry( xControlQueue, "QIP_Control" );
+		vQueueAddToRegistry( xSharedQueue, "QIP_Shared" );
+
+		xTaskCreate( prvControllerTask, "QIPCtrl", configMINIMAL_STACK_SIZE, NULL, uxPriority, NULL );
+		xTaskCreate( prvConsumerTask, "QIPRx", configMINIMAL_STACK_SIZE, NULL, uxPriority, NULL );
+
+		for( uxProducer = 0; uxProducer < qipNUM_PRODUCERS; uxProducer++ )
+		{
+			xTaskCreate( prvProducerTask, "QIPTx", configMINIMAL_STACK_SIZE, ( void * ) uxProducer, uxPriority, NULL );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvControllerTask( void *pvParameters )
+{
+QipItem_t *pxItem, *pxOther, xCopy;
+uint32_t ulSequence = 0UL, ulFirst, ulItem;
+TickType_t xTimeBefore;
+
+	/* Just to remove compiler warnings. */
+	( void ) pvParameters;
+
+	/* A single task is the only one to use xControlQueue. */
+	for( ;; )
+	{
+		ulFirst = ulSequence;
+
+		/* Nothing can be acquired from the empty queue, and there is nothing
+		to commit, release or abort yet. */
+		prvCheck( xQueuePeekAcquire( xControlQueue, ( void ** ) &pxItem, qipDONT_BLOCK ) == errQUEUE_EMPTY );
+		prvCheck( xQueueReleaseReceive( xControlQueue ) == pdFAIL );
+		prvCheck( xQueueAbortReceive( xControlQueue ) == pdFAIL );
+		prvCheck( xQueueCommitSend( xControlQueue ) == pdFAIL );
+		prvCheck( xQueueAbortSend( xControlQueue ) == pdFAIL );
+
+		xTimeBefore = xTaskGetTickCount();
+		prvCheck( xQueuePeekAcquire( xControlQueue, ( void ** ) &pxItem, qipSHORT_DELAY ) == errQUEUE_EMPTY );
+		prvCheck( ( xTaskGetTickCount() - xTimeBefore ) >= qipSHORT_DELAY );
+
+		/* A reserved slot is not visible to receivers, and no other item can
+		be sent until it is committed or aborted, even though there is room. */
+		prvCheck( xQueueReserveSend( xControlQueue, ( void ** ) &pxItem, qipDONT_BLOCK ) == pdPASS );
+		prvFillItem( pxItem, 0UL, ~ulSequence );
+		prvCheck( xQueueReserveSend( xControlQueue, ( void ** ) &pxOther, qipDONT_BLOCK ) == errQUEUE_FULL );
+		prvFillItem( &xCopy, 0UL, ulSequence );
+		prvCheck( xQueueSend( xControlQueue, &xCopy, qipDONT_BLOCK ) == errQUEUE_FULL );
+		prvCheck( xQueuePeekAcquire( xControlQueue, ( void ** ) &pxOther, qipDONT_BLOCK ) == errQUEUE_EMPTY );
+		prvCheck( uxQueueMessagesWaiting( xControlQueue ) == 0 );
+
+		/* Aborting the reservation posts nothing, and the slot can be sent
+		to again. */
+		prvCheck( xQueueAbortSend( xControlQueue ) == pdPASS );
+		prvCheck( xQueueAbortSend( xControlQueue ) == pdFAIL );
+		prvCheck( xQueueCommitSend( xControlQueue ) == pdFAIL );
+		prvCheck( uxQueueMessagesWaiting( xControlQueue ) == 0 );
+		prvCheck( xQueueSend( xControlQueue, &xCopy, qipDONT_BLOCK ) == pdPASS );
+		ulSequence++;
+
+		/* Fill the queue in place. */
+		while( uxQueueSpacesAvailable( xControlQueue ) > 0 )
+		{
+			prvCheck( xQueueReserveSend( xControlQueue, ( void ** ) &pxItem, qipDONT_BLOCK ) == pdPASS );
+			prvFillItem( pxItem, 0UL, ulSequence );
+			prvCheck( xQueueCommitSend( xControlQueue ) == pdPASS );
+			ulSequence++;
+		}
+
+		/* Nothing can be reserved in the full queue. */
+		prvCheck( xQueueReserveSend( xControlQueue, ( void ** ) &pxItem, qipDONT_BLOCK ) == errQUEUE_FULL );
+		xTimeBefore = xTaskGetTickCount();
+		prvCheck( xQueueReserveSend( xControlQueue, ( void ** ) &pxItem, qipSHORT_DELAY ) == errQUEUE_FULL );
+		prvCheck( ( xTaskGetTickCount() - xTimeBefore ) >= qipSHORT_DELAY );
+		prvCheck( xQueueCommitSend( xControlQueue ) == pdFAIL );
+
+		/* An item given back stays at the head of the queue, and is the one
+		acquired next.  No other item can be received while it is acquired. */
+		if( xQueuePeekAcquire( xControlQueue, ( void ** ) &pxItem, qipDONT_BLOCK ) == pdPASS )
+		{
+			prvCheck( prvIsExpectedItem( pxItem, 0UL, ulFirst ) );
+			prvCheck( xQueuePeekAcquire( xControlQueue, ( void ** ) &pxOther, qipDONT_BLOCK ) == errQUEUE_EMPTY );
+			prvCheck( xQueueReceive( xControlQueue, &xCopy, qipDONT_BLOCK ) == errQUEUE_EMPTY );
+			prvCheck( xQueueAbortReceive( xControlQueue ) == pdPASS );
+			prvCheck( xQueueAbortReceive( xControlQueue ) == pdFAIL );
+			prvCheck( xQueueReleaseReceive( xControlQueue ) == pdFAIL );
+			prvCheck( uxQueueMessagesWaiting( xControlQueue ) == qipCONTROL_QUEUE_LENGTH );
+		}
+		else
+		{
+			prvCheck( pdFALSE );
+		}
+
+		if( xQueuePeekAcquire( xControlQueue, ( void ** ) &pxOther, qipDONT_BLOCK ) == pdPASS )
+		{
+			prvCheck( pxOther == pxItem );
+			prvCheck( prvIsExpectedItem( pxOther, 0UL, ulFirst ) );
+			prvCheck( xQueueReleaseReceive( xControlQueue ) == pdPASS );
+			prvCheck( uxQueueMessagesWaiting( xControlQueue ) == ( qipCONTROL_QUEUE_LENGTH - 1 ) );
+		}
+		else
+		{
+			prvCheck( pdFALSE );
+		}
+
+		/* The slot freed by the release can be reserved and committed. */
+		prvCheck( xQueueReserveSend( xControlQueue, ( void ** ) &pxItem, qipDONT_BLOCK ) == pdPASS );
+		prvFillItem( pxItem, 0UL, ulSequence );
+		prvCheck( xQueueCommitSend( xControlQueue ) == pdPASS );
+		ulSequence++;
+
+		/* Empty the queue, alternately in place and by copy, checking the
+		items come out in the order they were sent. */
+		for( ulItem = ulFirst + 1UL; ulItem != ulSequence; ulItem++ )
+		{
+			if( ( ulItem & 1UL ) == 0UL )
+			{
+				if( xQueuePeekAcquire( xControlQueue, ( void ** ) &pxItem, qipDONT_BLOCK ) == pdPASS )
+				{
+					prvCheck( prvIsExpectedItem( pxItem, 0UL, ulItem ) );
+					prvCheck( xQueueReleaseReceive( xControlQueue ) == pdPASS );
+				}
+				else
+				{
+					prvCheck( pdFALSE );
+				}
+			}
+			else
+			{
+				if( xQueueReceive( xControlQueue, &xCopy, qipDONT_BLOCK ) == pdPASS )
+				{
+					prvCheck( prvIsExpectedItem( &xCopy, 0UL, ulItem ) );
+				}
+				else
+				{
+					prvCheck( pdFALSE );
+				}
+			}
+		}
+
+		prvCheck( uxQueueMessagesWaiting( xControlQueue ) == 0 );
+
+		/* Leave a clean queue for the next cycle, whatever went wrong. */
+		( void ) xQueueReset( xControlQueue );
+
+		ulControllerCycles++;
+		vTaskDelay( qipCONTROLLER_DELAY );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void *pvParameters )
+{
+const uint32_t ulProducer = ( uint32_t ) ( UBaseType_t ) pvParameters;
+uint32_t ulSequence = 0UL, ulReservations = 0UL;
+QipItem_t *pxItem;
+
+	for( ;; )
+	{
+		/* Other producers and the consumer share the queue, so this blocks
+		while it is full or another producer has reserved its free slot. */
+		if( xQueueReserveSend( xSharedQueue, ( void ** ) &pxItem, qipSHARED_BLOCK_TIME ) == pdPASS )
+		{
+			ulReservations++;
+
+			if( ( ulReservations % qipABORT_SEND_RATE ) == 0UL )
+			{
+				/* The consumer would notice this item if it was posted. */
+				prvFillItem( pxItem, ulProducer, ~ulSequence );
+				prvCheck( xQueueAbortSend( xSharedQueue ) == pdPASS );
+			}
+			else
+			{
+				prvFillItem( pxItem, ulProducer, ulSequence );
+				prvCheck( xQueueCommitSend( xSharedQueue ) == pdPASS );
+				ulSequence++;
+			}
+
+			ulProducerCycles[ ulProducer ]++;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvConsumerTask( void *pvParameters )
+{
+uint32_t ulExpected[ qipNUM_PRODUCERS ] = { 0UL };
+uint32_t ulReceived = 0UL;
+QipItem_t *pxItem, *pxFirst, xCopy;
+BaseType_t xAcquired;
+
+	/* Just to remove compiler warnings. */
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		ulReceived++;
+
+		if( ( ulReceived % qipCOPY_RECEIVE_RATE ) == 0UL )
+		{
+			xAcquired = pdFALSE;
+
+			if( xQueueReceive( xSharedQueue, &xCopy, qipSHARED_BLOCK_TIME ) == pdPASS )
+			{
+				pxItem = &xCopy;
+			}
+			else
+			{
+				continue;
+			}
+		}
+		else
+		{
+			if( xQueuePeekAcquire( xSharedQueue, ( void ** ) &pxItem, qipSHARED_BLOCK_TIME ) == pdPASS )
+			{
+				xAcquired = pdTRUE;
+			}
+			else
+			{
+				continue;
+			}
+
+			if( ( ulReceived % qipABORT_RECEIVE_RATE ) == 0UL )
+			{
+				/* This is the only task receiving from the queue, so the item
+				given back is still at its head when acquired again, whatever
+				the producers sent in between. */
+				pxFirst = pxItem;
+				prvCheck( xQueueAbortReceive( xSharedQueue ) == pdPASS );
+
+				if( xQueuePeekAcquire( xSharedQueue, ( void ** ) &pxItem, qipDONT_BLOCK ) == pdPASS )
+				{
+					prvCheck( pxItem == pxFirst );
+				}
+				else
+				{
+					prvCheck( pdFALSE );
+					continue;
+				}
+			}
+		}
+
+		/* Each producer numbers the items it commits from 0. */
+		if( pxItem->ulProducer < qipNUM_PRODUCERS )
+		{
+			prvCheck( prvIsExpectedItem( pxItem, pxItem->ulProducer, ulExpected[ pxItem->ulProducer ] ) );
+			ulExpected[ pxItem->ulProducer ] = pxItem->ulSequence + 1UL;
+		}
+		else
+		{
+			prvCheck( pdFALSE );
+		}
+
+		if( xAcquired != pdFALSE )
+		{
+			prvCheck( xQueueReleaseReceive( xSharedQueue ) == pdPASS );
+		}
+
+		ulConsumerCycles++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvFillItem( QipItem_t *pxItem, uint32_t ulProducer, uint32_t ulSequence )
+{
+size_t x;
+
+	pxItem->ulProducer = ulProducer;
+	pxItem->ulSequence = ulSequence;
+
+	for( x = 0; x < qipPAYLOAD_BYTES; x++ )
+	{
+		pxItem->ucPayload[ x ] = ( uint8_t ) ( ulSequence + ( uint32_t ) x );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsExpectedItem( const QipItem_t *pxItem, uint32_t ulProducer, uint32_t ulSequence )
+{
+BaseType_t xReturn = pdTRUE;
+size_t x;
+
+	if( ( pxItem->ulProducer != ulProducer ) || ( pxItem->ulSequence != ulSequence ) )
+	{
+		xReturn = pdFALSE;
+	}
+
+	for( x = 0; x < qipPAYLOAD_BYTES; x++ )
+	{
+		if( pxItem->ucPayload[ x ] != ( uint8_t ) ( ulSequence + ( uint32_t ) x ) )
+		{
+			xReturn = pdFALSE;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheck( BaseType_t xCondition )
+{
+	if( xCondition == pdFALSE )
+	{
+		xErrorDetected = pdTRUE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAreQueueInPlaceTasksStillRunning( void )
+{
+static uint32_t ulLastControllerCycles = 0UL, ulLastConsumerCycles = 0UL;
+static uint32_t ulLastProducerCycles[ qipNUM_PRODUCERS ] = { 0UL };
+BaseType_t xReturn = pdPASS, x;
+
+	if( ulLastControllerCycles == ulControllerCycles )
+	{
+		xReturn = pdFAIL;
+	}
+
+	ulLastControllerCycles = ulControllerCycles;
+
+	if( ulLastConsumerCycles == ulConsumerCycles )
+	{
+		xReturn = pdFAIL;
+	}
+
+	ulLastConsumerCycles = ulConsumerCycles;
+
+	for( x = 0; x < qipNUM_PRODUCERS; x++ )
+	{
+		if( ulLastProducerCycles[ x ] == ulProducerCycles[ x ] )
+		{
+			xReturn = pdFAIL;
+		}
+
+		ulLastProducerCycles[ x ] = ulProducerCycles[ x ];
+	}
+
+	if( xErrorDetected != pdFALSE )
+	{
+		xReturn = pdFAIL;
+	}
+
+	return xReturn;
+}
+
+/* Exclude the entire file if configUSE_QUEUE_IN_PLACE is 0. */
+#endif /* configUSE_QUEUE_IN_PLACE == 1 */
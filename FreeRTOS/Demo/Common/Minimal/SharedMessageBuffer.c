@@ -0,0 +1,411 @@
+/*
+ * FreeRTOS V202104.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * Tests message buffers created with xMessageBufferCreateShared(), which any
+ * number of tasks can send to and receive from.
+ *
+ * The controller task checks, on a shared message buffer of its own, what
+ * xMessageBufferSend() and xMessageBufferReceive() do when the buffer is empty,
+ * when it is full, when a message can never fit, and when the buffer a reader
+ * offers is too small for the next message.
+ *
+ * smbNUM_WRITERS writer tasks and smbNUM_READERS reader tasks share a second
+ * message buffer, which is kept small so the writers often wait for space.
+ * Each writer sends numbered messages of varying lengths.  Each reader checks
+ * the length and contents of every message, and that the messages of each
+ * writer reach it in the order they were sent.  One reader sometimes offers a
+ * buffer that is too small, and checks it gets 0 back without blocking.
+ */
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "message_buffer.h"
+
+/* Demo program include files. */
+#include "SharedMessageBuffer.h"
+
+/* Exclude the entire file if configUSE_SHARED_MESSAGE_BUFFERS is 0. */
+#if( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+
+/* The number of tasks sending to and receiving from the shared buffer. */
+#define smbNUM_WRITERS				( 3 )
+#define smbNUM_READERS				( 2 )
+
+/* The sizes of the shared buffer and of the buffer of the controller task. */
+#define smbSHARED_BUFFER_LENGTH		( ( size_t ) 120 )
+#define smbCONTROL_BUFFER_LENGTH	( ( size_t ) 100 )
+
+/* The most payload bytes a message carries, and the fixed number the
+controller task sends. */
+#define smbMAX_PAYLOAD_BYTES		( 24 )
+#define smbCONTROL_PAYLOAD_BYTES	( 8 )
+
+/* The space a message takes in a message buffer. */
+#define smbSPACE_FOR( xBytes )		( ( xBytes ) + sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) )
+
+/* One receive in smbTOO_SMALL_RATE of the first reader offers a buffer that
+cannot hold any message. */
+#define smbTOO_SMALL_RATE			( 11UL )
+#define smbTOO_SMALL_BYTES			( ( size_t ) 4 )
+
+/* Block times.  The shared buffer is never left full or empty for long, so a
+task that times out on it only skips a loop, and is then reported by
+xAreSharedMessageBufferTasksStillRunning() if the buffer stays stuck. */
+#define smbDONT_BLOCK				( ( TickType_t ) 0 )
+#define smbSHORT_DELAY				( ( TickType_t ) 2 )
+#define smbSHARED_BLOCK_TIME		pdMS_TO_TICKS( 500UL )
+#define smbCONTROLLER_DELAY			pdMS_TO_TICKS( 50UL )
+
+/* The messages sent through both buffers.  Only the first bytes of the payload
+are sent, so the messages vary in length. */
+typedef struct SMB_MESSAGE
+{
+	uint32_t ulWriter;
+	uint32_t ulSequence;
+	uint8_t ucPayload[ smbMAX_PAYLOAD_BYTES ];
+} SmbMessage_t;
+
+#define smbHEADER_BYTES				( sizeof( SmbMessage_t ) - smbMAX_PAYLOAD_BYTES )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The single task tests, run by the controller task on its own buffer.
+ */
+static void prvControllerTask( void *pvParameters );
+
+/*
+ * The tasks that send to and receive from the shared buffer.
+ */
+static void prvWriterTask( void *pvParameters );
+static void prvReaderTask( void *pvParameters );
+
+/*
+ * Write a message and return its length, and check a message is the one
+ * expected.
+ */
+static size_t prvFillMessage( SmbMessage_t *pxMessage, uint32_t ulWriter, uint32_t ulSequence, size_t xPayloadBytes );
+static BaseType_t prvIsExpectedMessage( const SmbMessage_t *pxMessage, size_t xLength, uint32_t ulWriter, uint32_t ulSequence );
+
+/*
+ * Latch an error if xCondition is pdFALSE.
+ */
+static void prvCheck( BaseType_t xCondition );
+
+/*-----------------------------------------------------------*/
+
+/* The buffer used by the controller task, and the buffer shared by the writer
+and reader tasks. */
+static MessageBufferHandle_t xControlBuffer = NULL;
+static MessageBufferHandle_t xSharedBuffer = NULL;
+
+/* Incremented by each task on each loop.
+xAreSharedMessageBufferTasksStillRunning() checks they are all still
+incrementing. */
+static volatile uint32_t ulControllerCycles = 0UL;
+static volatile uint32_t ulWriterCycles[ smbNUM_WRITERS ] = { 0UL };
+static volatile uint32_t ulReaderCycles[ smbNUM_READERS ] = { 0UL };
+
+/* Set to pdTRUE if any task finds an error. */
+static volatile BaseType_t xErrorDetected = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartSharedMessageBufferTasks( UBaseType_t uxPriority )
+{
+UBaseType_t uxTask;
+
+	xControlBuffer = xMessageBufferCreateShared( smbCONTROL_BUFFER_LENGTH );
+	xSharedBuffer = xMessageBufferCreateShared( smbSHARED_BUFFER_LENGTH );
+
+	if( ( xControlBuffer != NULL ) && ( xSharedBuffer != NULL ) )
+	{
+		xTaskCreate( prvControllerTask, "SMBCtrl", configMINIMAL_STACK_SIZE, NULL, uxPriority, NULL );
+
+		for( uxTask = 0; uxTask < smbNUM_WRITERS; uxTask++ )
+		{
+			xTaskCreate( prvWriterTask, "SMBTx", configMINIMAL_STACK_SIZE, ( void * ) uxTask, uxPriority, NULL );
+		}
+
+		for( uxTask = 0; uxTask < smbNUM_READERS; uxTask++ )
+		{
+			xTaskCreate( prvReaderTask, "SMBRx", configMINIMAL_STACK_SIZE, ( void * ) uxTask, uxPriority, NULL );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvControllerTask( void *pvParameters )
+{
+static uint8_t ucTooLarge[ smbCONTROL_BUFFER_LENGTH ] = { 0 };
+SmbMessage_t xMessage;
+size_t xLength;
+const size_t xControlLength = smbHEADER_BYTES + smbCONTROL_PAYLOAD_BYTES;
+const uint32_t ulMessagesThatFit = ( uint32_t ) ( smbCONTROL_BUFFER_LENGTH / smbSPACE_FOR( xControlLength ) );
+uint32_t ulSequence = 0UL, ulFirst, ulSent;
+TickType_t xTimeBefore;
+
+	/* Just to remove compiler warnings. */
+	( void ) pvParameters;
+
+	/* A single task is the only one to use xControlBuffer. */
+	for( ;; )
+	{
+		ulFirst = ulSequence;
+
+		/* Nothing can be received from the empty buffer, with or without a
+		block time. */
+		prvCheck( xMessageBufferIsEmpty( xControlBuffer ) );
+		prvCheck( xMessageBufferNextLengthBytes( xControlBuffer ) == 0 );
+		prvCheck( xMessageBufferReceive( xControlBuffer, &xMessage, sizeof( xMessage ), smbDONT_BLOCK ) == 0 );
+
+		xTimeBefore = xTaskGetTickCount();
+		prvCheck( xMessageBufferReceive( xControlBuffer, &xMessage, sizeof( xMessage ), smbSHORT_DELAY ) == 0 );
+		prvCheck( ( xTaskGetTickCount() - xTimeBefore ) >= smbSHORT_DELAY );
+
+		/* A message larger than the whole buffer can never be sent, so is
+		failed at once rather than waited for. */
+		xTimeBefore = xTaskGetTickCount();
+		prvCheck( xMessageBufferSend( xControlBuffer, ucTooLarge, smbCONTROL_BUFFER_LENGTH - sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) + 1, smbSHARED_BLOCK_TIME ) == 0 );
+		prvCheck( ( xTaskGetTickCount() - xTimeBefore ) < smbSHARED_BLOCK_TIME );
+
+		/* Fill the buffer. */
+		for( ulSent = 0UL; ulSent < ulMessagesThatFit; ulSent++ )
+		{
+			xLength = prvFillMessage( &xMessage, 0UL, ulSequence, smbCONTROL_PAYLOAD_BYTES );
+			prvCheck( xMessageBufferSend( xControlBuffer, &xMessage, xLength, smbDONT_BLOCK ) == xControlLength );
+			ulSequence++;
+		}
+
+		/* Nothing more fits in the full buffer. */
+		prvCheck( xMessageBufferSend( xControlBuffer, &xMessage, xControlLength, smbDONT_BLOCK ) == 0 );
+		xTimeBefore = xTaskGetTickCount();
+		prvCheck( xMessageBufferSend( xControlBuffer, &xMessage, xControlLength, smbSHORT_DELAY ) == 0 );
+		prvCheck( ( xTaskGetTickCount() - xTimeBefore ) >= smbSHORT_DELAY );
+
+		/* A buffer too small for the next message gets 0 at once, whatever
+		the block time, and leaves the message where it was. */
+		prvCheck( xMessageBufferNextLengthBytes( xControlBuffer ) == xControlLength );
+		xTimeBefore = xTaskGetTickCount();
+		prvCheck( xMessageBufferReceive( xControlBuffer, &xMessage, xControlLength - 1, smbSHARED_BLOCK_TIME ) == 0 );
+		prvCheck( ( xTaskGetTickCount() - xTimeBefore ) < smbSHARED_BLOCK_TIME );
+		prvCheck( xMessageBufferNextLengthBytes( xControlBuffer ) == xControlLength );
+
+		/* The messages come out in the order they were sent. */
+		for( ulSent = ulFirst; ulSent != ulSequence; ulSent++ )
+		{
+			xLength = xMessageBufferReceive( xControlBuffer, &xMessage, sizeof( xMessage ), smbDONT_BLOCK );
+			prvCheck( prvIsExpectedMessage( &xMessage, xLength, 0UL, ulSent ) );
+		}
+
+		prvCheck( xMessageBufferIsEmpty( xControlBuffer ) );
+
+		/* No task is using the buffer, so it can be reset. */
+		prvCheck( xMessageBufferReset( xControlBuffer ) == pdPASS );
+
+		ulControllerCycles++;
+		vTaskDelay( smbCONTROLLER_DELAY );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriterTask( void *pvParameters )
+{
+const uint32_t ulWriter = ( uint32_t ) ( UBaseType_t ) pvParameters;
+uint32_t ulSequence = 0UL;
+SmbMessage_t xMessage;
+size_t xLength;
+
+	for( ;; )
+	{
+		/* Each writer sends messages of a different mix of lengths, so the
+		writers blocked on the full buffer wait for different amounts of
+		space. */
+		xLength = prvFillMessage( &xMessage, ulWriter, ulSequence, ( size_t ) ( ( ulSequence * ( ulWriter + 1UL ) ) % smbMAX_PAYLOAD_BYTES ) + 1 );
+
+		if( xMessageBufferSend( xSharedBuffer, &xMessage, xLength, smbSHARED_BLOCK_TIME ) == xLength )
+		{
+			ulSequence++;
+			ulWriterCycles[ ulWriter ]++;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvReaderTask( void *pvParameters )
+{
+const uint32_t ulReader = ( uint32_t ) ( UBaseType_t ) pvParameters;
+uint32_t ulNext[ smbNUM_WRITERS ] = { 0UL };
+uint32_t ulReceives = 0UL;
+SmbMessage_t xMessage;
+size_t xLength;
+TickType_t xTimeBefore;
+
+	for( ;; )
+	{
+		ulReceives++;
+
+		if( ( ulReader == 0UL ) && ( ( ulReceives % smbTOO_SMALL_RATE ) == 0UL ) )
+		{
+			/* No message is that short.  If there is a message it is left for
+			the other reader, which is woken if it is waiting for one, and if
+			there is none the receive blocks until there is. */
+			xTimeBefore = xTaskGetTickCount();
+			xLength = xMessageBufferReceive( xSharedBuffer, &xMessage, smbTOO_SMALL_BYTES, smbSHARED_BLOCK_TIME );
+			prvCheck( xLength == 0 );
+
+			if( ( xTaskGetTickCount() - xTimeBefore ) < smbSHARED_BLOCK_TIME )
+			{
+				ulReaderCycles[ ulReader ]++;
+			}
+
+			continue;
+		}
+
+		xLength = xMessageBufferReceive( xSharedBuffer, &xMessage, sizeof( xMessage ), smbSHARED_BLOCK_TIME );
+
+		if( xLength == 0 )
+		{
+			continue;
+		}
+
+		/* The other reader takes some of the messages of each writer, so the
+		sequence can skip ahead, but never goes back. */
+		if( ( xLength >= smbHEADER_BYTES ) && ( xMessage.ulWriter < smbNUM_WRITERS ) && ( xMessage.ulSequence >= ulNext[ xMessage.ulWriter ] ) )
+		{
+			prvCheck( prvIsExpectedMessage( &xMessage, xLength, xMessage.ulWriter, xMessage.ulSequence ) );
+			ulNext[ xMessage.ulWriter ] = xMessage.ulSequence + 1UL;
+		}
+		else
+		{
+			prvCheck( pdFALSE );
+		}
+
+		ulReaderCycles[ ulReader ]++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvFillMessage( SmbMessage_t *pxMessage, uint32_t ulWriter, uint32_t ulSequence, size_t xPayloadBytes )
+{
+size_t x;
+
+	pxMessage->ulWriter = ulWriter;
+	pxMessage->ulSequence = ulSequence;
+
+	for( x = 0; x < xPayloadBytes; x++ )
+	{
+		pxMessage->ucPayload[ x ] = ( uint8_t ) ( ulSequence + ulWriter + ( uint32_t ) x );
+	}
+
+	return smbHEADER_BYTES + xPayloadBytes;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsExpectedMessage( const SmbMessage_t *pxMessage, size_t xLength, uint32_t ulWriter, uint32_t ulSequence )
+{
+BaseType_t xReturn = pdTRUE;
+size_t x;
+
+	if( ( xLength <= smbHEADER_BYTES ) || ( xLength > sizeof( SmbMessage_t ) ) )
+	{
+		xReturn = pdFALSE;
+	}
+	else if( ( pxMessage->ulWriter != ulWriter ) || ( pxMessage->ulSequence != ulSequence ) )
+	{
+		xReturn = pdFALSE;
+	}
+	else
+	{
+		for( x = 0; x < ( xLength - smbHEADER_BYTES ); x++ )
+		{
+			if( pxMessage->ucPayload[ x ] != ( uint8_t ) ( ulSequence + ulWriter + ( uint32_t ) x ) )
+			{
+				xReturn = pdFALSE;
+			}
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheck( BaseType_t xCondition )
+{
+	if( xCondition == pdFALSE )
+	{
+		xErrorDetected = pdTRUE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAreSharedMessageBufferTasksStillRunning( void )
+{
+static uint32_t ulLastControllerCycles = 0UL;
+static uint32_t ulLastWriterCycles[ smbNUM_WRITERS ] = { 0UL };
+static uint32_t ulLastReaderCycles[ smbNUM_READERS ] = { 0UL };
+BaseType_t xReturn = pdPASS, x;
+
+	if( ulLastControllerCycles == ulControllerCycles )
+	{
+		xReturn = pdFAIL;
+	}
+
+	ulLastControllerCycles = ulControllerCycles;
+
+	for( x = 0; x < smbNUM_WRITERS; x++ )
+	{
+		if( ulLastWriterCycles[ x ] == ulWriterCycles[ x ] )
+		{
+			xReturn = pdFAIL;
+		}
+
+		ulLastWriterCycles[ x ] = ulWriterCycles[ x ];
+	}
+
+	for( x = 0; x < smbNUM_READERS; x++ )
+	{
+		if( ulLastReaderCycles[ x ] == ulReaderCycles[ x ] )
+		{
+			xReturn = pdFAIL;
+		}
+
+		ulLastReaderCycles[ x ] = ulReaderCycles[ x ];
+	}
+
+	if( xErrorDetected != pdFALSE )
+	{
+		xReturn = pdFAIL;
+	}
+
+	return xReturn;
+}
+
+/* Exclude the entire file if configUSE_SHARED_MESSAGE_BUFFERS is 0. */
+#endif /* configUSE_SHARED_MESSAGE_BUFFERS == 1 */
@@ -786,12 +786,18 @@
     #define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )
 #endif
 
+/* A port that produces the tick itself when the idle task wakes up, as on
+ * virtual time, can also suppress a single tick. */
+#ifndef portMIN_IDLE_TIME_BEFORE_SLEEP
+    #define portMIN_IDLE_TIME_BEFORE_SLEEP    2
+#endif
+
 #ifndef configEXPECTED_IDLE_TIME_BEFORE_SLEEP
-    #define configEXPECTED_IDLE_TIME_BEFORE_SLEEP    2
+    #define configEXPECTED_IDLE_TIME_BEFORE_SLEEP    portMIN_IDLE_TIME_BEFORE_SLEEP
 #endif
 
-#if configEXPECTED_IDLE_TIME_BEFORE_SLEEP < 2
-    #error configEXPECTED_IDLE_TIME_BEFORE_SLEEP must not be less than 2
+#if configEXPECTED_IDLE_TIME_BEFORE_SLEEP < portMIN_IDLE_TIME_BEFORE_SLEEP
+    #error configEXPECTED_IDLE_TIME_BEFORE_SLEEP must not be less than portMIN_IDLE_TIME_BEFORE_SLEEP
 #endif
 
 #ifndef configUSE_TICKLESS_IDLE
@@ -814,6 +820,10 @@
     #define configUSE_QUEUE_SETS    0
 #endif
 
+#ifndef configUSE_QUEUE_IN_PLACE
+    #define configUSE_QUEUE_IN_PLACE    0
+#endif
+
 #ifndef portTASK_USES_FLOATING_POINT
     #define portTASK_USES_FLOATING_POINT()
 #endif
@@ -862,6 +872,27 @@
     #define configUSE_PORT_OPTIMISED_TASK_SELECTION    0
 #endif
 
+/* Set to 1 to select the task to run from a bitmap of the priorities that have
+ * ready tasks, with the count leading zeros builtin of the compiler, instead
+ * of searching the ready lists down from the top ready priority, when the port
+ * has no optimised task selection.  The bitmap has two levels, so
+ * configMAX_PRIORITIES can be up to the square of the number of bits in a
+ * UBaseType_t.  GCC and Clang only. */
+#ifndef configUSE_BITMAP_TASK_SELECTION
+    #define configUSE_BITMAP_TASK_SELECTION    0
+#endif
+
+/* Set to 1 to keep the tasks blocked on a queue or a semaphore in one event
+ * list per task priority instead of one list sorted by priority, so that
+ * blocking on and waking from a queue no longer depends on the number of tasks
+ * already waiting on it.  Each queue then holds 2 * configMAX_PRIORITIES lists,
+ * and the same two level bitmap as configUSE_BITMAP_TASK_SELECTION, so
+ * configMAX_PRIORITIES can be up to the square of the number of bits in a
+ * UBaseType_t.  GCC and Clang only. */
+#ifndef configUSE_PRIORITY_EVENT_LISTS
+    #define configUSE_PRIORITY_EVENT_LISTS    0
+#endif
+
 #ifndef configAPPLICATION_ALLOCATED_HEAP
     #define configAPPLICATION_ALLOCATED_HEAP    0
 #endif
@@ -882,6 +913,34 @@
     #define configUSE_POSIX_ERRNO    0
 #endif
 
+/* Set to 1 to keep the tasks delayed by less than 2^(2 * configTIMING_WHEEL_BITS)
+ * ticks in a two level timing wheel instead of the sorted delayed lists, so
+ * that delaying and waking a task no longer depends on the number of delayed
+ * tasks. */
+#ifndef configUSE_TIMING_WHEEL
+    #define configUSE_TIMING_WHEEL    0
+#endif
+
+/* Each level of the timing wheel has 2^configTIMING_WHEEL_BITS slots. */
+#ifndef configTIMING_WHEEL_BITS
+    #define configTIMING_WHEEL_BITS    6
+#endif
+
+/* Set to 1 to keep the active software timers due within
+ * 2^(2 * configTIMER_WHEEL_BITS) ticks in a two level timing wheel of the timer
+ * service task, so that starting, stopping and resetting such a timer no longer
+ * depends on the number of active timers, and the timers due at the same tick
+ * expire together.  Timers due later still go in the sorted active timer
+ * lists. */
+#ifndef configUSE_TIMER_WHEEL
+    #define configUSE_TIMER_WHEEL    0
+#endif
+
+/* Each level of the timer wheel has 2^configTIMER_WHEEL_BITS slots. */
+#ifndef configTIMER_WHEEL_BITS
+    #define configTIMER_WHEEL_BITS    configTIMING_WHEEL_BITS
+#endif
+
 #ifndef portTICK_TYPE_IS_ATOMIC
     #define portTICK_TYPE_IS_ATOMIC    0
 #endif
@@ -911,6 +970,14 @@
     #define configMESSAGE_BUFFER_LENGTH_TYPE    size_t
 #endif
 
+#ifndef configUSE_LOCK_FREE_STREAM_BUFFERS
+    #define configUSE_LOCK_FREE_STREAM_BUFFERS    0
+#endif
+
+#ifndef configUSE_SHARED_MESSAGE_BUFFERS
+    #define configUSE_SHARED_MESSAGE_BUFFERS    0
+#endif
+
 /* Sanity check the configuration. */
 #if ( configUSE_TICKLESS_IDLE != 0 )
     #if ( INCLUDE_vTaskSuspend != 1 )
@@ -918,6 +985,42 @@
     #endif /* INCLUDE_vTaskSuspend */
 #endif /* configUSE_TICKLESS_IDLE */
 
+#if ( configUSE_BITMAP_TASK_SELECTION == 1 )
+    #if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+        #error configUSE_BITMAP_TASK_SELECTION and configUSE_PORT_OPTIMISED_TASK_SELECTION cannot both be 1
+    #endif
+    #ifndef __GNUC__
+        #error configUSE_BITMAP_TASK_SELECTION requires GCC or Clang
+    #endif
+#endif /* configUSE_BITMAP_TASK_SELECTION */
+
+#if ( configUSE_PRIORITY_EVENT_LISTS == 1 )
+    #if ( configUSE_CO_ROUTINES == 1 )
+        #error configUSE_PRIORITY_EVENT_LISTS cannot be used with co-routines
+    #endif
+    #ifndef __GNUC__
+        #error configUSE_PRIORITY_EVENT_LISTS requires GCC or Clang
+    #endif
+#endif /* configUSE_PRIORITY_EVENT_LISTS */
+
+#if ( configUSE_TIMING_WHEEL == 1 )
+    #if ( configTIMING_WHEEL_BITS < 5 )
+        #error configTIMING_WHEEL_BITS must be at least 5
+    #endif
+    #if ( ( configUSE_16_BIT_TICKS == 1 ) && ( configTIMING_WHEEL_BITS > 7 ) )
+        #error configTIMING_WHEEL_BITS must be at most 7 when configUSE_16_BIT_TICKS is 1
+    #endif
+#endif /* configUSE_TIMING_WHEEL */
+
+#if ( configUSE_TIMER_WHEEL == 1 )
+    #if ( configTIMER_WHEEL_BITS < 5 )
+        #error configTIMER_WHEEL_BITS must be at least 5
+    #endif
+    #if ( ( configUSE_16_BIT_TICKS == 1 ) && ( configTIMER_WHEEL_BITS > 7 ) )
+        #error configTIMER_WHEEL_BITS must be at most 7 when configUSE_16_BIT_TICKS is 1
+    #endif
+#endif /* configUSE_TIMER_WHEEL */
+
 #if ( ( configSUPPORT_STATIC_ALLOCATION == 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 0 ) )
     #error configSUPPORT_STATIC_ALLOCATION and configSUPPORT_DYNAMIC_ALLOCATION cannot both be 0, but can both be 1.
 #endif
@@ -1148,6 +1251,17 @@ typedef struct xSTATIC_LIST
     #endif
 } StaticList_t;
 
+/* See the comments above the struct xSTATIC_LIST_ITEM definition. */
+#if ( configUSE_PRIORITY_EVENT_LISTS == 1 )
+    typedef struct xSTATIC_EVENT_LIST
+    {
+        UBaseType_t uxDummy1[ 1 + ( ( configMAX_PRIORITIES + ( sizeof( UBaseType_t ) * 8 ) - 1 ) / ( sizeof( UBaseType_t ) * 8 ) ) ];
+        StaticList_t xDummy2[ configMAX_PRIORITIES ];
+    } StaticEventList_t;
+#else
+    typedef StaticList_t StaticEventList_t;
+#endif
+
 /*
  * In line with software engineering best practice, especially when supplying a
  * library that is likely to change in future versions, FreeRTOS implements a
@@ -1235,7 +1349,7 @@ typedef struct xSTATIC_QUEUE
         UBaseType_t uxDummy2;
     } u;
 
-    StaticList_t xDummy3[ 2 ];
+    StaticEventList_t xDummy3[ 2 ];
     UBaseType_t uxDummy4[ 3 ];
     uint8_t ucDummy5[ 2 ];
 
@@ -1251,6 +1365,10 @@ typedef struct xSTATIC_QUEUE
         UBaseType_t uxDummy8;
         uint8_t ucDummy9;
     #endif
+
+    #if ( configUSE_QUEUE_IN_PLACE == 1 )
+        void * pvDummy10[ 2 ];
+    #endif
 } StaticQueue_t;
 typedef StaticQueue_t StaticSemaphore_t;
 
@@ -1331,6 +1449,12 @@ typedef struct xSTATIC_STREAM_BUFFER
     #if ( configUSE_TRACE_FACILITY == 1 )
         UBaseType_t uxDummy4;
     #endif
+    #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+        size_t uxDummy5[ 2 ];
+        StaticList_t xDummy6[ 2 ];
+        StaticEventList_t xDummy7[ 2 ];
+        size_t uxDummy8;
+    #endif
 } StaticStreamBuffer_t;
 
 /* Message buffers are built on stream buffers. */
@@ -408,6 +408,82 @@ static portFORCE_INLINE uint32_t Atomic_XOR_u32( uint32_t volatile * pulDestinat
     return ulCurrent;
 }
 
+/*----------------------------- Ordering ------------------------------*/
+
+/*
+ * A lock free single producer single consumer structure is published with a
+ * store-release of an index once the data it covers is written, and read
+ * with a load-acquire of the index before the data is read.  None of them
+ * masks interrupts.  GCC compatible compilers order the accesses for any
+ * number of cores, or threads running in parallel with the tasks such as the
+ * host threads of the POSIX port.  Otherwise volatile accesses and
+ * portMEMORY_BARRIER() are used, which only order them on a single core.
+ */
+#if defined( __GNUC__ )
+    #define ATOMIC_LOAD_ACQUIRE( pxSource )                  __atomic_load_n( ( pxSource ), __ATOMIC_ACQUIRE )
+    #define ATOMIC_STORE_RELEASE( pxDestination, xValue )    __atomic_store_n( ( pxDestination ), ( xValue ), __ATOMIC_RELEASE )
+    #define ATOMIC_FULL_BARRIER()                            __atomic_thread_fence( __ATOMIC_SEQ_CST )
+#else
+    #define ATOMIC_LOAD_ACQUIRE( pxSource )                  ( *( pxSource ) )
+    #define ATOMIC_STORE_RELEASE( pxDestination, xValue )    do { portMEMORY_BARRIER(); *( pxDestination ) = ( xValue ); } while( 0 )
+    #define ATOMIC_FULL_BARRIER()                            portMEMORY_BARRIER()
+#endif
+
+/**
+ * Atomic load-acquire
+ *
+ * @brief Reads a value written with Atomic_StoreRelease_size().
+ *
+ * @param[in] pxSource  Pointer to memory location to be read.
+ *
+ * @return The value read.
+ *
+ * @note Memory accesses after this one are not moved before it, so data
+ *       written before the value was stored is seen.
+ */
+static portFORCE_INLINE size_t Atomic_LoadAcquire_size( size_t const volatile * pxSource )
+{
+    size_t xValue = ATOMIC_LOAD_ACQUIRE( pxSource );
+
+    portMEMORY_BARRIER();
+
+    return xValue;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Atomic store-release
+ *
+ * @brief Writes a value to be read with Atomic_LoadAcquire_size().
+ *
+ * @param[out] pxDestination  Pointer to memory location to be written.
+ * @param[in] xValue          Value to be written to *pxDestination.
+ *
+ * @note Memory accesses before this one are not moved after it, so they are
+ *       complete when the value is seen.
+ */
+static portFORCE_INLINE void Atomic_StoreRelease_size( size_t volatile * pxDestination,
+                                                       size_t xValue )
+{
+    ATOMIC_STORE_RELEASE( pxDestination, xValue );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Atomic full barrier
+ *
+ * @brief Orders all memory accesses before the barrier before all those after
+ *        it, including a store before it and a load after it.
+ *
+ * @note Needed where each side stores one value then reads the one the other
+ *       side stores, such as a writer publishing data then checking for a
+ *       waiting reader, while the reader registers then checks for data.
+ */
+static portFORCE_INLINE void Atomic_FullBarrier( void )
+{
+    ATOMIC_FULL_BARRIER();
+}
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
     }
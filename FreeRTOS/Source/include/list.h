@@ -334,6 +334,40 @@ typedef struct xLIST
  */
 #define listLIST_IS_INITIALISED( pxList )                ( ( pxList )->xListEnd.xItemValue == portMAX_DELAY )
 
+/*
+ * Definition of the list the tasks blocked on a queue wait in.  With
+ * configUSE_PRIORITY_EVENT_LISTS set to 1 it holds one list per task priority,
+ * and the same two level bitmap as configUSE_BITMAP_TASK_SELECTION: bit
+ * ( n % listEVENT_LIST_BITS ) of uxPriorities[ n / listEVENT_LIST_BITS ] is set
+ * when xLists[ n ] may hold tasks, and bit w of uxTopPriorities when
+ * uxPriorities[ w ] is not 0, so that a task is added and the highest priority
+ * task found without walking the waiting tasks.  Tasks also leave the lists
+ * through uxListRemove() when they time out, so a bit is only cleared when its
+ * list is found empty.  Otherwise it is a single list sorted by priority.
+ */
+#if ( configUSE_PRIORITY_EVENT_LISTS == 1 )
+    #define listEVENT_LIST_BITS             ( sizeof( UBaseType_t ) * ( size_t ) 8 )
+    #define listEVENT_LIST_WORDS            ( ( configMAX_PRIORITIES + listEVENT_LIST_BITS - 1 ) / listEVENT_LIST_BITS )
+    #define listEVENT_LIST_BIT( uxBit )     ( ( UBaseType_t ) 1 << ( uxBit ) )
+    #define listEVENT_LIST_TOP( uxBits )    ( ( UBaseType_t ) ( 63 - __builtin_clzll( ( unsigned long long ) ( uxBits ) ) ) )
+
+    typedef struct xEVENT_LIST
+    {
+        volatile UBaseType_t uxTopPriorities;
+        volatile UBaseType_t uxPriorities[ listEVENT_LIST_WORDS ];
+        List_t xLists[ configMAX_PRIORITIES ];
+    } EventList_t;
+
+    #define listGET_HEAD_EVENT_LIST( pxEventList )    pxListGetEventListHead( pxEventList )
+    #define listEVENT_LIST_IS_EMPTY( pxEventList )    ( ( pxListGetEventListHead( pxEventList ) == NULL ) ? pdTRUE : pdFALSE )
+#else
+    typedef List_t EventList_t;
+
+    #define listGET_HEAD_EVENT_LIST( pxEventList )    ( pxEventList )
+    #define listEVENT_LIST_IS_EMPTY( pxEventList )    listLIST_IS_EMPTY( pxEventList )
+    #define vListInitialiseEventList( pxEventList )   vListInitialise( pxEventList )
+#endif /* configUSE_PRIORITY_EVENT_LISTS */
+
 /*
  * Must be called before a list is used!  This initialises all the members
  * of the list structure and inserts the xListEnd item into the list as a
@@ -408,6 +442,30 @@ void vListInsertEnd( List_t * const pxList,
  */
 UBaseType_t uxListRemove( ListItem_t * const pxItemToRemove ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_PRIORITY_EVENT_LISTS == 1 )
+
+/*
+ * Initialise the lists of all the priorities of an event list.
+ */
+    void vListInitialiseEventList( EventList_t * const pxEventList ) PRIVILEGED_FUNCTION;
+
+/*
+ * Insert a list item at the end of the list of priority uxPriority of an event
+ * list, after the items of the same priority already there.
+ */
+    void vListInsertEventList( EventList_t * const pxEventList,
+                               ListItem_t * const pxNewListItem,
+                               UBaseType_t uxPriority ) PRIVILEGED_FUNCTION;
+
+/*
+ * Return the list of the highest priority that holds items in an event list,
+ * or NULL if the event list is empty.  The head entry of that list is the one
+ * vListInsert() would have placed at the head of a single sorted list.
+ */
+    List_t * pxListGetEventListHead( const EventList_t * const pxEventList ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_PRIORITY_EVENT_LISTS */
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
     }
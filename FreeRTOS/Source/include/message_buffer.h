@@ -46,7 +46,10 @@
  * block time to 0.  Likewise, if there are to be multiple different readers
  * then the application writer must place each call to a reading API function
  * (such as xMessageBufferRead()) inside a critical section and set the receive
- * timeout to 0.
+ * timeout to 0.  Alternatively, when configUSE_SHARED_MESSAGE_BUFFERS is set to
+ * 1 in FreeRTOSConfig.h, a message buffer created with
+ * xMessageBufferCreateShared() can be written and read by any number of tasks,
+ * with block times.
  *
  * Message buffers hold variable length messages.  To enable that, when a
  * message is written to the message buffer an additional sizeof( size_t ) bytes
@@ -210,6 +213,63 @@ typedef void * MessageBufferHandle_t;
 #define xMessageBufferCreateStatic( xBufferSizeBytes, pucMessageBufferStorageArea, pxStaticMessageBuffer ) \
     ( MessageBufferHandle_t ) xStreamBufferGenericCreateStatic( xBufferSizeBytes, 0, pdTRUE, pucMessageBufferStorageArea, pxStaticMessageBuffer )
 
+/**
+ * message_buffer.h
+ *
+ * <pre>
+ * MessageBufferHandle_t xMessageBufferCreateShared( size_t xBufferSizeBytes );
+ * </pre>
+ *
+ * Creates a new message buffer that any number of tasks can write to and read
+ * from at the same time, without the critical sections described at the top of
+ * this file, available when configUSE_SHARED_MESSAGE_BUFFERS is set to 1 in
+ * FreeRTOSConfig.h.  It is used with xMessageBufferSend() and
+ * xMessageBufferReceive(), which may block.  Interrupts cannot use it.
+ *
+ * A writer reserves the space for its message, and a reader claims the next
+ * message, with the scheduler suspended, then copies the message with the
+ * scheduler running, so a long message does not hold up the other writers and
+ * readers.  Messages are received in the order their space was reserved.  The
+ * highest priority task waiting to send or receive is unblocked first.
+ *
+ * A reader whose buffer is too small for the next message leaves the message
+ * for another reader, waking one if any is waiting, and xMessageBufferReceive()
+ * returns 0 at once, without waiting for its block time.  A task that receives
+ * 0 before its block time has passed can call xMessageBufferNextLengthBytes()
+ * to get the length of the next message, although another reader may take that
+ * message first.
+ *
+ * Reading a message unblocks the tasks waiting to send only once there is space
+ * for the smallest message one of them is waiting to send.
+ *
+ * @param xBufferSizeBytes As for xMessageBufferCreate().
+ *
+ * @return As for xMessageBufferCreate().
+ *
+ * \defgroup xMessageBufferCreateShared xMessageBufferCreateShared
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferCreateShared( xBufferSizeBytes ) \
+    ( MessageBufferHandle_t ) xStreamBufferGenericCreate( xBufferSizeBytes, ( size_t ) 0, sbTYPE_SHARED_MESSAGE_BUFFER )
+
+/**
+ * message_buffer.h
+ *
+ * <pre>
+ * MessageBufferHandle_t xMessageBufferCreateSharedStatic( size_t xBufferSizeBytes,
+ *                                                      uint8_t *pucMessageBufferStorageArea,
+ *                                                      StaticMessageBuffer_t *pxStaticMessageBuffer );
+ * </pre>
+ *
+ * Version of xMessageBufferCreateShared() that uses statically allocated
+ * memory, with the parameters of xMessageBufferCreateStatic().
+ *
+ * \defgroup xMessageBufferCreateSharedStatic xMessageBufferCreateSharedStatic
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferCreateSharedStatic( xBufferSizeBytes, pucMessageBufferStorageArea, pxStaticMessageBuffer ) \
+    ( MessageBufferHandle_t ) xStreamBufferGenericCreateStatic( xBufferSizeBytes, 0, sbTYPE_SHARED_MESSAGE_BUFFER, pucMessageBufferStorageArea, pxStaticMessageBuffer )
+
 /**
  * message_buffer.h
  *
@@ -310,6 +370,25 @@ typedef void * MessageBufferHandle_t;
 #define xMessageBufferSend( xMessageBuffer, pvTxData, xDataLengthBytes, xTicksToWait ) \
     xStreamBufferSend( ( StreamBufferHandle_t ) xMessageBuffer, pvTxData, xDataLengthBytes, xTicksToWait )
 
+/**
+ * message_buffer.h
+ *
+ * <pre>
+ * size_t xMessageBufferSendVectors( MessageBufferHandle_t xMessageBuffer,
+ *                                const StreamBufferVector_t *pxVectors,
+ *                                UBaseType_t uxVectorCount,
+ *                                TickType_t xTicksToWait );
+ * </pre>
+ *
+ * Version of xMessageBufferSend() that sends one message gathered from several
+ * buffers.  See xStreamBufferSendVectors().
+ *
+ * \defgroup xMessageBufferSendVectors xMessageBufferSendVectors
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferSendVectors( xMessageBuffer, pxVectors, uxVectorCount, xTicksToWait ) \
+    xStreamBufferSendVectors( ( StreamBufferHandle_t ) xMessageBuffer, pxVectors, uxVectorCount, xTicksToWait )
+
 /**
  * message_buffer.h
  *
@@ -415,6 +494,33 @@ typedef void * MessageBufferHandle_t;
 #define xMessageBufferSendFromISR( xMessageBuffer, pvTxData, xDataLengthBytes, pxHigherPriorityTaskWoken ) \
     xStreamBufferSendFromISR( ( StreamBufferHandle_t ) xMessageBuffer, pvTxData, xDataLengthBytes, pxHigherPriorityTaskWoken )
 
+/**
+ * message_buffer.h
+ *
+ * <pre>
+ * size_t xMessageBufferSendLockFree( MessageBufferHandle_t xMessageBuffer,
+ *                                 const void *pvTxData,
+ *                                 size_t xDataLengthBytes,
+ *                                 BaseType_t *pxTaskWaiting );
+ * </pre>
+ *
+ * For advanced users only.
+ *
+ * Version of xMessageBufferSendFromISR() for a writer that cannot call the
+ * FreeRTOS API at all, available when configUSE_LOCK_FREE_STREAM_BUFFERS is
+ * set to 1 in FreeRTOSConfig.h.  The message and its length are published to
+ * the reader together.  See xStreamBufferSendLockFree().
+ *
+ * @return The number of bytes written to the message buffer.  If the call
+ * fails because there was not enough free space in the message buffer for the
+ * whole message then 0 is returned.
+ *
+ * \defgroup xMessageBufferSendLockFree xMessageBufferSendLockFree
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferSendLockFree( xMessageBuffer, pvTxData, xDataLengthBytes, pxTaskWaiting ) \
+    xStreamBufferSendLockFree( ( StreamBufferHandle_t ) xMessageBuffer, pvTxData, xDataLengthBytes, pxTaskWaiting )
+
 /**
  * message_buffer.h
  *
@@ -473,7 +579,8 @@ typedef void * MessageBufferHandle_t;
  * any.  If xMessageBufferReceive() times out before a message became available
  * then zero is returned.  If the length of the message is greater than
  * xBufferLengthBytes then the message will be left in the message buffer and
- * zero is returned.
+ * zero is returned.  With a shared message buffer that zero is returned at
+ * once, without waiting for xTicksToWait, see xMessageBufferCreateShared().
  *
  * Example use:
  * <pre>
@@ -504,6 +611,26 @@ typedef void * MessageBufferHandle_t;
 #define xMessageBufferReceive( xMessageBuffer, pvRxData, xBufferLengthBytes, xTicksToWait ) \
     xStreamBufferReceive( ( StreamBufferHandle_t ) xMessageBuffer, pvRxData, xBufferLengthBytes, xTicksToWait )
 
+/**
+ * message_buffer.h
+ *
+ * <pre>
+ * size_t xMessageBufferReceiveVectors( MessageBufferHandle_t xMessageBuffer,
+ *                                   const StreamBufferVector_t *pxVectors,
+ *                                   UBaseType_t uxVectorCount,
+ *                                   TickType_t xTicksToWait );
+ * </pre>
+ *
+ * Version of xMessageBufferReceive() that scatters the next message across
+ * several buffers.  The message is only received if it fits in the total
+ * length of the vectors.  See xStreamBufferReceiveVectors().
+ *
+ * \defgroup xMessageBufferReceiveVectors xMessageBufferReceiveVectors
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferReceiveVectors( xMessageBuffer, pxVectors, uxVectorCount, xTicksToWait ) \
+    xStreamBufferReceiveVectors( ( StreamBufferHandle_t ) xMessageBuffer, pxVectors, uxVectorCount, xTicksToWait )
+
 
 /**
  * message_buffer.h
@@ -606,6 +733,31 @@ typedef void * MessageBufferHandle_t;
 #define xMessageBufferReceiveFromISR( xMessageBuffer, pvRxData, xBufferLengthBytes, pxHigherPriorityTaskWoken ) \
     xStreamBufferReceiveFromISR( ( StreamBufferHandle_t ) xMessageBuffer, pvRxData, xBufferLengthBytes, pxHigherPriorityTaskWoken )
 
+/**
+ * message_buffer.h
+ *
+ * <pre>
+ * size_t xMessageBufferReceiveLockFree( MessageBufferHandle_t xMessageBuffer,
+ *                                    void *pvRxData,
+ *                                    size_t xBufferLengthBytes,
+ *                                    BaseType_t *pxTaskWaiting );
+ * </pre>
+ *
+ * For advanced users only.
+ *
+ * Version of xMessageBufferReceiveFromISR() for a reader that cannot call the
+ * FreeRTOS API at all, available when configUSE_LOCK_FREE_STREAM_BUFFERS is
+ * set to 1 in FreeRTOSConfig.h.  See xStreamBufferReceiveLockFree().
+ *
+ * @return The length, in bytes, of the message read from the message buffer,
+ * if any.
+ *
+ * \defgroup xMessageBufferReceiveLockFree xMessageBufferReceiveLockFree
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferReceiveLockFree( xMessageBuffer, pvRxData, xBufferLengthBytes, pxTaskWaiting ) \
+    xStreamBufferReceiveLockFree( ( StreamBufferHandle_t ) xMessageBuffer, pvRxData, xBufferLengthBytes, pxTaskWaiting )
+
 /**
  * message_buffer.h
  *
@@ -729,7 +881,7 @@ typedef void * MessageBufferHandle_t;
  * \ingroup MessageBufferManagement
  */
 #define xMessageBufferNextLengthBytes( xMessageBuffer ) \
-    xStreamBufferNextMessageLengthBytes( ( StreamBufferHandle_t ) xMessageBuffer ) PRIVILEGED_FUNCTION;
+    xStreamBufferNextMessageLengthBytes( ( StreamBufferHandle_t ) xMessageBuffer )
 
 /**
  * message_buffer.h
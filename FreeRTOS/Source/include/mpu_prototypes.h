@@ -126,6 +126,24 @@ BaseType_t MPU_xQueueGenericSend( QueueHandle_t xQueue,
 BaseType_t MPU_xQueueReceive( QueueHandle_t xQueue,
                               void * const pvBuffer,
                               TickType_t xTicksToWait ) FREERTOS_SYSTEM_CALL;
+BaseType_t MPU_xQueueSendMultiple( QueueHandle_t xQueue,
+                                   const void * const pvItemsToQueue,
+                                   const UBaseType_t uxItemsToQueue,
+                                   TickType_t xTicksToWait ) FREERTOS_SYSTEM_CALL;
+BaseType_t MPU_xQueueReceiveMultiple( QueueHandle_t xQueue,
+                                      void * const pvBuffer,
+                                      const UBaseType_t uxMaxItems,
+                                      TickType_t xTicksToWait ) FREERTOS_SYSTEM_CALL;
+BaseType_t MPU_xQueueReserveSend( QueueHandle_t xQueue,
+                                  void ** const ppvItem,
+                                  TickType_t xTicksToWait ) FREERTOS_SYSTEM_CALL;
+BaseType_t MPU_xQueueCommitSend( QueueHandle_t xQueue ) FREERTOS_SYSTEM_CALL;
+BaseType_t MPU_xQueueAbortSend( QueueHandle_t xQueue ) FREERTOS_SYSTEM_CALL;
+BaseType_t MPU_xQueuePeekAcquire( QueueHandle_t xQueue,
+                                  void ** const ppvItem,
+                                  TickType_t xTicksToWait ) FREERTOS_SYSTEM_CALL;
+BaseType_t MPU_xQueueReleaseReceive( QueueHandle_t xQueue ) FREERTOS_SYSTEM_CALL;
+BaseType_t MPU_xQueueAbortReceive( QueueHandle_t xQueue ) FREERTOS_SYSTEM_CALL;
 BaseType_t MPU_xQueuePeek( QueueHandle_t xQueue,
                            void * const pvBuffer,
                            TickType_t xTicksToWait ) FREERTOS_SYSTEM_CALL;
@@ -234,6 +252,26 @@ size_t MPU_xStreamBufferReceive( StreamBufferHandle_t xStreamBuffer,
                                  void * pvRxData,
                                  size_t xBufferLengthBytes,
                                  TickType_t xTicksToWait ) FREERTOS_SYSTEM_CALL;
+size_t MPU_xStreamBufferSendVectors( StreamBufferHandle_t xStreamBuffer,
+                                     const StreamBufferVector_t * pxVectors,
+                                     UBaseType_t uxVectorCount,
+                                     TickType_t xTicksToWait ) FREERTOS_SYSTEM_CALL;
+size_t MPU_xStreamBufferReceiveVectors( StreamBufferHandle_t xStreamBuffer,
+                                        const StreamBufferVector_t * pxVectors,
+                                        UBaseType_t uxVectorCount,
+                                        TickType_t xTicksToWait ) FREERTOS_SYSTEM_CALL;
+size_t MPU_xStreamBufferGetWritableSpans( StreamBufferHandle_t xStreamBuffer,
+                                          StreamBufferVector_t pxSpans[ 2 ],
+                                          size_t xBytesWanted,
+                                          TickType_t xTicksToWait ) FREERTOS_SYSTEM_CALL;
+void MPU_vStreamBufferProduce( StreamBufferHandle_t xStreamBuffer,
+                               size_t xBytesWritten ) FREERTOS_SYSTEM_CALL;
+size_t MPU_xStreamBufferGetReadableSpans( StreamBufferHandle_t xStreamBuffer,
+                                          StreamBufferVector_t pxSpans[ 2 ],
+                                          size_t xBytesWanted,
+                                          TickType_t xTicksToWait ) FREERTOS_SYSTEM_CALL;
+void MPU_vStreamBufferConsume( StreamBufferHandle_t xStreamBuffer,
+                               size_t xBytesRead ) FREERTOS_SYSTEM_CALL;
 size_t MPU_xStreamBufferNextMessageLengthBytes( StreamBufferHandle_t xStreamBuffer ) FREERTOS_SYSTEM_CALL;
 void MPU_vStreamBufferDelete( StreamBufferHandle_t xStreamBuffer ) FREERTOS_SYSTEM_CALL;
 BaseType_t MPU_xStreamBufferIsFull( StreamBufferHandle_t xStreamBuffer ) FREERTOS_SYSTEM_CALL;
@@ -90,6 +90,14 @@
 /* Map standard queue.h API functions to the MPU equivalents. */
         #define xQueueGenericSend                      MPU_xQueueGenericSend
         #define xQueueReceive                          MPU_xQueueReceive
+        #define xQueueSendMultiple                     MPU_xQueueSendMultiple
+        #define xQueueReceiveMultiple                  MPU_xQueueReceiveMultiple
+        #define xQueueReserveSend                      MPU_xQueueReserveSend
+        #define xQueueCommitSend                       MPU_xQueueCommitSend
+        #define xQueueAbortSend                        MPU_xQueueAbortSend
+        #define xQueuePeekAcquire                      MPU_xQueuePeekAcquire
+        #define xQueueReleaseReceive                   MPU_xQueueReleaseReceive
+        #define xQueueAbortReceive                     MPU_xQueueAbortReceive
         #define xQueuePeek                             MPU_xQueuePeek
         #define xQueueSemaphoreTake                    MPU_xQueueSemaphoreTake
         #define uxQueueMessagesWaiting                 MPU_uxQueueMessagesWaiting
@@ -144,6 +152,12 @@
  * equivalents. */
         #define xStreamBufferSend                      MPU_xStreamBufferSend
         #define xStreamBufferReceive                   MPU_xStreamBufferReceive
+        #define xStreamBufferSendVectors               MPU_xStreamBufferSendVectors
+        #define xStreamBufferReceiveVectors            MPU_xStreamBufferReceiveVectors
+        #define xStreamBufferGetWritableSpans          MPU_xStreamBufferGetWritableSpans
+        #define vStreamBufferProduce                   MPU_vStreamBufferProduce
+        #define xStreamBufferGetReadableSpans          MPU_xStreamBufferGetReadableSpans
+        #define vStreamBufferConsume                   MPU_vStreamBufferConsume
         #define xStreamBufferNextMessageLengthBytes    MPU_xStreamBufferNextMessageLengthBytes
         #define vStreamBufferDelete                    MPU_vStreamBufferDelete
         #define xStreamBufferIsFull                    MPU_xStreamBufferIsFull
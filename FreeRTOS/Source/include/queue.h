@@ -883,6 +883,243 @@ BaseType_t xQueueReceive( QueueHandle_t xQueue,
                           void * const pvBuffer,
                           TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * <pre>
+ * BaseType_t xQueueSendMultiple(
+ *                                QueueHandle_t xQueue,
+ *                                const void *pvItemsToQueue,
+ *                                UBaseType_t uxItemsToQueue,
+ *                                TickType_t xTicksToWait
+ *                           );
+ * </pre>
+ *
+ * Post up to uxItemsToQueue items, stored one after the other at
+ * pvItemsToQueue, to the back of a queue.  As many items as there is space
+ * for are copied under one critical section, with at most two memcpy() calls,
+ * and up to one task waiting to receive is unblocked per item copied.  This
+ * costs a lot less than posting the items one at a time with xQueueSend().
+ *
+ * The items are posted as soon as there is space for at least one of them,
+ * so fewer than uxItemsToQueue may be posted.  The function cannot be used
+ * with semaphores or mutexes.
+ *
+ * This function must not be called from an interrupt service routine.
+ * See xQueueSendMultipleFromISR() for an alternative which may be used
+ * in an ISR.
+ *
+ * @param xQueue The handle to the queue on which the items are to be posted.
+ *
+ * @param pvItemsToQueue A pointer to the items that are to be placed on the
+ * queue.  Each item has the size defined when the queue was created.
+ *
+ * @param uxItemsToQueue The number of items at pvItemsToQueue.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for space to become available on the queue, should it already
+ * be full.  The call will return immediately if this is set to 0 and the
+ * queue is full.
+ *
+ * @return The number of items posted, which is 0 if the queue stayed full
+ * for xTicksToWait ticks.
+ *
+ * Example usage:
+ * <pre>
+ * void vAProducerTask( void *pvParameters )
+ * {
+ * uint16_t usSamples[ 100 ];
+ * BaseType_t xSent, xTotal;
+ *
+ *  for( ;; )
+ *  {
+ *      // Fill usSamples, then post them all to a queue created with
+ *      // xQueueCreate( 200, sizeof( uint16_t ) ).
+ *      for( xTotal = 0; xTotal < 100; xTotal += xSent )
+ *      {
+ *          xSent = xQueueSendMultiple( xQueue, &( usSamples[ xTotal ] ), 100 - xTotal, portMAX_DELAY );
+ *      }
+ *  }
+ * }
+ * </pre>
+ * \defgroup xQueueSendMultiple xQueueSendMultiple
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueSendMultiple( QueueHandle_t xQueue,
+                               const void * const pvItemsToQueue,
+                               const UBaseType_t uxItemsToQueue,
+                               TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ * BaseType_t xQueueReceiveMultiple(
+ *                                   QueueHandle_t xQueue,
+ *                                   void *pvBuffer,
+ *                                   UBaseType_t uxMaxItems,
+ *                                   TickType_t xTicksToWait
+ *                              );
+ * </pre>
+ *
+ * Receive up to uxMaxItems items from a queue, in the order they were
+ * posted, into the buffer pvBuffer.  The items available are copied under
+ * one critical section, with at most two memcpy() calls, and up to one task
+ * waiting to post is unblocked per item received.  The function cannot be
+ * used with semaphores or mutexes.
+ *
+ * This function must not be used in an interrupt service routine.  See
+ * xQueueReceiveMultipleFromISR for an alternative that can.
+ *
+ * @param xQueue The handle to the queue from which the items are to be
+ * received.
+ *
+ * @param pvBuffer Pointer to the buffer into which the received items will
+ * be copied, one after the other.  It must have room for uxMaxItems items.
+ *
+ * @param uxMaxItems The maximum number of items to receive.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item to receive should the queue be empty at the time
+ * of the call.  The call will return as soon as at least one item has been
+ * received.
+ *
+ * @return The number of items received, which is 0 if the queue stayed
+ * empty for xTicksToWait ticks.
+ *
+ * \defgroup xQueueReceiveMultiple xQueueReceiveMultiple
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue,
+                                  void * const pvBuffer,
+                                  const UBaseType_t uxMaxItems,
+                                  TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ * BaseType_t xQueueReserveSend(
+ *                               QueueHandle_t xQueue,
+ *                               void **ppvItem,
+ *                               TickType_t xTicksToWait
+ *                          );
+ * BaseType_t xQueueCommitSend( QueueHandle_t xQueue );
+ * BaseType_t xQueueAbortSend( QueueHandle_t xQueue );
+ * </pre>
+ *
+ * Post an item to the back of a queue without copying it.
+ * xQueueReserveSend() hands out the free slot in the queue storage the
+ * item would otherwise be copied to.  The item is written there, then
+ * xQueueCommitSend() posts it, or xQueueAbortSend() gives the slot back
+ * without posting anything.  Posting large items this way saves copying
+ * them from a buffer of the sender.
+ *
+ * The slot is reserved until it is committed or aborted, so there is at most
+ * one reserved slot per queue.  Other tasks trying to post to the queue block as
+ * if it was full, and xQueueSendFromISR() fails, until then.  Committing
+ * unblocks the task waiting to receive, or notifies the queue set the queue
+ * is a member of, exactly as xQueueSend() does.
+ *
+ * configUSE_QUEUE_IN_PLACE must be set to 1 in FreeRTOSConfig.h for these
+ * functions to be available.  They cannot be used with semaphores or
+ * mutexes, or from an interrupt service routine, and the queue must not be
+ * posted to with xQueueSendToFront() or xQueueOverwrite() while a slot is
+ * reserved.
+ *
+ * @param xQueue The handle to the queue on which the item is to be posted.
+ *
+ * @param ppvItem Set to the reserved slot, of the item size defined when the
+ * queue was created.  The slot must not be accessed once committed or
+ * aborted.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for a free slot, should the queue be full or a slot be reserved
+ * already.  The call will return immediately if this is set to 0.
+ *
+ * @return xQueueReserveSend() returns pdTRUE if a slot was reserved,
+ * otherwise errQUEUE_FULL.  xQueueCommitSend() returns pdPASS if the item
+ * was posted, and xQueueAbortSend() pdPASS if the slot was given back, or
+ * both pdFAIL if no slot was reserved.
+ *
+ * Example usage:
+ * <pre>
+ * void vAProducerTask( void *pvParameters )
+ * {
+ * Frame_t *pxFrame;
+ *
+ *  for( ;; )
+ *  {
+ *      // Fill the frame in the storage of a queue created with
+ *      // xQueueCreate( 4, sizeof( Frame_t ) ), then post it.
+ *      if( xQueueReserveSend( xQueue, ( void ** ) &pxFrame, portMAX_DELAY ) == pdTRUE )
+ *      {
+ *          vFillFrame( pxFrame );
+ *          xQueueCommitSend( xQueue );
+ *      }
+ *  }
+ * }
+ * </pre>
+ * \defgroup xQueueReserveSend xQueueReserveSend
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueReserveSend( QueueHandle_t xQueue,
+                              void ** const ppvItem,
+                              TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+BaseType_t xQueueCommitSend( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+BaseType_t xQueueAbortSend( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ * BaseType_t xQueuePeekAcquire(
+ *                               QueueHandle_t xQueue,
+ *                               void **ppvItem,
+ *                               TickType_t xTicksToWait
+ *                          );
+ * BaseType_t xQueueReleaseReceive( QueueHandle_t xQueue );
+ * BaseType_t xQueueAbortReceive( QueueHandle_t xQueue );
+ * </pre>
+ *
+ * Receive an item from a queue without copying it.  xQueuePeekAcquire()
+ * hands out the item at the head of the queue where it is stored.  The item
+ * is read there, then xQueueReleaseReceive() removes it from the queue, or
+ * xQueueAbortReceive() leaves it at the head for the next receiver.
+ *
+ * The item is acquired until it is released or aborted, so at most one item
+ * per queue is acquired.  Other tasks trying to receive from the queue block as
+ * if it was empty, and xQueueReceiveFromISR() fails, until then.  Releasing
+ * unblocks the task waiting to post, exactly as xQueueReceive() does.  A
+ * queue that is a member of a queue set can be read in place once
+ * xQueueSelectFromSet() has returned its handle.
+ *
+ * configUSE_QUEUE_IN_PLACE must be set to 1 in FreeRTOSConfig.h for these
+ * functions to be available.  They cannot be used with semaphores or
+ * mutexes, or from an interrupt service routine, and the queue must not be
+ * posted to with xQueueSendToFront() or xQueueOverwrite() while an item is
+ * acquired.
+ *
+ * @param xQueue The handle to the queue from which the item is to be
+ * received.
+ *
+ * @param ppvItem Set to the acquired item.  The item must not be accessed
+ * once released or aborted.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item, should the queue be empty or an item be acquired
+ * already.  The call will return immediately if this is set to 0.
+ *
+ * @return xQueuePeekAcquire() returns pdTRUE if an item was acquired,
+ * otherwise errQUEUE_EMPTY.  xQueueReleaseReceive() returns pdPASS if the
+ * item was removed, and xQueueAbortReceive() pdPASS if it was left in the
+ * queue, or both pdFAIL if no item was acquired.
+ *
+ * \defgroup xQueuePeekAcquire xQueuePeekAcquire
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueuePeekAcquire( QueueHandle_t xQueue,
+                              void ** const ppvItem,
+                              TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+BaseType_t xQueueReleaseReceive( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+BaseType_t xQueueAbortReceive( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+
 /**
  * queue. h
  * <pre>
@@ -1416,6 +1653,39 @@ BaseType_t xQueueReceiveFromISR( QueueHandle_t xQueue,
                                  void * const pvBuffer,
                                  BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * <pre>
+ * BaseType_t xQueueSendMultipleFromISR(
+ *                                       QueueHandle_t xQueue,
+ *                                       const void *pvItemsToQueue,
+ *                                       UBaseType_t uxItemsToQueue,
+ *                                       BaseType_t *pxHigherPriorityTaskWoken
+ *                                  );
+ * </pre>
+ *
+ * Versions of xQueueSendMultiple() and xQueueReceiveMultiple() that can be
+ * used in an interrupt service routine.  They do not block, and return the
+ * number of items posted or received, which is 0 if the queue was full or
+ * empty.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if moving the items
+ * unblocked a task with a priority higher than the currently running task,
+ * in which case a context switch should be requested before the interrupt
+ * is exited.
+ *
+ * \defgroup xQueueSendMultipleFromISR xQueueSendMultipleFromISR
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueSendMultipleFromISR( QueueHandle_t xQueue,
+                                      const void * const pvItemsToQueue,
+                                      const UBaseType_t uxItemsToQueue,
+                                      BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+BaseType_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue,
+                                         void * const pvBuffer,
+                                         const UBaseType_t uxMaxItems,
+                                         BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
 /*
  * Utilities to query queues that are safe to use from an ISR.  These utilities
  * should be used only from witin an ISR, or within a critical section.
@@ -69,6 +69,18 @@
 struct StreamBufferDef_t;
 typedef struct StreamBufferDef_t * StreamBufferHandle_t;
 
+/**
+ * A run of bytes.  Either one of the caller's buffers passed to
+ * xStreamBufferSendVectors() or xStreamBufferReceiveVectors(), or a span of
+ * the stream buffer's own storage returned by xStreamBufferGetWritableSpans()
+ * or xStreamBufferGetReadableSpans().
+ */
+typedef struct xSTREAM_BUFFER_VECTOR
+{
+    void * pvData;  /* Start of the bytes. */
+    size_t xLength; /* Number of bytes. */
+} StreamBufferVector_t;
+
 
 /**
  * message_buffer.h
@@ -316,6 +328,44 @@ size_t xStreamBufferSend( StreamBufferHandle_t xStreamBuffer,
                           size_t xDataLengthBytes,
                           TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+ * <pre>
+ * size_t xStreamBufferSendVectors( StreamBufferHandle_t xStreamBuffer,
+ *                               const StreamBufferVector_t *pxVectors,
+ *                               UBaseType_t uxVectorCount,
+ *                               TickType_t xTicksToWait );
+ * </pre>
+ *
+ * Version of xStreamBufferSend() that gathers the bytes to send from several
+ * buffers, so data held in pieces, such as a header and a payload, does not
+ * have to be assembled into one buffer first.  The bytes of pxVectors[ 0 ] are
+ * sent first, then those of pxVectors[ 1 ], and so on.  Sent to a message
+ * buffer, the bytes of all the vectors form a single message.  The vectors
+ * are only read, although StreamBufferVector_t::pvData is not const.
+ *
+ * @param xStreamBuffer The handle of the stream buffer to which data is being
+ * sent.
+ *
+ * @param pxVectors An array of uxVectorCount vectors, each describing a buffer
+ * holding bytes to send.  A vector may have a length of 0.
+ *
+ * @param uxVectorCount The number of vectors in pxVectors.
+ *
+ * @param xTicksToWait As for xStreamBufferSend(), with the data length being
+ * the total length of the vectors.
+ *
+ * @return As for xStreamBufferSend().
+ *
+ * \defgroup xStreamBufferSendVectors xStreamBufferSendVectors
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendVectors( StreamBufferHandle_t xStreamBuffer,
+                                 const StreamBufferVector_t * pxVectors,
+                                 UBaseType_t uxVectorCount,
+                                 TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
 /**
  * stream_buffer.h
  *
@@ -417,6 +467,59 @@ size_t xStreamBufferSendFromISR( StreamBufferHandle_t xStreamBuffer,
                                  size_t xDataLengthBytes,
                                  BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+ * <pre>
+ * size_t xStreamBufferSendLockFree( StreamBufferHandle_t xStreamBuffer,
+ *                                const void *pvTxData,
+ *                                size_t xDataLengthBytes,
+ *                                BaseType_t *pxTaskWaiting );
+ * </pre>
+ *
+ * For advanced users only.
+ *
+ * configUSE_LOCK_FREE_STREAM_BUFFERS must be set to 1 in FreeRTOSConfig.h for
+ * xStreamBufferSendLockFree() to be available.  The head and tail of every
+ * stream buffer are then published with release semantics and read with
+ * acquire semantics, so the single writer and single reader never need a
+ * critical section to exchange data, and only enter one to notify a task that
+ * is blocked on the buffer.
+ *
+ * Version of xStreamBufferSendFromISR() for a writer that cannot call the
+ * FreeRTOS API at all, such as a thread of the host of a simulator port or
+ * code running on another core.  It neither masks interrupts nor notifies the
+ * reader.  Instead it sets *pxTaskWaiting to pdTRUE when the reader may be
+ * blocked waiting for the data sent, in which case the writer must arrange for
+ * xStreamBufferSendCompletedFromISR() to be called, typically by raising an
+ * interrupt whose handler calls it.
+ *
+ * The same rule of a single writer and a single reader applies.
+ *
+ * @param xStreamBuffer The handle of the stream buffer to which a stream is
+ * being sent.
+ *
+ * @param pvTxData A pointer to the data that is to be copied into the stream
+ * buffer.
+ *
+ * @param xDataLengthBytes The maximum number of bytes to copy from pvTxData
+ * into the stream buffer.
+ *
+ * @param pxTaskWaiting Set to pdTRUE if xStreamBufferSendCompletedFromISR()
+ * must be called to unblock the reader, otherwise set to pdFALSE.
+ *
+ * @return The number of bytes actually written to the stream buffer, which will
+ * be less than xDataLengthBytes if the stream buffer didn't have enough free
+ * space for all the bytes to be written.
+ *
+ * \defgroup xStreamBufferSendLockFree xStreamBufferSendLockFree
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendLockFree( StreamBufferHandle_t xStreamBuffer,
+                                  const void * pvTxData,
+                                  size_t xDataLengthBytes,
+                                  BaseType_t * const pxTaskWaiting ) PRIVILEGED_FUNCTION;
+
 /**
  * stream_buffer.h
  *
@@ -506,6 +609,42 @@ size_t xStreamBufferReceive( StreamBufferHandle_t xStreamBuffer,
                              size_t xBufferLengthBytes,
                              TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+ * <pre>
+ * size_t xStreamBufferReceiveVectors( StreamBufferHandle_t xStreamBuffer,
+ *                                  const StreamBufferVector_t *pxVectors,
+ *                                  UBaseType_t uxVectorCount,
+ *                                  TickType_t xTicksToWait );
+ * </pre>
+ *
+ * Version of xStreamBufferReceive() that scatters the bytes received across
+ * several buffers.  pxVectors[ 0 ] is filled first, then pxVectors[ 1 ], and
+ * so on, so, for example, a fixed size header can be received into one
+ * structure and the rest of the data into another.
+ *
+ * @param xStreamBuffer The handle of the stream buffer from which bytes are to
+ * be received.
+ *
+ * @param pxVectors An array of uxVectorCount vectors, each describing a buffer
+ * into which bytes are received.  A vector may have a length of 0.
+ *
+ * @param uxVectorCount The number of vectors in pxVectors.
+ *
+ * @param xTicksToWait As for xStreamBufferReceive(), with the buffer length
+ * being the total length of the vectors.
+ *
+ * @return As for xStreamBufferReceive().
+ *
+ * \defgroup xStreamBufferReceiveVectors xStreamBufferReceiveVectors
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveVectors( StreamBufferHandle_t xStreamBuffer,
+                                    const StreamBufferVector_t * pxVectors,
+                                    UBaseType_t uxVectorCount,
+                                    TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
 /**
  * stream_buffer.h
  *
@@ -592,6 +731,49 @@ size_t xStreamBufferReceiveFromISR( StreamBufferHandle_t xStreamBuffer,
                                     size_t xBufferLengthBytes,
                                     BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+ * <pre>
+ * size_t xStreamBufferReceiveLockFree( StreamBufferHandle_t xStreamBuffer,
+ *                                   void *pvRxData,
+ *                                   size_t xBufferLengthBytes,
+ *                                   BaseType_t *pxTaskWaiting );
+ * </pre>
+ *
+ * For advanced users only.
+ *
+ * Version of xStreamBufferReceiveFromISR() for a reader that cannot call the
+ * FreeRTOS API at all, available when configUSE_LOCK_FREE_STREAM_BUFFERS is
+ * set to 1 in FreeRTOSConfig.h.  See xStreamBufferSendLockFree().  It sets
+ * *pxTaskWaiting to pdTRUE when the writer may be blocked waiting for the
+ * space freed, in which case the reader must arrange for
+ * xStreamBufferReceiveCompletedFromISR() to be called.
+ *
+ * @param xStreamBuffer The handle of the stream buffer from which bytes are to
+ * be received.
+ *
+ * @param pvRxData A pointer to the buffer into which the received bytes are
+ * copied.
+ *
+ * @param xBufferLengthBytes The length of the buffer pointed to by the
+ * pvRxData parameter.  This sets the maximum number of bytes to receive in one
+ * call.
+ *
+ * @param pxTaskWaiting Set to pdTRUE if
+ * xStreamBufferReceiveCompletedFromISR() must be called to unblock the writer,
+ * otherwise set to pdFALSE.
+ *
+ * @return The number of bytes read from the stream buffer, if any.
+ *
+ * \defgroup xStreamBufferReceiveLockFree xStreamBufferReceiveLockFree
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveLockFree( StreamBufferHandle_t xStreamBuffer,
+                                     void * pvRxData,
+                                     size_t xBufferLengthBytes,
+                                     BaseType_t * const pxTaskWaiting ) PRIVILEGED_FUNCTION;
+
 /**
  * stream_buffer.h
  *
@@ -838,7 +1020,150 @@ BaseType_t xStreamBufferSendCompletedFromISR( StreamBufferHandle_t xStreamBuffer
 BaseType_t xStreamBufferReceiveCompletedFromISR( StreamBufferHandle_t xStreamBuffer,
                                                  BaseType_t * pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+ * <pre>
+ * size_t xStreamBufferGetWritableSpans( StreamBufferHandle_t xStreamBuffer,
+ *                                    StreamBufferVector_t pxSpans[ 2 ],
+ *                                    size_t xBytesWanted,
+ *                                    TickType_t xTicksToWait );
+ * void vStreamBufferProduce( StreamBufferHandle_t xStreamBuffer,
+ *                            size_t xBytesWritten );
+ * void vStreamBufferProduceFromISR( StreamBufferHandle_t xStreamBuffer,
+ *                                   size_t xBytesWritten,
+ *                                   BaseType_t *pxHigherPriorityTaskWoken );
+ * </pre>
+ *
+ * Lets the writer of a stream buffer write data straight into the buffer's
+ * storage, rather than into a buffer of its own that xStreamBufferSend() then
+ * copies.  Cannot be used with message buffers.
+ *
+ * xStreamBufferGetWritableSpans() describes the free space in the storage as
+ * two spans, the second being the part that wraps around to the start of the
+ * storage, and of length 0 if there is none.  The writer writes to the start
+ * of the spans, in order, then calls vStreamBufferProduce() to send the bytes
+ * written, which unblocks a reader waiting for them.  Nothing is sent until
+ * vStreamBufferProduce() is called, and bytes written but not produced are
+ * overwritten by the next write.  vStreamBufferProduceFromISR() is the version
+ * an interrupt uses, after calling xStreamBufferGetWritableSpans() with
+ * xTicksToWait set to 0.
+ *
+ * @param xStreamBuffer The handle of the stream buffer being written.
+ *
+ * @param pxSpans An array of two vectors set to the spans.
+ *
+ * @param xBytesWanted The free space, in bytes, the writer is prepared to wait
+ * for.  Values larger than the buffer are treated as the size of the buffer.
+ *
+ * @param xTicksToWait The maximum amount of time the calling task should remain
+ * in the Blocked state to wait for xBytesWanted bytes of free space.
+ *
+ * @param xBytesWritten The number of bytes written to the spans.  Must not be
+ * more than the spans returned hold.
+ *
+ * @param pxHigherPriorityTaskWoken As for xStreamBufferSendFromISR().
+ *
+ * @return xStreamBufferGetWritableSpans() returns the total length of the
+ * spans, which can be less than xBytesWanted if the wait timed out.
+ *
+ * Example use:
+ * <pre>
+ * void vAFunction( StreamBufferHandle_t xStreamBuffer )
+ * {
+ * StreamBufferVector_t xSpans[ 2 ];
+ *
+ *  // Format a record straight into the stream buffer.
+ *  if( xStreamBufferGetWritableSpans( xStreamBuffer, xSpans, RECORD_LENGTH, portMAX_DELAY ) >= RECORD_LENGTH )
+ *  {
+ *      vFormatRecord( xSpans );
+ *      vStreamBufferProduce( xStreamBuffer, RECORD_LENGTH );
+ *  }
+ * }
+ * </pre>
+ * \defgroup xStreamBufferGetWritableSpans xStreamBufferGetWritableSpans
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferGetWritableSpans( StreamBufferHandle_t xStreamBuffer,
+                                      StreamBufferVector_t pxSpans[ 2 ],
+                                      size_t xBytesWanted,
+                                      TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+void vStreamBufferProduce( StreamBufferHandle_t xStreamBuffer,
+                           size_t xBytesWritten ) PRIVILEGED_FUNCTION;
+void vStreamBufferProduceFromISR( StreamBufferHandle_t xStreamBuffer,
+                                  size_t xBytesWritten,
+                                  BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * <pre>
+ * size_t xStreamBufferGetReadableSpans( StreamBufferHandle_t xStreamBuffer,
+ *                                    StreamBufferVector_t pxSpans[ 2 ],
+ *                                    size_t xBytesWanted,
+ *                                    TickType_t xTicksToWait );
+ * void vStreamBufferConsume( StreamBufferHandle_t xStreamBuffer,
+ *                            size_t xBytesRead );
+ * void vStreamBufferConsumeFromISR( StreamBufferHandle_t xStreamBuffer,
+ *                                   size_t xBytesRead,
+ *                                   BaseType_t *pxHigherPriorityTaskWoken );
+ * </pre>
+ *
+ * Lets the reader of a stream buffer parse data in the buffer's storage,
+ * rather than have xStreamBufferReceive() copy it out first.  Cannot be used
+ * with message buffers.
+ *
+ * xStreamBufferGetReadableSpans() describes the bytes in the buffer as two
+ * spans, the second being the part that wraps around to the start of the
+ * storage, and of length 0 if there is none.  The bytes stay in the buffer,
+ * and can be looked at again, until vStreamBufferConsume() removes the first
+ * xBytesRead of them, which unblocks a writer waiting for space.  A reader that
+ * needs more bytes, such as the rest of a partly received packet, can consume
+ * none and call xStreamBufferGetReadableSpans() again with a larger
+ * xBytesWanted.  vStreamBufferConsumeFromISR() is the version an interrupt
+ * uses, after calling xStreamBufferGetReadableSpans() with xTicksToWait set
+ * to 0.
+ *
+ * @param xStreamBuffer The handle of the stream buffer being read.
+ *
+ * @param pxSpans An array of two vectors set to the spans.
+ *
+ * @param xBytesWanted The number of bytes the reader is prepared to wait for.
+ * Values of 0 are treated as 1, and values larger than the buffer as the size
+ * of the buffer.
+ *
+ * @param xTicksToWait The maximum amount of time the calling task should remain
+ * in the Blocked state to wait for xBytesWanted bytes.  As with
+ * xStreamBufferReceive(), a waiting task is unblocked when the trigger level
+ * is reached, so set the trigger level to xBytesWanted to wait for all of
+ * them at once.
+ *
+ * @param xBytesRead The number of bytes to remove from the buffer.  Must not be
+ * more than the spans returned hold.
+ *
+ * @param pxHigherPriorityTaskWoken As for xStreamBufferReceiveFromISR().
+ *
+ * @return xStreamBufferGetReadableSpans() returns the total length of the
+ * spans, which can be less than xBytesWanted.
+ *
+ * \defgroup xStreamBufferGetReadableSpans xStreamBufferGetReadableSpans
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferGetReadableSpans( StreamBufferHandle_t xStreamBuffer,
+                                      StreamBufferVector_t pxSpans[ 2 ],
+                                      size_t xBytesWanted,
+                                      TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+void vStreamBufferConsume( StreamBufferHandle_t xStreamBuffer,
+                           size_t xBytesRead ) PRIVILEGED_FUNCTION;
+void vStreamBufferConsumeFromISR( StreamBufferHandle_t xStreamBuffer,
+                                  size_t xBytesRead,
+                                  BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
 /* Functions below here are not part of the public API. */
+
+/* Value of xIsMessageBuffer that creates a shared message buffer. */
+#define sbTYPE_SHARED_MESSAGE_BUFFER    ( ( BaseType_t ) 2 )
+
 StreamBufferHandle_t xStreamBufferGenericCreate( size_t xBufferSizeBytes,
                                                  size_t xTriggerLevelBytes,
                                                  BaseType_t xIsMessageBuffer ) PRIVILEGED_FUNCTION;
@@ -208,3 +208,85 @@ UBaseType_t uxListRemove( ListItem_t * const pxItemToRemove )
     return pxList->uxNumberOfItems;
 }
 /*-----------------------------------------------------------*/
+
+#if ( configUSE_PRIORITY_EVENT_LISTS == 1 )
+
+    void vListInitialiseEventList( EventList_t * const pxEventList )
+    {
+        UBaseType_t uxPriority;
+        UBaseType_t uxWord;
+
+        /* uxTopPriorities has a bit per word of the bitmap. */
+        configASSERT( listEVENT_LIST_WORDS <= listEVENT_LIST_BITS );
+
+        for( uxPriority = ( UBaseType_t ) 0U; uxPriority < ( UBaseType_t ) configMAX_PRIORITIES; uxPriority++ )
+        {
+            vListInitialise( &( pxEventList->xLists[ uxPriority ] ) );
+        }
+
+        for( uxWord = ( UBaseType_t ) 0U; uxWord < ( UBaseType_t ) listEVENT_LIST_WORDS; uxWord++ )
+        {
+            pxEventList->uxPriorities[ uxWord ] = ( UBaseType_t ) 0U;
+        }
+
+        pxEventList->uxTopPriorities = ( UBaseType_t ) 0U;
+    }
+/*-----------------------------------------------------------*/
+
+    void vListInsertEventList( EventList_t * const pxEventList,
+                               ListItem_t * const pxNewListItem,
+                               UBaseType_t uxPriority )
+    {
+        configASSERT( uxPriority < ( UBaseType_t ) configMAX_PRIORITIES );
+
+        /* The index of an event list is never moved from the list end, so
+         * vListInsertEnd() places the item after the items of the same priority,
+         * where vListInsert() would have placed it. */
+        vListInsertEnd( &( pxEventList->xLists[ uxPriority ] ), pxNewListItem );
+        pxEventList->uxPriorities[ uxPriority / listEVENT_LIST_BITS ] |= listEVENT_LIST_BIT( uxPriority % listEVENT_LIST_BITS );
+        pxEventList->uxTopPriorities |= listEVENT_LIST_BIT( uxPriority / listEVENT_LIST_BITS );
+    }
+/*-----------------------------------------------------------*/
+
+    List_t * pxListGetEventListHead( const EventList_t * const pxEventList )
+    {
+        /* Only forgets the priorities found empty.  The event list is only
+         * accessed from critical sections, or with its queue locked and the
+         * scheduler suspended, so this does not race with
+         * vListInsertEventList(). */
+        EventList_t * const pxList = ( EventList_t * ) pxEventList; /*lint !e9005 The event list is not const, only this function does not change its tasks. */
+        UBaseType_t uxWord;
+        UBaseType_t uxPriority;
+        List_t * pxReturn = NULL;
+
+        while( pxList->uxTopPriorities != ( UBaseType_t ) 0U )
+        {
+            uxWord = listEVENT_LIST_TOP( pxList->uxTopPriorities );
+            uxPriority = ( uxWord * listEVENT_LIST_BITS ) + listEVENT_LIST_TOP( pxList->uxPriorities[ uxWord ] );
+
+            if( listLIST_IS_EMPTY( &( pxList->xLists[ uxPriority ] ) ) == pdFALSE )
+            {
+                pxReturn = &( pxList->xLists[ uxPriority ] );
+                break;
+            }
+            else
+            {
+                /* The tasks of this priority timed out or were deleted. */
+                pxList->uxPriorities[ uxWord ] &= ~listEVENT_LIST_BIT( uxPriority % listEVENT_LIST_BITS );
+
+                if( pxList->uxPriorities[ uxWord ] == ( UBaseType_t ) 0U )
+                {
+                    pxList->uxTopPriorities &= ~listEVENT_LIST_BIT( uxWord );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        }
+
+        return pxReturn;
+    }
+
+#endif /* configUSE_PRIORITY_EVENT_LISTS */
+/*-----------------------------------------------------------*/
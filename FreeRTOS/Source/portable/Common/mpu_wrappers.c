@@ -695,6 +695,116 @@ BaseType_t MPU_xQueueReceive( QueueHandle_t pxQueue,
 }
 /*-----------------------------------------------------------*/
 
+BaseType_t MPU_xQueueSendMultiple( QueueHandle_t xQueue,
+                                   const void * const pvItemsToQueue,
+                                   const UBaseType_t uxItemsToQueue,
+                                   TickType_t xTicksToWait ) /* FREERTOS_SYSTEM_CALL */
+{
+    BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+    BaseType_t xReturn;
+
+    xReturn = xQueueSendMultiple( xQueue, pvItemsToQueue, uxItemsToQueue, xTicksToWait );
+    vPortResetPrivilege( xRunningPrivileged );
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t MPU_xQueueReceiveMultiple( QueueHandle_t xQueue,
+                                      void * const pvBuffer,
+                                      const UBaseType_t uxMaxItems,
+                                      TickType_t xTicksToWait ) /* FREERTOS_SYSTEM_CALL */
+{
+    BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+    BaseType_t xReturn;
+
+    xReturn = xQueueReceiveMultiple( xQueue, pvBuffer, uxMaxItems, xTicksToWait );
+    vPortResetPrivilege( xRunningPrivileged );
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_IN_PLACE == 1 )
+    BaseType_t MPU_xQueueReserveSend( QueueHandle_t xQueue,
+                                      void ** const ppvItem,
+                                      TickType_t xTicksToWait ) /* FREERTOS_SYSTEM_CALL */
+    {
+        BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+        BaseType_t xReturn;
+
+        xReturn = xQueueReserveSend( xQueue, ppvItem, xTicksToWait );
+        vPortResetPrivilege( xRunningPrivileged );
+        return xReturn;
+    }
+#endif /* if ( configUSE_QUEUE_IN_PLACE == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_IN_PLACE == 1 )
+    BaseType_t MPU_xQueueCommitSend( QueueHandle_t xQueue ) /* FREERTOS_SYSTEM_CALL */
+    {
+        BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+        BaseType_t xReturn;
+
+        xReturn = xQueueCommitSend( xQueue );
+        vPortResetPrivilege( xRunningPrivileged );
+        return xReturn;
+    }
+#endif /* if ( configUSE_QUEUE_IN_PLACE == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_IN_PLACE == 1 )
+    BaseType_t MPU_xQueueAbortSend( QueueHandle_t xQueue ) /* FREERTOS_SYSTEM_CALL */
+    {
+        BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+        BaseType_t xReturn;
+
+        xReturn = xQueueAbortSend( xQueue );
+        vPortResetPrivilege( xRunningPrivileged );
+        return xReturn;
+    }
+#endif /* if ( configUSE_QUEUE_IN_PLACE == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_IN_PLACE == 1 )
+    BaseType_t MPU_xQueuePeekAcquire( QueueHandle_t xQueue,
+                                      void ** const ppvItem,
+                                      TickType_t xTicksToWait ) /* FREERTOS_SYSTEM_CALL */
+    {
+        BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+        BaseType_t xReturn;
+
+        xReturn = xQueuePeekAcquire( xQueue, ppvItem, xTicksToWait );
+        vPortResetPrivilege( xRunningPrivileged );
+        return xReturn;
+    }
+#endif /* if ( configUSE_QUEUE_IN_PLACE == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_IN_PLACE == 1 )
+    BaseType_t MPU_xQueueReleaseReceive( QueueHandle_t xQueue ) /* FREERTOS_SYSTEM_CALL */
+    {
+        BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+        BaseType_t xReturn;
+
+        xReturn = xQueueReleaseReceive( xQueue );
+        vPortResetPrivilege( xRunningPrivileged );
+        return xReturn;
+    }
+#endif /* if ( configUSE_QUEUE_IN_PLACE == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_IN_PLACE == 1 )
+    BaseType_t MPU_xQueueAbortReceive( QueueHandle_t xQueue ) /* FREERTOS_SYSTEM_CALL */
+    {
+        BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+        BaseType_t xReturn;
+
+        xReturn = xQueueAbortReceive( xQueue );
+        vPortResetPrivilege( xRunningPrivileged );
+        return xReturn;
+    }
+#endif /* if ( configUSE_QUEUE_IN_PLACE == 1 ) */
+/*-----------------------------------------------------------*/
+
 BaseType_t MPU_xQueuePeek( QueueHandle_t xQueue,
                            void * const pvBuffer,
                            TickType_t xTicksToWait ) /* FREERTOS_SYSTEM_CALL */
@@ -1277,6 +1387,86 @@ size_t MPU_xStreamBufferReceive( StreamBufferHandle_t xStreamBuffer,
 }
 /*-----------------------------------------------------------*/
 
+size_t MPU_xStreamBufferSendVectors( StreamBufferHandle_t xStreamBuffer,
+                                     const StreamBufferVector_t * pxVectors,
+                                     UBaseType_t uxVectorCount,
+                                     TickType_t xTicksToWait ) /* FREERTOS_SYSTEM_CALL */
+{
+    size_t xReturn;
+    BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+
+    xReturn = xStreamBufferSendVectors( xStreamBuffer, pxVectors, uxVectorCount, xTicksToWait );
+    vPortResetPrivilege( xRunningPrivileged );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t MPU_xStreamBufferReceiveVectors( StreamBufferHandle_t xStreamBuffer,
+                                        const StreamBufferVector_t * pxVectors,
+                                        UBaseType_t uxVectorCount,
+                                        TickType_t xTicksToWait ) /* FREERTOS_SYSTEM_CALL */
+{
+    size_t xReturn;
+    BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+
+    xReturn = xStreamBufferReceiveVectors( xStreamBuffer, pxVectors, uxVectorCount, xTicksToWait );
+    vPortResetPrivilege( xRunningPrivileged );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t MPU_xStreamBufferGetWritableSpans( StreamBufferHandle_t xStreamBuffer,
+                                          StreamBufferVector_t pxSpans[ 2 ],
+                                          size_t xBytesWanted,
+                                          TickType_t xTicksToWait ) /* FREERTOS_SYSTEM_CALL */
+{
+    size_t xReturn;
+    BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+
+    xReturn = xStreamBufferGetWritableSpans( xStreamBuffer, pxSpans, xBytesWanted, xTicksToWait );
+    vPortResetPrivilege( xRunningPrivileged );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void MPU_vStreamBufferProduce( StreamBufferHandle_t xStreamBuffer,
+                               size_t xBytesWritten ) /* FREERTOS_SYSTEM_CALL */
+{
+    BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+
+    vStreamBufferProduce( xStreamBuffer, xBytesWritten );
+    vPortResetPrivilege( xRunningPrivileged );
+}
+/*-----------------------------------------------------------*/
+
+size_t MPU_xStreamBufferGetReadableSpans( StreamBufferHandle_t xStreamBuffer,
+                                          StreamBufferVector_t pxSpans[ 2 ],
+                                          size_t xBytesWanted,
+                                          TickType_t xTicksToWait ) /* FREERTOS_SYSTEM_CALL */
+{
+    size_t xReturn;
+    BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+
+    xReturn = xStreamBufferGetReadableSpans( xStreamBuffer, pxSpans, xBytesWanted, xTicksToWait );
+    vPortResetPrivilege( xRunningPrivileged );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void MPU_vStreamBufferConsume( StreamBufferHandle_t xStreamBuffer,
+                               size_t xBytesRead ) /* FREERTOS_SYSTEM_CALL */
+{
+    BaseType_t xRunningPrivileged = xPortRaisePrivilege();
+
+    vStreamBufferConsume( xStreamBuffer, xBytesRead );
+    vPortResetPrivilege( xRunningPrivileged );
+}
+/*-----------------------------------------------------------*/
+
 void MPU_vStreamBufferDelete( StreamBufferHandle_t xStreamBuffer ) /* FREERTOS_SYSTEM_CALL */
 {
     BaseType_t xRunningPrivileged = xPortRaisePrivilege();
@@ -31,13 +31,40 @@
  * (allowing backtraces of tasks etc). Threads for tasks that are not
  * running are blocked in sigwait().
  *
+ * With portUSE_THREAD_POOL the threads outlive their tasks: a thread is
+ * taken from a pool of parked threads when a task is created, and goes
+ * back to the pool when the task is deleted by jumping out of the task
+ * (siglongjmp()), rather than exiting.  Creating and deleting a task then
+ * costs no thread creation, cancellation or join.
+ *
  * Task switch is done by resuming the thread for the next task by
  * signaling the condition variable and then waiting on a condition variable
- * with the current thread.
+ * with the current thread.  On Linux the condition variables are replaced
+ * by a futex on one state word per thread (see portUSE_FUTEX_SWITCH), so a
+ * switch takes one atomic exchange and at most one wake system call.
  *
  * The timer interrupt uses SIGALRM and care is taken to ensure that
  * the signal handler runs only on the thread for the current task.
  *
+ * With portUSE_TICK_THREAD the tick comes instead from a host thread
+ * sleeping on absolute deadlines with clock_nanosleep(), which counts the
+ * ticks as pending and only signals the running thread (SIG_INTERRUPT,
+ * directed with tgkill()) when it is outside of a critical section.
+ * Critical sections then no longer mask signals: they set a flag, and
+ * leaving the last one runs whatever became pending in the meantime.
+ * The signal handler does nothing on a thread that is not running or
+ * that has the flag set.
+ *
+ * Other simulated interrupts are raised with SIG_INTERRUPT by
+ * vPortGenerateSimulatedInterrupt(), which may be called from host
+ * threads that are not FreeRTOS tasks.  The handler for every pending
+ * interrupt then runs on the thread for the current task, like the
+ * tick.
+ *
+ * Every thread of the simulator sets its own host scheduling policy and
+ * CPU affinity with vPortSetHostThreadPolicy() when it starts, a task
+ * thread every time it starts a task.
+ *
  * Use of part of the standard C library requires care as some
  * functions can take pthread mutexes internally which can result in
  * deadlocks as the FreeRTOS kernel can switch tasks while they're
@@ -48,6 +75,10 @@
  * semaphore or mutex.
  *----------------------------------------------------------*/
 
+#if defined( __linux__ ) && !defined( _GNU_SOURCE )
+    #define _GNU_SOURCE     /* For pthread_setaffinity_np(). */
+#endif
+
 #include <errno.h>
 #include <pthread.h>
 #include <signal.h>
@@ -57,15 +88,55 @@
 #include <sys/time.h>
 #include <sys/times.h>
 #include <time.h>
+#include <unistd.h>
 
 /* Scheduler includes. */
 #include "FreeRTOS.h"
 #include "task.h"
 #include "timers.h"
 #include "utils/wait_for_event.h"
+
+#if ( portUSE_FUTEX_SWITCH == 1 )
+    #include <linux/futex.h>
+#endif
+
+#if ( portUSE_FUTEX_SWITCH == 1 ) || ( portUSE_TICK_THREAD == 1 )
+    #include <sys/syscall.h>
+#endif
+
+#if ( portUSE_THREAD_POOL == 1 )
+    #include <setjmp.h>
+#endif
+
+#if ( configUSE_TICKLESS_IDLE == 1 ) && ( portUSE_TICK_THREAD == 0 )
+    #error configUSE_TICKLESS_IDLE requires portUSE_TICK_THREAD
+#endif
+
+#if ( portUSE_VIRTUAL_TIME == 1 ) && ( configUSE_TICKLESS_IDLE == 0 )
+    #error portUSE_VIRTUAL_TIME requires configUSE_TICKLESS_IDLE
+#endif
+
+/* Functions only run on the host cores when tasks take time. */
+#define portRUN_ON_HOST_CORES ( ( portHOST_CORES > 0 ) && ( portUSE_VIRTUAL_TIME == 0 ) )
+
+#if ( portRUN_ON_HOST_CORES == 1 ) && ( portHOST_CORE_INTERRUPT >= 32 )
+    #error portHOST_CORE_INTERRUPT must be a simulated interrupt number, 0 to 31
+#endif
+
+/* Whether the threads are scheduled other than the host does by default. */
+#define portHOST_THREADS_SCHEDULED ( ( portHOST_SCHED_POLICY != SCHED_OTHER ) ||                            \
+                                     ( ( portHOST_SCHEDULER_CPUS | portHOST_TICK_CPUS | portHOST_TASK_CPUS | \
+                                         portHOST_CORE_CPUS | portHOST_IO_CPUS ) != 0 ) )
+
+#if ( portHOST_THREADS_SCHEDULED == 1 ) && !defined( __linux__ )
+    #error The host scheduling options of the threads require Linux
+#endif
 /*-----------------------------------------------------------*/
 
 #define SIG_RESUME SIGUSR1
+#define SIG_INTERRUPT SIGUSR2
+
+#define portMAX_INTERRUPTS ( ( uint32_t ) sizeof( uint32_t ) * 8UL ) /* The number of bits in an uint32_t. */
 
 typedef struct THREAD
 {
@@ -73,18 +144,49 @@ typedef struct THREAD
     pdTASK_CODE pxCode;
     void *pvParams;
     BaseType_t xDying;
+#if ( portUSE_FUTEX_SWITCH == 1 )
+    uint32_t ulState;   /* One of the portTHREAD_ states below. */
+#else
     struct event *ev;
+#endif
+#if ( portUSE_TICK_THREAD == 1 )
+    pid_t xThreadId;    /* Kernel thread id, 0 until the thread has started. */
+#endif
+#if ( portUSE_THREAD_POOL == 1 )
+    sigjmp_buf xPoolContext;        /* Returned to when the task is deleted. */
+    volatile BaseType_t xInTask;    /* Set while in the task, guarded by xPoolMutex. */
+    volatile BaseType_t xCancel;    /* Set by vPortCancelThread() to leave the task. */
+    BaseType_t xExit;               /* Set to end a parked thread. */
+    struct THREAD *pxNextFree;
+#endif
 } Thread_t;
 
+#if ( portUSE_FUTEX_SWITCH == 1 )
+    /* Thread_t.ulState: the thread runs, or is about to wait. */
+    #define portTHREAD_RUNNING  0U
+    /* The thread has been resumed and has not consumed it yet. */
+    #define portTHREAD_RESUMED  1U
+    /* The thread waits on the futex and must be woken. */
+    #define portTHREAD_WAITING  2U
+#endif
+
+/* Longest sleep of vPortSuppressTicksAndSleep(), the idle task sleeps again
+ * if nothing is due by then. */
+#define portMAX_SUPPRESSED_TICKS ( ( TickType_t ) 0xFFFFFFFFUL )
+
 /*
  * The additional per-thread data is stored at the beginning of the
- * task's stack.
+ * task's stack, or a pointer to it when it belongs to the thread pool.
  */
 static inline Thread_t *prvGetThreadFromTask(TaskHandle_t xTask)
 {
 StackType_t *pxTopOfStack = *(StackType_t **)xTask;
 
+#if ( portUSE_THREAD_POOL == 1 )
+    return *(Thread_t **)(pxTopOfStack + 1);
+#else
     return (Thread_t *)(pxTopOfStack + 1);
+#endif
 }
 
 /*-----------------------------------------------------------*/
@@ -100,15 +202,122 @@ static volatile portBASE_TYPE uxCriticalNesting;
 static portBASE_TYPE xSchedulerEnd = pdFALSE;
 /*-----------------------------------------------------------*/
 
+/* Simulated interrupts waiting to be handled, one bit per interrupt number. */
+static volatile uint32_t ulPendingInterrupts = 0UL;
+
+/* Handlers installed with vPortSetInterruptHandler(). */
+static uint32_t (*ulIsrHandler[ portMAX_INTERRUPTS ])( void ) = { 0 };
+/*-----------------------------------------------------------*/
+
+#if ( portUSE_TICK_THREAD == 1 )
+/* Ticks counted by the tick thread and not processed yet. */
+static volatile uint32_t ulPendingTicks = 0UL;
+
+/* Set while the running task is in a critical section or an ISR, where
+ * signals used to be blocked. */
+static volatile BaseType_t xInterruptsMasked = pdTRUE;
+
+/* Thread of the running task, the one signalled for pending interrupts. */
+static volatile pid_t xRunningThreadId = 0;
+static __thread pid_t xThisThreadId = 0;
+
+static pid_t xProcessId;
+#if ( portUSE_VIRTUAL_TIME == 0 )
+static pthread_t hTickThread;
+#endif
+
+/* Ticks generated since the scheduler started, and set while the idle task
+ * sleeps through them in vPortSuppressTicksAndSleep().  Both are guarded by
+ * xTickMutex. */
+static pthread_mutex_t xTickMutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t ullTicksGenerated = 0;
+static volatile BaseType_t xTicksSuppressed = pdFALSE;
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+/* The tick thread waits on xTickCond while the ticks are suppressed, the idle
+ * task on xIdleCond until the expected tick or an interrupt. */
+static pthread_cond_t xTickCond;
+static pthread_cond_t xIdleCond;
+#endif
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( portRUN_ON_HOST_CORES == 1 )
+/* A function for a host core, on the stack of the task waiting for it. */
+typedef struct HOST_JOB
+{
+    void (*pvFunction)( void * );
+    void *pvParameters;
+    TaskHandle_t xTask;
+    volatile BaseType_t xDone;
+    struct HOST_JOB *pxNext;
+} HostJob_t;
+
+static pthread_t hHostCores[ portHOST_CORES ];
+static BaseType_t xHostCoresStarted = pdFALSE;
+
+/* Jobs waiting for a host core, oldest first.  Guarded by xHostMutex, like
+ * xHostCoresStop which makes the host cores exit. */
+static pthread_mutex_t xHostMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xHostCond = PTHREAD_COND_INITIALIZER;
+static HostJob_t *pxHostJobsHead = NULL;
+static HostJob_t *pxHostJobsTail = NULL;
+static BaseType_t xHostCoresStop = pdFALSE;
+
+/* Jobs that have run, pushed by the host cores and handed back to their
+ * tasks by the portHOST_CORE_INTERRUPT handler. */
+static HostJob_t *pxHostJobsDone = NULL;
+
+/* Host time each host core has spent running functions, in nanoseconds. */
+static volatile uint64_t ullHostCoreBusyTime[ portHOST_CORES ];
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( portUSE_THREAD_POOL == 1 )
+/* Parked threads, and the condition a thread leaving its task signals.
+ * Both guarded by xPoolMutex. */
+static pthread_mutex_t xPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xPoolCond = PTHREAD_COND_INITIALIZER;
+static Thread_t *pxFreeThreads = NULL;
+#endif
+/*-----------------------------------------------------------*/
+
 static void prvSetupSignalsAndSchedulerPolicy( void );
+#if ( portUSE_TICK_THREAD == 0 )
 static void prvSetupTimerInterrupt( void );
+#endif
+#if ( portUSE_THREAD_POOL == 0 )
 static void *prvWaitForStart( void * pvParams );
+#endif
+static void prvStartTask( Thread_t *pxThread );
+#if ( portUSE_THREAD_POOL == 1 )
+static Thread_t *prvCreatePoolThread( void );
+static Thread_t *prvTakeThread( void );
+static void *prvPoolThread( void * pvParams );
+static void prvLeaveTask( Thread_t *pxThread );
+static void prvStopThreadPool( void );
+#endif
 static void prvSwitchThread( Thread_t * xThreadToResume,
                              Thread_t *xThreadToSuspend );
 static void prvSuspendSelf( Thread_t * thread);
 static void prvResumeThread( Thread_t * xThreadId );
 static void vPortSystemTickHandler( int sig );
+static void prvProcessSimulatedInterrupts( int sig );
 static void vPortStartFirstTask( void );
+#if ( portUSE_TICK_THREAD == 1 )
+static void prvStartTickThread( void );
+#if ( portUSE_VIRTUAL_TIME == 0 )
+static void *prvTickThread( void *pvParams );
+#endif
+static void prvRunPendingInterrupts( void );
+static void prvSignalRunningThread( void );
+#endif
+#if ( portRUN_ON_HOST_CORES == 1 )
+static void prvStartHostCores( void );
+static void prvStopHostCores( void );
+static void *prvHostCore( void *pvParams );
+static uint32_t prvHostCoreInterrupt( void );
+#endif
 /*-----------------------------------------------------------*/
 
 static void prvFatalError( const char *pcCall, int iErrno )
@@ -120,6 +329,37 @@ static void prvFatalError( const char *pcCall, int iErrno )
 /*
  * See header file for description.
  */
+#if ( portUSE_THREAD_POOL == 1 )
+portSTACK_TYPE *pxPortInitialiseStack( portSTACK_TYPE *pxTopOfStack,
+                                       portSTACK_TYPE *pxEndOfStack,
+                                       pdTASK_CODE pxCode, void *pvParameters )
+{
+Thread_t **ppxThread;
+Thread_t *thread;
+
+    (void)pthread_once( &hSigSetupThread, prvSetupSignalsAndSchedulerPolicy );
+
+    /*
+     * Store a pointer to the pooled thread at the start of the stack.  The
+     * task runs on the stack of the thread, not on this one.
+     */
+    ( void ) pxEndOfStack;
+    ppxThread = (Thread_t **)(pxTopOfStack + 1) - 1;
+    pxTopOfStack = (portSTACK_TYPE *)ppxThread - 1;
+
+    vPortEnterCritical();
+
+    thread = prvTakeThread();
+    thread->pxCode = pxCode;
+    thread->pvParams = pvParameters;
+    thread->xDying = pdFALSE;
+    *ppxThread = thread;
+
+    vPortExitCritical();
+
+    return pxTopOfStack;
+}
+#else
 portSTACK_TYPE *pxPortInitialiseStack( portSTACK_TYPE *pxTopOfStack,
                                        portSTACK_TYPE *pxEndOfStack,
                                        pdTASK_CODE pxCode, void *pvParameters )
@@ -145,7 +385,14 @@ int iRet;
     pthread_attr_init( &xThreadAttributes );
     pthread_attr_setstack( &xThreadAttributes, pxEndOfStack, ulStackSize );
 
+#if ( portUSE_FUTEX_SWITCH == 1 )
+    thread->ulState = portTHREAD_RUNNING;
+#else
     thread->ev = event_create();
+#endif
+#if ( portUSE_TICK_THREAD == 1 )
+    thread->xThreadId = 0;
+#endif
 
     vPortEnterCritical();
 
@@ -160,12 +407,17 @@ int iRet;
 
     return pxTopOfStack;
 }
+#endif /* portUSE_THREAD_POOL */
 /*-----------------------------------------------------------*/
 
 void vPortStartFirstTask( void )
 {
 Thread_t *pxFirstThread = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
 
+#if ( portUSE_TICK_THREAD == 1 )
+    __atomic_store_n( &xRunningThreadId, __atomic_load_n( &pxFirstThread->xThreadId, __ATOMIC_SEQ_CST ), __ATOMIC_SEQ_CST );
+#endif
+
     /* Start the first task. */
     prvResumeThread( pxFirstThread );
 }
@@ -181,9 +433,19 @@ sigset_t xSignals;
 
     hMainThread = pthread_self();
 
+    vPortSetHostThreadPolicy( ePortThreadScheduler, 0 );
+
+#if ( portUSE_TICK_THREAD == 1 )
+    prvStartTickThread();
+#else
     /* Start the timer that generates the tick ISR(SIGALRM).
        Interrupts are disabled here already. */
     prvSetupTimerInterrupt();
+#endif
+
+#if ( portRUN_ON_HOST_CORES == 1 )
+    prvStartHostCores();
+#endif
 
     /* Start the first task. */
     vPortStartFirstTask();
@@ -197,6 +459,15 @@ sigset_t xSignals;
         sigwait( &xSignals, &iSignal );
     }
 
+#if ( portUSE_TICK_THREAD == 1 ) && ( portUSE_VIRTUAL_TIME == 0 )
+    /* No more signals are sent to task threads once it is gone. */
+    pthread_join( hTickThread, NULL );
+#endif
+
+#if ( portRUN_ON_HOST_CORES == 1 )
+    prvStopHostCores();
+#endif
+
     /* Cancel the Idle task and free its resources */
 #if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
     vPortCancelThread( xTaskGetIdleTaskHandle() );
@@ -207,6 +478,10 @@ sigset_t xSignals;
     vPortCancelThread( xTimerGetTimerDaemonTaskHandle() );
 #endif /* configUSE_TIMERS */
 
+#if ( portUSE_THREAD_POOL == 1 )
+    prvStopThreadPool();
+#endif
+
     /* Restore original signal mask. */
     (void)pthread_sigmask( SIG_SETMASK, &xSchedulerOriginalSignalMask,  NULL );
 
@@ -216,10 +491,15 @@ sigset_t xSignals;
 
 void vPortEndScheduler( void )
 {
-struct itimerval itimer;
 struct sigaction sigtick;
 Thread_t *xCurrentThread;
+#if ( portUSE_TICK_THREAD == 0 )
+struct itimerval itimer;
+#endif
 
+#if ( portUSE_TICK_THREAD == 1 )
+    /* The tick thread exits on its next tick. */
+#else
     /* Stop the timer and ignore any pending SIGALRMs that would end
      * up running on the main thread when it is resumed. */
     itimer.it_value.tv_sec = 0;
@@ -228,11 +508,13 @@ Thread_t *xCurrentThread;
     itimer.it_interval.tv_sec = 0;
     itimer.it_interval.tv_usec = 0;
     (void)setitimer( ITIMER_REAL, &itimer, NULL );
+#endif
 
     sigtick.sa_flags = 0;
     sigtick.sa_handler = SIG_IGN;
     sigemptyset( &sigtick.sa_mask );
     sigaction( SIGALRM, &sigtick, NULL );
+    sigaction( SIG_INTERRUPT, &sigtick, NULL );
 
     /* Signal the scheduler to exit its loop. */
     xSchedulerEnd = pdTRUE;
@@ -292,13 +574,35 @@ void vPortYield( void )
 
 void vPortDisableInterrupts( void )
 {
+#if ( portUSE_TICK_THREAD == 1 )
+    /* Only read by the signal handler on this same thread, or as a hint by
+     * prvSignalRunningThread(). */
+    xInterruptsMasked = pdTRUE;
+    portMEMORY_BARRIER();
+#else
     pthread_sigmask( SIG_BLOCK, &xAllSignals, NULL );
+#endif
 }
 /*-----------------------------------------------------------*/
 
 void vPortEnableInterrupts( void )
 {
+#if ( portUSE_TICK_THREAD == 1 )
+    /*
+     * Pairs with prvSignalRunningThread(), which makes the interrupt
+     * pending before reading the flag: either it sees the flag clear and
+     * signals this thread, or the pending interrupt is seen here.
+     */
+    __atomic_store_n( &xInterruptsMasked, pdFALSE, __ATOMIC_SEQ_CST );
+
+    if( ( __atomic_load_n( &ulPendingTicks, __ATOMIC_SEQ_CST ) |
+          __atomic_load_n( &ulPendingInterrupts, __ATOMIC_SEQ_CST ) ) != 0UL )
+    {
+        prvRunPendingInterrupts();
+    }
+#else
     pthread_sigmask( SIG_UNBLOCK, &xAllSignals, NULL );
+#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -312,6 +616,7 @@ portBASE_TYPE xPortSetInterruptMask( void )
 
 void vPortClearInterruptMask( portBASE_TYPE xMask )
 {
+    ( void )xMask;
 }
 /*-----------------------------------------------------------*/
 
@@ -329,11 +634,12 @@ static uint64_t prvStartTimeNs;
  * to adjust timing according to full demo requirements */
 /* static uint64_t prvTickCount; */
 
+#if ( portUSE_TICK_THREAD == 0 )
 /*
  * Setup the systick timer to generate the tick interrupts at the required
  * frequency.
  */
-void prvSetupTimerInterrupt( void )
+static void prvSetupTimerInterrupt( void )
 {
 struct itimerval itimer;
 int iRet;
@@ -362,6 +668,7 @@ int iRet;
 
     prvStartTimeNs = prvGetTimeNs();
 }
+#endif /* portUSE_TICK_THREAD */
 /*-----------------------------------------------------------*/
 
 static void vPortSystemTickHandler( int sig )
@@ -370,6 +677,8 @@ Thread_t *pxThreadToSuspend;
 Thread_t *pxThreadToResume;
 /* uint64_t xExpectedTicks; */
 
+    ( void )sig;
+
     uxCriticalNesting++; /* Signals are blocked in this signal handler. */
 
 #if ( configUSE_PREEMPTION == 1 )
@@ -401,13 +710,656 @@ Thread_t *pxThreadToResume;
 }
 /*-----------------------------------------------------------*/
 
+/* Runs the handlers of the interrupts in ulPending, returns pdTRUE if one of
+ * them requires a context switch. */
+static BaseType_t prvRunInterruptHandlers( uint32_t ulPending )
+{
+uint32_t ulInterrupt;
+BaseType_t xSwitchRequired = pdFALSE;
+
+    for( ulInterrupt = 0; ulInterrupt < portMAX_INTERRUPTS; ulInterrupt++ )
+    {
+        if( ( ulPending & ( 1UL << ulInterrupt ) ) != 0UL )
+        {
+            if( ulIsrHandler[ ulInterrupt ] != NULL )
+            {
+                if( ulIsrHandler[ ulInterrupt ]() != pdFALSE )
+                {
+                    xSwitchRequired = pdTRUE;
+                }
+            }
+        }
+    }
+
+    return xSwitchRequired;
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessSimulatedInterrupts( int sig )
+{
+#if ( portUSE_TICK_THREAD == 1 )
+    ( void )sig;
+
+    /* Left pending for the running thread, or until the critical section
+     * is left. */
+    if( ( xRunningThreadId == xThisThreadId ) && ( xInterruptsMasked == pdFALSE ) )
+    {
+        prvRunPendingInterrupts();
+    }
+#else
+BaseType_t xSwitchRequired;
+
+    ( void )sig;
+
+    uxCriticalNesting++; /* Signals are blocked in this signal handler. */
+
+    xSwitchRequired = prvRunInterruptHandlers( __atomic_exchange_n( &ulPendingInterrupts, 0UL, __ATOMIC_SEQ_CST ) );
+
+#if ( configUSE_PREEMPTION == 1 )
+    if( xSwitchRequired != pdFALSE )
+    {
+        vPortYieldFromISR();
+    }
+#else
+    ( void ) xSwitchRequired;
+#endif
+
+    uxCriticalNesting--;
+#endif /* portUSE_TICK_THREAD */
+}
+/*-----------------------------------------------------------*/
+
+#if ( portUSE_TICK_THREAD == 1 )
+/*
+ * Runs the pending ticks and interrupts as an ISR on the thread of the
+ * running task, from the signal handler or when the last critical section
+ * is left.
+ */
+static void prvRunPendingInterrupts( void )
+{
+uint32_t ulTicks;
+BaseType_t xSwitchRequired;
+
+    while( ( __atomic_load_n( &ulPendingTicks, __ATOMIC_SEQ_CST ) |
+             __atomic_load_n( &ulPendingInterrupts, __ATOMIC_SEQ_CST ) ) != 0UL )
+    {
+        xInterruptsMasked = pdTRUE;
+        portMEMORY_BARRIER();
+        uxCriticalNesting++;
+
+        xSwitchRequired = pdFALSE;
+
+        /* Every tick counted is processed, none is lost if this thread ran
+         * late. */
+        for( ulTicks = __atomic_exchange_n( &ulPendingTicks, 0UL, __ATOMIC_SEQ_CST ); ulTicks > 0; ulTicks-- )
+        {
+            if( xTaskIncrementTick() != pdFALSE )
+            {
+                xSwitchRequired = pdTRUE;
+            }
+        }
+
+        if( prvRunInterruptHandlers( __atomic_exchange_n( &ulPendingInterrupts, 0UL, __ATOMIC_SEQ_CST ) ) != pdFALSE )
+        {
+            xSwitchRequired = pdTRUE;
+        }
+
+#if ( configUSE_PREEMPTION == 1 )
+        if( xSwitchRequired != pdFALSE )
+        {
+            vPortYieldFromISR();
+        }
+#else
+        ( void ) xSwitchRequired;
+#endif
+
+        uxCriticalNesting--;
+        __atomic_store_n( &xInterruptsMasked, pdFALSE, __ATOMIC_SEQ_CST );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Called after making a tick or an interrupt pending.  A thread that has
+ * stopped running, or that masks interrupts by then, ignores the signal
+ * and the interrupt is run when the flag is cleared.
+ */
+static void prvSignalRunningThread( void )
+{
+pid_t xThreadId = __atomic_load_n( &xRunningThreadId, __ATOMIC_SEQ_CST );
+
+    if( ( xThreadId != 0 ) && ( __atomic_load_n( &xInterruptsMasked, __ATOMIC_SEQ_CST ) == pdFALSE ) )
+    {
+        /* A thread id is only reused by a new thread of this process,
+         * where the signal is equally ignored. */
+        (void)syscall( SYS_tgkill, xProcessId, xThreadId, SIG_INTERRUPT );
+    }
+}
+/*-----------------------------------------------------------*/
+
+#if ( portUSE_VIRTUAL_TIME == 0 )
+/* Time of tick number ullTick, counted from the start of the scheduler. */
+static void prvGetTickTime( uint64_t ullTick, struct timespec *pxTime )
+{
+uint64_t ullTimeNs = prvStartTimeNs + ullTick * portTICK_RATE_MICROSECONDS * 1000ULL;
+
+    pxTime->tv_sec = ( time_t )( ullTimeNs / 1000000000ULL );
+    pxTime->tv_nsec = ( long )( ullTimeNs % 1000000000ULL );
+}
+#endif
+/*-----------------------------------------------------------*/
+
+static void prvStartTickThread( void )
+{
+#if ( configUSE_TICKLESS_IDLE == 1 )
+pthread_condattr_t xCondAttributes;
+#endif
+#if ( portUSE_VIRTUAL_TIME == 0 )
+int iRet;
+#endif
+
+    xProcessId = getpid();
+    prvStartTimeNs = prvGetTimeNs();
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+    /* The idle task waits for a tick time, on the clock of the ticks. */
+    pthread_condattr_init( &xCondAttributes );
+    pthread_condattr_setclock( &xCondAttributes, CLOCK_MONOTONIC );
+    pthread_cond_init( &xTickCond, &xCondAttributes );
+    pthread_cond_init( &xIdleCond, &xCondAttributes );
+    pthread_condattr_destroy( &xCondAttributes );
+#endif
+
+#if ( portUSE_VIRTUAL_TIME == 0 )
+    /* Inherits the mask of this thread, with every signal blocked. */
+    iRet = pthread_create( &hTickThread, NULL, prvTickThread, NULL );
+    if ( iRet )
+    {
+        prvFatalError( "pthread_create", iRet );
+    }
+#endif
+}
+/*-----------------------------------------------------------*/
+
+#if ( portUSE_VIRTUAL_TIME == 0 )
+/* On virtual time the idle task counts every tick instead. */
+static void *prvTickThread( void *pvParams )
+{
+struct timespec xNextTick;
+uint64_t ullTick;
+
+    (void)pvParams;
+
+    vPortSetHostThreadPolicy( ePortThreadTick, 0 );
+
+    pthread_mutex_lock( &xTickMutex );
+
+    while ( !xSchedulerEnd )
+    {
+#if ( configUSE_TICKLESS_IDLE == 1 )
+        if ( xTicksSuppressed )
+        {
+            /* The idle task accounts for the ticks while it sleeps. */
+            pthread_cond_wait( &xTickCond, &xTickMutex );
+            continue;
+        }
+#endif
+
+        /* Absolute deadlines, so the tick period does not drift with the
+         * time taken to wake up. */
+        ullTick = ullTicksGenerated + 1;
+        prvGetTickTime( ullTick, &xNextTick );
+
+        pthread_mutex_unlock( &xTickMutex );
+        while ( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &xNextTick, NULL ) == EINTR )
+        {
+        }
+        pthread_mutex_lock( &xTickMutex );
+
+        /* Unless the idle task slept through it in the meantime. */
+        if ( ( ullTicksGenerated + 1 == ullTick ) && !xTicksSuppressed )
+        {
+            ullTicksGenerated = ullTick;
+            __atomic_fetch_add( &ulPendingTicks, 1UL, __ATOMIC_SEQ_CST );
+            prvSignalRunningThread();
+        }
+    }
+
+    pthread_mutex_unlock( &xTickMutex );
+
+    return NULL;
+}
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+/*
+ * Called by the idle task, with the scheduler suspended, when no task is
+ * due for xExpectedIdleTime ticks.  The tick thread stops and the idle
+ * thread sleeps until that tick, or until an interrupt is generated, then
+ * steps the tick count by the ticks that went by.
+ *
+ * On virtual time the ticks go by at once, the idle thread only sleeps when
+ * no task waits for a tick at all.
+ */
+void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+#if ( portUSE_VIRTUAL_TIME == 0 )
+struct timespec xWakeTime;
+#endif
+eSleepModeStatus eSleepStatus;
+uint64_t ullElapsed = 0;
+TickType_t xStepTicks = 0;
+
+    /* Far enough for the wake time to fit in 64 bits of nanoseconds. */
+    if ( xExpectedIdleTime > portMAX_SUPPRESSED_TICKS )
+    {
+        xExpectedIdleTime = portMAX_SUPPRESSED_TICKS;
+    }
+
+    vPortEnterCritical();
+    pthread_mutex_lock( &xTickMutex );
+
+    __atomic_store_n( &xTicksSuppressed, pdTRUE, __ATOMIC_SEQ_CST );
+
+    /* Ticks still pending have not been counted by the kernel, which would
+     * then wake a task late. */
+    if ( ( __atomic_load_n( &ulPendingTicks, __ATOMIC_SEQ_CST ) == 0UL ) &&
+         ( ( eSleepStatus = eTaskConfirmSleepModeStatus() ) != eAbortSleep ) )
+    {
+#if ( portUSE_VIRTUAL_TIME == 1 )
+        if ( eSleepStatus == eNoTasksWaitingTimeout )
+        {
+            /* Only an interrupt can make a task ready, time stands still. */
+            while ( __atomic_load_n( &ulPendingInterrupts, __ATOMIC_SEQ_CST ) == 0UL )
+            {
+                pthread_cond_wait( &xIdleCond, &xTickMutex );
+            }
+        }
+        else if ( __atomic_load_n( &ulPendingInterrupts, __ATOMIC_SEQ_CST ) == 0UL )
+        {
+            ullElapsed = xExpectedIdleTime;
+        }
+#else
+        (void)eSleepStatus;
+        prvGetTickTime( ullTicksGenerated + xExpectedIdleTime, &xWakeTime );
+
+        while ( ( __atomic_load_n( &ulPendingInterrupts, __ATOMIC_SEQ_CST ) == 0UL ) &&
+                ( pthread_cond_timedwait( &xIdleCond, &xTickMutex, &xWakeTime ) != ETIMEDOUT ) )
+        {
+        }
+
+        ullElapsed = ( prvGetTimeNs() - prvStartTimeNs ) / ( portTICK_RATE_MICROSECONDS * 1000ULL ) - ullTicksGenerated;
+#endif
+        ullTicksGenerated += ullElapsed;
+
+        /* The last tick is counted by xTaskIncrementTick(), which unblocks
+         * the task waiting for it. */
+        xStepTicks = ( ullElapsed < xExpectedIdleTime ) ? ( TickType_t )ullElapsed : xExpectedIdleTime - 1;
+        __atomic_fetch_add( &ulPendingTicks, ( uint32_t )( ullElapsed - xStepTicks ), __ATOMIC_SEQ_CST );
+    }
+
+    __atomic_store_n( &xTicksSuppressed, pdFALSE, __ATOMIC_SEQ_CST );
+    pthread_cond_signal( &xTickCond );
+    pthread_mutex_unlock( &xTickMutex );
+
+    if ( xStepTicks > 0 )
+    {
+        vTaskStepTick( xStepTicks );
+    }
+
+    /* Runs the remaining ticks and the interrupt that ended the sleep. */
+    vPortExitCritical();
+}
+#endif /* configUSE_TICKLESS_IDLE */
+#endif /* portUSE_TICK_THREAD */
+/*-----------------------------------------------------------*/
+
+void vPortGenerateSimulatedInterrupt( uint32_t ulInterruptNumber )
+{
+    if( ulInterruptNumber < portMAX_INTERRUPTS )
+    {
+        __atomic_fetch_or( &ulPendingInterrupts, 1UL << ulInterruptNumber, __ATOMIC_SEQ_CST );
+
+#if ( portUSE_TICK_THREAD == 1 )
+        prvSignalRunningThread();
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+        if ( __atomic_load_n( &xTicksSuppressed, __ATOMIC_SEQ_CST ) )
+        {
+            /* The idle task sleeps, and looks at the pending interrupts
+             * with the mutex held before waiting. */
+            pthread_mutex_lock( &xTickMutex );
+            pthread_cond_signal( &xIdleCond );
+            pthread_mutex_unlock( &xTickMutex );
+        }
+#endif
+#else
+        /* Process directed, so it is handled by whichever thread does not
+         * have it blocked - only the thread of the running task outside of
+         * a critical section. */
+        (void)kill( getpid(), SIG_INTERRUPT );
+#endif
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetInterruptHandler( uint32_t ulInterruptNumber, uint32_t (*pvHandler)( void ) )
+{
+    if( ulInterruptNumber < portMAX_INTERRUPTS )
+    {
+        vPortEnterCritical();
+        ulIsrHandler[ ulInterruptNumber ] = pvHandler;
+        vPortExitCritical();
+    }
+}
+/*-----------------------------------------------------------*/
+
+#if ( portRUN_ON_HOST_CORES == 1 )
+static void prvStartHostCores( void )
+{
+UBaseType_t uxCore;
+int iRet;
+
+    ulIsrHandler[ portHOST_CORE_INTERRUPT ] = prvHostCoreInterrupt;
+
+    for ( uxCore = 0; uxCore < portHOST_CORES; uxCore++ )
+    {
+        /* Inherits the mask of this thread, with every signal blocked, as
+         * required to raise interrupts. */
+        iRet = pthread_create( &hHostCores[ uxCore ], NULL, prvHostCore, ( void * )( uintptr_t )uxCore );
+        if ( iRet )
+        {
+            prvFatalError( "pthread_create", iRet );
+        }
+    }
+
+    xHostCoresStarted = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStopHostCores( void )
+{
+UBaseType_t uxCore;
+
+    pthread_mutex_lock( &xHostMutex );
+    xHostCoresStop = pdTRUE;
+    pthread_cond_broadcast( &xHostCond );
+    pthread_mutex_unlock( &xHostMutex );
+
+    for ( uxCore = 0; uxCore < portHOST_CORES; uxCore++ )
+    {
+        pthread_join( hHostCores[ uxCore ], NULL );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void *prvHostCore( void *pvParams )
+{
+UBaseType_t uxCore = ( UBaseType_t )( uintptr_t )pvParams;
+HostJob_t *pxJob;
+uint64_t ullStart;
+
+    vPortSetHostThreadPolicy( ePortThreadHostCore, 0 );
+
+    pthread_mutex_lock( &xHostMutex );
+
+    for ( ;; )
+    {
+        while ( ( pxHostJobsHead == NULL ) && !xHostCoresStop )
+        {
+            pthread_cond_wait( &xHostCond, &xHostMutex );
+        }
+
+        if ( pxHostJobsHead == NULL )
+        {
+            break;
+        }
+
+        pxJob = pxHostJobsHead;
+        pxHostJobsHead = pxJob->pxNext;
+        pthread_mutex_unlock( &xHostMutex );
+
+        ullStart = prvGetTimeNs();
+        pxJob->pvFunction( pxJob->pvParameters );
+        __atomic_store_n( &ullHostCoreBusyTime[ uxCore ], ullHostCoreBusyTime[ uxCore ] + prvGetTimeNs() - ullStart,
+                          __ATOMIC_RELAXED );
+
+        pxJob->pxNext = __atomic_load_n( &pxHostJobsDone, __ATOMIC_RELAXED );
+        while ( !__atomic_compare_exchange_n( &pxHostJobsDone, &pxJob->pxNext, pxJob, pdFALSE,
+                                              __ATOMIC_SEQ_CST, __ATOMIC_RELAXED ) )
+        {
+        }
+        vPortGenerateSimulatedInterrupt( portHOST_CORE_INTERRUPT );
+
+        pthread_mutex_lock( &xHostMutex );
+    }
+
+    pthread_mutex_unlock( &xHostMutex );
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvHostCoreInterrupt( void )
+{
+HostJob_t *pxJob = __atomic_exchange_n( &pxHostJobsDone, NULL, __ATOMIC_SEQ_CST );
+HostJob_t *pxNext;
+TaskHandle_t xTask;
+BaseType_t xSwitchRequired = pdFALSE;
+
+    while ( pxJob != NULL )
+    {
+        /* The job is gone with the stack of its task once it is done. */
+        pxNext = pxJob->pxNext;
+        xTask = pxJob->xTask;
+        pxJob->xDone = pdTRUE;
+        vTaskNotifyGiveIndexedFromISR( xTask, portHOST_CORE_NOTIFY_INDEX, &xSwitchRequired );
+        pxJob = pxNext;
+    }
+
+    return ( uint32_t )xSwitchRequired;
+}
+/*-----------------------------------------------------------*/
+#endif /* portRUN_ON_HOST_CORES */
+
+void vPortRunOnHostCore( void (*pvFunction)( void * ), void *pvParameters )
+{
+#if ( portRUN_ON_HOST_CORES == 1 )
+HostJob_t xJob;
+
+    if ( xHostCoresStarted )
+    {
+        xJob.pvFunction = pvFunction;
+        xJob.pvParameters = pvParameters;
+        xJob.xTask = xTaskGetCurrentTaskHandle();
+        xJob.xDone = pdFALSE;
+        xJob.pxNext = NULL;
+
+        /* No switch while the mutex is held, or the next task could wait
+         * for it without ever letting this one release it. */
+        vPortEnterCritical();
+        pthread_mutex_lock( &xHostMutex );
+
+        if ( pxHostJobsHead == NULL )
+        {
+            pxHostJobsHead = &xJob;
+        }
+        else
+        {
+            pxHostJobsTail->pxNext = &xJob;
+        }
+        pxHostJobsTail = &xJob;
+        pthread_cond_signal( &xHostCond );
+
+        pthread_mutex_unlock( &xHostMutex );
+        vPortExitCritical();
+
+        while ( !xJob.xDone )
+        {
+            ( void )ulTaskNotifyTakeIndexed( portHOST_CORE_NOTIFY_INDEX, pdTRUE, portMAX_DELAY );
+        }
+
+        return;
+    }
+#endif
+
+    pvFunction( pvParameters );
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullPortGetHostCoreBusyTime( UBaseType_t uxCore )
+{
+#if ( portRUN_ON_HOST_CORES == 1 )
+    if ( uxCore < portHOST_CORES )
+    {
+        return __atomic_load_n( &ullHostCoreBusyTime[ uxCore ], __ATOMIC_RELAXED );
+    }
+#else
+    ( void )uxCore;
+#endif
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+#if ( portHOST_THREADS_SCHEDULED == 1 )
+static void prvWarnHostThreadPolicy( const char *pcCall, int iErrno )
+{
+static BaseType_t xWarned = pdFALSE;
+
+    /* Once only, typically for missing privileges. */
+    if( __atomic_exchange_n( &xWarned, pdTRUE, __ATOMIC_RELAXED ) == pdFALSE )
+    {
+        fprintf( stderr, "%s: %s, host thread left as it is\n", pcCall, strerror( iErrno ) );
+    }
+}
+#endif
+/*-----------------------------------------------------------*/
+
+void vPortSetHostThreadPolicy( ePortHostThread eThread, UBaseType_t uxPriority )
+{
+#if ( portHOST_THREADS_SCHEDULED == 1 )
+uint64_t ullCpus;
+int iPriority;
+int iRet;
+
+    switch( eThread )
+    {
+        case ePortThreadTick:
+            ullCpus = portHOST_TICK_CPUS;
+            iPriority = portHOST_PRIORITY_BASE + configMAX_PRIORITIES + 1;
+            break;
+
+        case ePortThreadTask:
+            ullCpus = portHOST_TASK_CPUS;
+            iPriority = portHOST_PRIORITY_BASE + ( int )uxPriority;
+            break;
+
+        case ePortThreadHostCore:
+            ullCpus = portHOST_CORE_CPUS;
+            iPriority = portHOST_PRIORITY_BASE;
+            break;
+
+        case ePortThreadIO:
+            ullCpus = portHOST_IO_CPUS;
+            iPriority = portHOST_PRIORITY_BASE + configMAX_PRIORITIES;
+            break;
+
+        default:
+            ullCpus = portHOST_SCHEDULER_CPUS;
+            iPriority = portHOST_PRIORITY_BASE;
+            break;
+    }
+
+    if( ullCpus != 0 )
+    {
+    cpu_set_t xCpus;
+    int iCpu;
+
+        CPU_ZERO( &xCpus );
+        for( iCpu = 0; iCpu < 64; iCpu++ )
+        {
+            if( ( ullCpus & ( 1ULL << iCpu ) ) != 0 )
+            {
+                CPU_SET( iCpu, &xCpus );
+            }
+        }
+
+        iRet = pthread_setaffinity_np( pthread_self(), sizeof( xCpus ), &xCpus );
+        if( iRet )
+        {
+            prvWarnHostThreadPolicy( "pthread_setaffinity_np", iRet );
+        }
+    }
+
+#if ( portHOST_SCHED_POLICY != SCHED_OTHER )
+    {
+    struct sched_param xParam;
+
+        if( iPriority > sched_get_priority_max( portHOST_SCHED_POLICY ) )
+        {
+            iPriority = sched_get_priority_max( portHOST_SCHED_POLICY );
+        }
+
+        memset( &xParam, 0, sizeof( xParam ) );
+        xParam.sched_priority = iPriority;
+        iRet = pthread_setschedparam( pthread_self(), portHOST_SCHED_POLICY, &xParam );
+        if( iRet )
+        {
+            prvWarnHostThreadPolicy( "pthread_setschedparam", iRet );
+        }
+    }
+#else
+    ( void )iPriority;
+#endif
+#else
+    ( void )eThread;
+    ( void )uxPriority;
+#endif /* portHOST_THREADS_SCHEDULED */
+}
+/*-----------------------------------------------------------*/
+
 void vPortThreadDying( void *pxTaskToDelete, volatile BaseType_t *pxPendYield )
 {
 Thread_t *pxThread = prvGetThreadFromTask( pxTaskToDelete );
 
+    ( void )pxPendYield;
     pxThread->xDying = pdTRUE;
 }
 
+#if ( portUSE_THREAD_POOL == 1 )
+void vPortCancelThread( void *pxTaskToDelete )
+{
+Thread_t *pxThreadToCancel = prvGetThreadFromTask( pxTaskToDelete );
+
+    vPortEnterCritical();
+    pthread_mutex_lock( &xPoolMutex );
+
+    /*
+     * A task that deleted itself is already on its way out.  Another one
+     * is suspended, it is resumed to leave the task from prvSuspendSelf().
+     * A task that never ran has not entered its task at all.
+     */
+    if( ( pxThreadToCancel->xInTask != pdFALSE ) && ( pxThreadToCancel->xDying == pdFALSE ) )
+    {
+        __atomic_store_n( &pxThreadToCancel->xCancel, pdTRUE, __ATOMIC_RELEASE );
+        prvResumeThread( pxThreadToCancel );
+    }
+
+    /* The stack of the task is freed once this returns. */
+    while( pxThreadToCancel->xInTask != pdFALSE )
+    {
+        pthread_cond_wait( &xPoolCond, &xPoolMutex );
+    }
+
+    pxThreadToCancel->pxNextFree = pxFreeThreads;
+    pxFreeThreads = pxThreadToCancel;
+
+    pthread_mutex_unlock( &xPoolMutex );
+    vPortExitCritical();
+}
+#else
 void vPortCancelThread( void *pxTaskToDelete )
 {
 Thread_t *pxThreadToCancel = prvGetThreadFromTask( pxTaskToDelete );
@@ -416,17 +1368,187 @@ Thread_t *pxThreadToCancel = prvGetThreadFromTask( pxTaskToDelete );
      * The thread has already been suspended so it can be safely cancelled.
      */
     pthread_cancel( pxThreadToCancel->pthread );
+#if ( portUSE_FUTEX_SWITCH == 1 )
+    /*
+     * Unlike pthread_cond_wait(), the futex wait is not a cancellation
+     * point, so the thread is woken to act on the cancellation itself.
+     */
+    __atomic_store_n( &pxThreadToCancel->ulState, portTHREAD_RESUMED, __ATOMIC_RELEASE );
+    (void)syscall( SYS_futex, &pxThreadToCancel->ulState, FUTEX_WAKE_PRIVATE,
+                   1, NULL, NULL, 0 );
+#endif
     pthread_join( pxThreadToCancel->pthread, NULL );
+#if ( portUSE_FUTEX_SWITCH == 0 )
     event_delete( pxThreadToCancel->ev );
+#endif
 }
+#endif /* portUSE_THREAD_POOL */
 /*-----------------------------------------------------------*/
 
+#if ( portUSE_THREAD_POOL == 1 )
+static Thread_t *prvCreatePoolThread( void )
+{
+Thread_t *pxThread;
+sigset_t xSavedSignals;
+int iRet;
+
+    pxThread = calloc( 1, sizeof( Thread_t ) );
+    if ( pxThread == NULL )
+    {
+        prvFatalError( "calloc", ENOMEM );
+    }
+
+#if ( portUSE_FUTEX_SWITCH == 1 )
+    pxThread->ulState = portTHREAD_RUNNING;
+#else
+    pxThread->ev = event_create();
+#endif
+
+    /* Parked threads keep every signal blocked, whatever the caller has
+     * unblocked. */
+    (void)pthread_sigmask( SIG_SETMASK, &xAllSignals, &xSavedSignals );
+    iRet = pthread_create( &pxThread->pthread, NULL, prvPoolThread, pxThread );
+    (void)pthread_sigmask( SIG_SETMASK, &xSavedSignals, NULL );
+    if ( iRet )
+    {
+        prvFatalError( "pthread_create", iRet );
+    }
+
+    return pxThread;
+}
+/*-----------------------------------------------------------*/
+
+/* Called from a critical section. */
+static Thread_t *prvTakeThread( void )
+{
+Thread_t *pxThread;
+
+    pthread_mutex_lock( &xPoolMutex );
+    pxThread = pxFreeThreads;
+    if( pxThread != NULL )
+    {
+        pxFreeThreads = pxThread->pxNextFree;
+    }
+    pthread_mutex_unlock( &xPoolMutex );
+
+    if( pxThread == NULL )
+    {
+        pxThread = prvCreatePoolThread();
+    }
+
+    return pxThread;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvPoolThread( void * pvParams )
+{
+Thread_t *pxThread = pvParams;
+
+#if ( portUSE_TICK_THREAD == 1 )
+    xThisThreadId = (pid_t)syscall( SYS_gettid );
+    __atomic_store_n( &pxThread->xThreadId, xThisThreadId, __ATOMIC_SEQ_CST );
+#endif
+
+    for( ;; )
+    {
+        /* Parked until a task given this thread is resumed. */
+        prvSuspendSelf( pxThread );
+        if( pxThread->xExit != pdFALSE )
+        {
+            break;
+        }
+
+        /* The signal mask is saved with every signal blocked. */
+        if( sigsetjmp( pxThread->xPoolContext, 1 ) == 0 )
+        {
+            pthread_mutex_lock( &xPoolMutex );
+            pxThread->xInTask = pdTRUE;
+            pthread_mutex_unlock( &xPoolMutex );
+
+            prvStartTask( pxThread );
+        }
+
+        /* Back from prvLeaveTask(), with every signal blocked again. */
+        pthread_mutex_lock( &xPoolMutex );
+        pxThread->xInTask = pdFALSE;
+        pxThread->xCancel = pdFALSE;
+        pthread_cond_broadcast( &xPoolCond );
+        pthread_mutex_unlock( &xPoolMutex );
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Leaves the task of a thread for good, the thread goes back to the pool.
+ */
+static void prvLeaveTask( Thread_t *pxThread )
+{
+    siglongjmp( pxThread->xPoolContext, 1 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvStopThreadPool( void )
+{
+Thread_t *pxThread;
+
+    while( pxFreeThreads != NULL )
+    {
+        pxThread = pxFreeThreads;
+        pxFreeThreads = pxThread->pxNextFree;
+
+        pxThread->xExit = pdTRUE;
+        prvResumeThread( pxThread );
+        pthread_join( pxThread->pthread, NULL );
+#if ( portUSE_FUTEX_SWITCH == 0 )
+        event_delete( pxThread->ev );
+#endif
+        free( pxThread );
+    }
+}
+/*-----------------------------------------------------------*/
+#else /* portUSE_THREAD_POOL */
+
 static void *prvWaitForStart( void * pvParams )
 {
 Thread_t *pxThread = pvParams;
 
+#if ( portUSE_TICK_THREAD == 1 )
+    xThisThreadId = (pid_t)syscall( SYS_gettid );
+    __atomic_store_n( &pxThread->xThreadId, xThisThreadId, __ATOMIC_SEQ_CST );
+#endif
+
     prvSuspendSelf(pxThread);
 
+    prvStartTask( pxThread );
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+#endif /* portUSE_THREAD_POOL */
+
+static void prvStartTask( Thread_t *pxThread )
+{
+#if ( portUSE_TICK_THREAD == 1 )
+sigset_t xInterruptSignal;
+
+    /* Resumed for the first time.  The id was not known yet if the thread
+     * was resumed before setting it.  Only SIG_INTERRUPT is unblocked, and
+     * for good. */
+    __atomic_store_n( &xRunningThreadId, xThisThreadId, __ATOMIC_SEQ_CST );
+    sigemptyset( &xInterruptSignal );
+    sigaddset( &xInterruptSignal, SIG_INTERRUPT );
+    (void)pthread_sigmask( SIG_UNBLOCK, &xInterruptSignal, NULL );
+#endif
+
+    /* The host priority follows the priority the task starts with. */
+#if ( INCLUDE_uxTaskPriorityGet == 1 )
+    vPortSetHostThreadPolicy( ePortThreadTask, uxTaskPriorityGet( NULL ) );
+#else
+    vPortSetHostThreadPolicy( ePortThreadTask, 0 );
+#endif
+
     /* Resumed for the first time, unblocks all signals. */
     uxCriticalNesting = 0;
     vPortEnableInterrupts();
@@ -440,8 +1562,6 @@ Thread_t *pxThread = pvParams;
     * to be triggered if configASSERT() is defined, so application writers can
         * catch the error. */
     configASSERT( pdFALSE );
-
-    return NULL;
 }
 /*-----------------------------------------------------------*/
 
@@ -461,10 +1581,17 @@ BaseType_t uxSavedCriticalNesting;
          */
         uxSavedCriticalNesting = uxCriticalNesting;
 
+#if ( portUSE_TICK_THREAD == 1 )
+        __atomic_store_n( &xRunningThreadId, __atomic_load_n( &pxThreadToResume->xThreadId, __ATOMIC_SEQ_CST ), __ATOMIC_SEQ_CST );
+#endif
         prvResumeThread( pxThreadToResume );
         if ( pxThreadToSuspend->xDying )
         {
+#if ( portUSE_THREAD_POOL == 1 )
+            prvLeaveTask( pxThreadToSuspend );
+#else
             pthread_exit( NULL );
+#endif
         }
         prvSuspendSelf( pxThreadToSuspend );
 
@@ -488,7 +1615,46 @@ static void prvSuspendSelf( Thread_t *thread )
      *
      * - A thread with all signals blocked with pthread_sigmask().
         */
+#if ( portUSE_FUTEX_SWITCH == 1 )
+uint32_t ulExpected;
+
+    for( ;; )
+    {
+#if ( portUSE_THREAD_POOL == 0 )
+        /* Exits here once vPortCancelThread() has cancelled the thread. */
+        pthread_testcancel();
+#endif
+
+        /* Already resumed, nothing to wait for. */
+        ulExpected = portTHREAD_RESUMED;
+        if( __atomic_compare_exchange_n( &thread->ulState, &ulExpected, portTHREAD_RUNNING,
+                                         pdFALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) )
+        {
+            break;
+        }
+
+        /* Tell prvResumeThread() a wake is needed, then sleep unless it
+         * resumed this thread in the meantime. */
+        ulExpected = portTHREAD_RUNNING;
+        if( ( __atomic_compare_exchange_n( &thread->ulState, &ulExpected, portTHREAD_WAITING,
+                                           pdFALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) ) ||
+            ( ulExpected == portTHREAD_WAITING ) )
+        {
+            (void)syscall( SYS_futex, &thread->ulState, FUTEX_WAIT_PRIVATE,
+                           portTHREAD_WAITING, NULL, NULL, 0 );
+        }
+    }
+#else
     event_wait(thread->ev);
+#endif
+
+#if ( portUSE_THREAD_POOL == 1 )
+    /* Resumed by vPortCancelThread(), the task has been deleted. */
+    if( __atomic_load_n( &thread->xCancel, __ATOMIC_ACQUIRE ) )
+    {
+        prvLeaveTask( thread );
+    }
+#endif
 }
 
 /*-----------------------------------------------------------*/
@@ -497,14 +1663,22 @@ static void prvResumeThread( Thread_t *xThreadId )
 {
     if ( pthread_self() != xThreadId->pthread )
     {
+#if ( portUSE_FUTEX_SWITCH == 1 )
+        if( __atomic_exchange_n( &xThreadId->ulState, portTHREAD_RESUMED, __ATOMIC_RELEASE ) == portTHREAD_WAITING )
+        {
+            (void)syscall( SYS_futex, &xThreadId->ulState, FUTEX_WAKE_PRIVATE,
+                           1, NULL, NULL, 0 );
+        }
+#else
         event_signal(xThreadId->ev);
+#endif
     }
 }
 /*-----------------------------------------------------------*/
 
 static void prvSetupSignalsAndSchedulerPolicy( void )
 {
-struct sigaction sigresume, sigtick;
+struct sigaction sigresume, sigtick, siginterrupt;
 int iRet;
 
     hMainThread = pthread_self();
@@ -514,8 +1688,12 @@ int iRet;
     sigaddset( &xResumeSignals, SIG_RESUME );
     sigfillset( &xAllSignals );
     /* Don't block SIGINT so this can be used to break into GDB while
-     * in a critical section. */
+     * in a critical section, nor the signals that terminate the
+     * simulator, which would otherwise stay blocked in every thread. */
     sigdelset( &xAllSignals, SIGINT );
+    sigdelset( &xAllSignals, SIGTERM );
+    sigdelset( &xAllSignals, SIGHUP );
+    sigdelset( &xAllSignals, SIGQUIT );
 
     /*
      * Block all signals in this thread so all new threads
@@ -527,6 +1705,20 @@ int iRet;
     (void)pthread_sigmask( SIG_SETMASK, &xAllSignals,
                            &xSchedulerOriginalSignalMask );
 
+#if ( portUSE_THREAD_POOL == 1 ) && ( portTHREAD_POOL_SIZE > 0 )
+    {
+    Thread_t *pxThread;
+    int i;
+
+        for( i = 0; i < portTHREAD_POOL_SIZE; i++ )
+        {
+            pxThread = prvCreatePoolThread();
+            pxThread->pxNextFree = pxFreeThreads;
+            pxFreeThreads = pxThread;
+        }
+    }
+#endif
+
     /* SIG_RESUME is only used with sigwait() so doesn't need a
        handler. */
     sigresume.sa_flags = 0;
@@ -548,6 +1740,16 @@ int iRet;
     {
         prvFatalError( "sigaction", errno );
     }
+
+    siginterrupt.sa_flags = 0;
+    siginterrupt.sa_handler = prvProcessSimulatedInterrupts;
+    sigfillset( &siginterrupt.sa_mask );
+
+    iRet = sigaction( SIG_INTERRUPT, &siginterrupt, NULL );
+    if ( iRet )
+    {
+        prvFatalError( "sigaction", errno );
+    }
 }
 /*-----------------------------------------------------------*/
 
@@ -34,6 +34,7 @@ extern "C" {
 #endif
 
 #include <limits.h>
+#include <sched.h>
 
 /*-----------------------------------------------------------
  * Port specific definitions.
@@ -123,9 +124,199 @@ extern void vPortCancelThread( void *pxTaskToDelete );
  */
 #define portMEMORY_BARRIER() __asm volatile( "" ::: "memory" )
 
-extern unsigned long ulPortGetRunTime( void );
-#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() /* no-op */
-#define portGET_RUN_TIME_COUNTER_VALUE()         ulPortGetRunTime()
+/* atomic.h declares its functions static portFORCE_INLINE, so the ones a
+ * file does not use are not reported as unused. */
+#ifndef portFORCE_INLINE
+    #define portFORCE_INLINE inline __attribute__( ( always_inline ) )
+#endif
+
+/*
+ * Simulated interrupts.
+ *
+ * vPortGenerateSimulatedInterrupt() may be called from any thread, including
+ * host threads that are not FreeRTOS tasks, to raise interrupt number
+ * ulInterruptNumber (0 to 31).  The handler installed for that number with
+ * vPortSetInterruptHandler() then runs as an ISR on the thread of the running
+ * task, as soon as it is outside of a critical section.  Handlers may only use
+ * the FromISR API and must return a non-zero value if a context switch is
+ * required.
+ *
+ * Host threads that raise interrupts must keep all signals blocked, for
+ * example by being created from inside a critical section.
+ */
+void vPortGenerateSimulatedInterrupt( uint32_t ulInterruptNumber );
+void vPortSetInterruptHandler( uint32_t ulInterruptNumber, uint32_t (*pvHandler)( void ) );
+/*-----------------------------------------------------------*/
+
+/*
+ * Set to 0 in FreeRTOSConfig.h to switch threads with the condition variables
+ * of utils/wait_for_event.c instead of a futex.  Only Linux has futexes.
+ */
+#ifndef portUSE_FUTEX_SWITCH
+    #ifdef __linux__
+        #define portUSE_FUTEX_SWITCH    1
+    #else
+        #define portUSE_FUTEX_SWITCH    0
+    #endif
+#endif
+
+/*
+ * Set to 0 in FreeRTOSConfig.h to create a thread for every task and cancel it
+ * when the task is deleted, instead of borrowing a parked thread from a pool
+ * and giving it back.  portTHREAD_POOL_SIZE threads are created up front, and
+ * the pool grows to the largest number of tasks that existed at the same time.
+ */
+#ifndef portUSE_THREAD_POOL
+    #ifdef __linux__
+        #define portUSE_THREAD_POOL     1
+    #else
+        #define portUSE_THREAD_POOL     0
+    #endif
+#endif
+
+#ifndef portTHREAD_POOL_SIZE
+    #define portTHREAD_POOL_SIZE        0
+#endif
+
+/*
+ * Set to 1 in FreeRTOSConfig.h to generate the tick from a host thread instead
+ * of SIGALRM, and to make critical sections a flag instead of two
+ * pthread_sigmask() calls.  No tick is lost when the process runs late.  The
+ * threads of the tasks then keep every signal but SIG_INTERRUPT blocked, even
+ * while they run.  Linux only.
+ */
+#ifndef portUSE_TICK_THREAD
+    #define portUSE_TICK_THREAD         0
+#endif
+
+#if ( portUSE_TICK_THREAD == 1 ) && !defined( __linux__ )
+    #error portUSE_TICK_THREAD requires Linux
+#endif
+
+/* Tickless idle (configUSE_TICKLESS_IDLE set to 1) needs the tick thread. */
+#if ( portUSE_TICK_THREAD == 1 )
+    extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+    #define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )    vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+
+/*
+ * Set to 1 to run on virtual time, as fast as possible: the tick count no
+ * longer follows the host clock, the idle task advances it straight to the
+ * next tick at which a task is due whenever every task is blocked.  Tasks take
+ * no time at all, so a task that never blocks stops the clock, and the same
+ * inputs always give the same schedule.  Requires the tick thread and
+ * configUSE_TICKLESS_IDLE, and the idle task then suppresses even one tick.
+ */
+#ifndef portUSE_VIRTUAL_TIME
+    #define portUSE_VIRTUAL_TIME        0
+#endif
+
+#if ( portUSE_VIRTUAL_TIME == 1 )
+    #if ( portUSE_TICK_THREAD == 0 )
+        #error portUSE_VIRTUAL_TIME requires portUSE_TICK_THREAD
+    #endif
+    #define portMIN_IDLE_TIME_BEFORE_SLEEP    1
+#endif
+/*-----------------------------------------------------------*/
+
+/*
+ * Host cores.  The tasks run one at a time, whatever the number of host CPUs:
+ * this is not an SMP port, there is a single current task and no core
+ * affinity, and the only per-core statistics are the busy times of the host
+ * cores.  vPortRunOnHostCore() runs pvFunction( pvParameters ) on one of
+ * portHOST_CORES host threads instead, concurrently with the tasks and with
+ * the other host cores, and blocks the calling task until it has returned.
+ * The function runs outside of the scheduler, like work handed to a
+ * coprocessor, and must not use the FreeRTOS API.  The task waits on task
+ * notification index portHOST_CORE_NOTIFY_INDEX, which it must not use for
+ * anything else, and the port handles the completions with simulated
+ * interrupt portHOST_CORE_INTERRUPT.
+ *
+ * The function runs in the calling task when portHOST_CORES is 0, before the
+ * scheduler starts, and on virtual time, where tasks take no time at all.
+ */
+#ifndef portHOST_CORES
+    #define portHOST_CORES              0
+#endif
+
+#ifndef portHOST_CORE_INTERRUPT
+    #define portHOST_CORE_INTERRUPT     31
+#endif
+
+#ifndef portHOST_CORE_NOTIFY_INDEX
+    #define portHOST_CORE_NOTIFY_INDEX  ( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+#endif
+
+void vPortRunOnHostCore( void (*pvFunction)( void * ), void *pvParameters );
+
+/* Host time host core uxCore has spent running functions, in nanoseconds. */
+uint64_t ullPortGetHostCoreBusyTime( UBaseType_t uxCore );
+/*-----------------------------------------------------------*/
+
+/*
+ * Host scheduling of the threads of the simulator.  By default they are normal
+ * threads that run on any host CPU.  For less tick jitter on a loaded host,
+ * set portHOST_SCHED_POLICY to SCHED_FIFO or SCHED_RR (needs CAP_SYS_NICE or
+ * an RLIMIT_RTPRIO), and pin the threads with the portHOST_*_CPUS masks of
+ * host CPUs (bit n for CPU n, 0 for any CPU).  Linux only.
+ *
+ * The real-time priorities are relative to portHOST_PRIORITY_BASE: the
+ * scheduler thread and the host cores at the base, a task at the base plus its
+ * FreeRTOS priority when it starts, the I/O threads above every task and the
+ * tick above everything.  Threads the policy cannot be applied to keep
+ * running as they are, after a warning.
+ *
+ * vPortSetHostThreadPolicy() applies the settings for eThread to the calling
+ * thread, uxPriority being the FreeRTOS priority of a task.  The port calls it
+ * for its own threads, drivers call it for their helper threads.
+ */
+typedef enum
+{
+    ePortThreadScheduler,   /* The thread that called vTaskStartScheduler(). */
+    ePortThreadTick,
+    ePortThreadTask,
+    ePortThreadHostCore,
+    ePortThreadIO           /* Helper threads of drivers, for I/O. */
+} ePortHostThread;
+
+#ifndef portHOST_SCHED_POLICY
+    #define portHOST_SCHED_POLICY       SCHED_OTHER
+#endif
+
+#ifndef portHOST_PRIORITY_BASE
+    #define portHOST_PRIORITY_BASE      1
+#endif
+
+#ifndef portHOST_SCHEDULER_CPUS
+    #define portHOST_SCHEDULER_CPUS     0ULL
+#endif
+
+#ifndef portHOST_TICK_CPUS
+    #define portHOST_TICK_CPUS          0ULL
+#endif
+
+#ifndef portHOST_TASK_CPUS
+    #define portHOST_TASK_CPUS          0ULL
+#endif
+
+#ifndef portHOST_CORE_CPUS
+    #define portHOST_CORE_CPUS          0ULL
+#endif
+
+#ifndef portHOST_IO_CPUS
+    #define portHOST_IO_CPUS            0ULL
+#endif
+
+void vPortSetHostThreadPolicy( ePortHostThread eThread, UBaseType_t uxPriority );
+/*-----------------------------------------------------------*/
+
+/* The application can provide its own run time stats clock by defining both
+macros in FreeRTOSConfig.h. */
+#ifndef portGET_RUN_TIME_COUNTER_VALUE
+    extern unsigned long ulPortGetRunTime( void );
+    #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() /* no-op */
+    #define portGET_RUN_TIME_COUNTER_VALUE()         ulPortGetRunTime()
+#endif
 
 #ifdef __cplusplus
 }
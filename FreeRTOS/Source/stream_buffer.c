@@ -38,6 +38,10 @@
 #include "task.h"
 #include "stream_buffer.h"
 
+#if ( configUSE_LOCK_FREE_STREAM_BUFFERS == 1 )
+    #include "atomic.h"
+#endif
+
 #if ( configUSE_TASK_NOTIFICATIONS != 1 )
     #error configUSE_TASK_NOTIFICATIONS must be set to 1 to build stream_buffer.c
 #endif
@@ -48,28 +52,49 @@
  * correct privileged Vs unprivileged linkage and placement. */
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750 !e9021. */
 
+/* The writer publishes the head, and the reader the tail, once the bytes
+ * they cover are written or read.  The other side of a lock free buffer reads
+ * them with acquire semantics, and the default notifications below only
+ * suspend the scheduler or mask interrupts once the other side is seen
+ * waiting.  The barrier taken before looking pairs with the one a blocking
+ * task takes after registering as waiting, so that either the task sees the
+ * bytes or the other side sees the task. */
+#if ( configUSE_LOCK_FREE_STREAM_BUFFERS == 1 )
+    #define sbLOAD_INDEX( pxIndex )               Atomic_LoadAcquire_size( pxIndex )
+    #define sbPUBLISH_INDEX( pxIndex, xIndex )    Atomic_StoreRelease_size( ( pxIndex ), ( xIndex ) )
+    #define sbTASK_MAY_BE_WAITING( xTask )        ( Atomic_FullBarrier(), ( ( xTask ) != NULL ) )
+#else
+    #define sbLOAD_INDEX( pxIndex )               ( *( pxIndex ) )
+    #define sbPUBLISH_INDEX( pxIndex, xIndex )    ( *( pxIndex ) = ( xIndex ) )
+    #define sbTASK_MAY_BE_WAITING( xTask )        ( pdTRUE )
+#endif
+
 /* If the user has not provided application specific Rx notification macros,
  * or #defined the notification macros away, them provide default implementations
  * that uses task notifications. */
 /*lint -save -e9026 Function like macros allowed and needed here so they can be overridden. */
 #ifndef sbRECEIVE_COMPLETED
-    #define sbRECEIVE_COMPLETED( pxStreamBuffer )                         \
-    vTaskSuspendAll();                                                    \
+    #define sbRECEIVE_COMPLETED( pxStreamBuffer )                             \
+    if( sbTASK_MAY_BE_WAITING( ( pxStreamBuffer )->xTaskWaitingToSend ) ) \
     {                                                                     \
-        if( ( pxStreamBuffer )->xTaskWaitingToSend != NULL )              \
+        vTaskSuspendAll();                                                \
         {                                                                 \
-            ( void ) xTaskNotify( ( pxStreamBuffer )->xTaskWaitingToSend, \
-                                  ( uint32_t ) 0,                         \
-                                  eNoAction );                            \
-            ( pxStreamBuffer )->xTaskWaitingToSend = NULL;                \
+            if( ( pxStreamBuffer )->xTaskWaitingToSend != NULL )          \
+            {                                                             \
+                ( void ) xTaskNotify( ( pxStreamBuffer )->xTaskWaitingToSend, \
+                                      ( uint32_t ) 0,                     \
+                                      eNoAction );                        \
+                ( pxStreamBuffer )->xTaskWaitingToSend = NULL;            \
+            }                                                             \
         }                                                                 \
-    }                                                                     \
-    ( void ) xTaskResumeAll();
+        ( void ) xTaskResumeAll();                                        \
+    }
 #endif /* sbRECEIVE_COMPLETED */
 
 #ifndef sbRECEIVE_COMPLETED_FROM_ISR
     #define sbRECEIVE_COMPLETED_FROM_ISR( pxStreamBuffer,                            \
                                           pxHigherPriorityTaskWoken )                \
+    if( sbTASK_MAY_BE_WAITING( ( pxStreamBuffer )->xTaskWaitingToSend ) )            \
     {                                                                                \
         UBaseType_t uxSavedInterruptStatus;                                          \
                                                                                      \
@@ -92,22 +117,26 @@
  * or #defined the notification macro away, them provide a default implementation
  * that uses task notifications. */
 #ifndef sbSEND_COMPLETED
-    #define sbSEND_COMPLETED( pxStreamBuffer )                               \
-    vTaskSuspendAll();                                                       \
+    #define sbSEND_COMPLETED( pxStreamBuffer )                                   \
+    if( sbTASK_MAY_BE_WAITING( ( pxStreamBuffer )->xTaskWaitingToReceive ) ) \
     {                                                                        \
-        if( ( pxStreamBuffer )->xTaskWaitingToReceive != NULL )              \
+        vTaskSuspendAll();                                                   \
         {                                                                    \
-            ( void ) xTaskNotify( ( pxStreamBuffer )->xTaskWaitingToReceive, \
-                                  ( uint32_t ) 0,                            \
-                                  eNoAction );                               \
-            ( pxStreamBuffer )->xTaskWaitingToReceive = NULL;                \
+            if( ( pxStreamBuffer )->xTaskWaitingToReceive != NULL )          \
+            {                                                                \
+                ( void ) xTaskNotify( ( pxStreamBuffer )->xTaskWaitingToReceive, \
+                                      ( uint32_t ) 0,                        \
+                                      eNoAction );                           \
+                ( pxStreamBuffer )->xTaskWaitingToReceive = NULL;            \
+            }                                                                \
         }                                                                    \
-    }                                                                        \
-    ( void ) xTaskResumeAll();
+        ( void ) xTaskResumeAll();                                           \
+    }
 #endif /* sbSEND_COMPLETED */
 
 #ifndef sbSEND_COMPLETE_FROM_ISR
     #define sbSEND_COMPLETE_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken )       \
+    if( sbTASK_MAY_BE_WAITING( ( pxStreamBuffer )->xTaskWaitingToReceive ) )            \
     {                                                                                   \
         UBaseType_t uxSavedInterruptStatus;                                             \
                                                                                         \
@@ -133,6 +162,7 @@
 /* Bits stored in the ucFlags field of the stream buffer. */
 #define sbFLAGS_IS_MESSAGE_BUFFER          ( ( uint8_t ) 1 ) /* Set if the stream buffer was created as a message buffer, in which case it holds discrete messages rather than a stream. */
 #define sbFLAGS_IS_STATICALLY_ALLOCATED    ( ( uint8_t ) 2 ) /* Set if the stream buffer was created using statically allocated memory. */
+#define sbFLAGS_IS_SHARED                  ( ( uint8_t ) 4 ) /* Set if the message buffer was created as a shared message buffer, which any number of tasks can write to and read from. */
 
 /*-----------------------------------------------------------*/
 
@@ -151,32 +181,104 @@ typedef struct StreamBufferDef_t                 /*lint !e9058 Style convention
     #if ( configUSE_TRACE_FACILITY == 1 )
         UBaseType_t uxStreamBufferNumber; /* Used for tracing purposes. */
     #endif
+
+    #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+        size_t xReservedHead;               /* Index the next writer of a shared message buffer reserves space from.  xHead follows once the writers before have written their messages. */
+        size_t xClaimedTail;                /* Index the next reader of a shared message buffer claims a message from.  xTail follows once the readers before have read their messages. */
+        List_t xWritesInProgress;           /* Regions of a shared message buffer being written, oldest first. */
+        List_t xReadsInProgress;            /* Regions of a shared message buffer being read, oldest first. */
+        EventList_t xTasksWaitingToSend;    /* Tasks blocked waiting for space in a shared message buffer.  Stored in priority order. */
+        EventList_t xTasksWaitingToReceive; /* Tasks blocked waiting for a message from a shared message buffer.  Stored in priority order. */
+        size_t xSpaceWanted;                /* The least space, including the message length, any task in xTasksWaitingToSend is waiting for. */
+    #endif
 } StreamBuffer_t;
 
+#if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+
+/* A region of a shared message buffer that a task is copying messages into or
+ * out of.  It lives on the stack of the task, in the list of regions in
+ * progress, until the task has copied the messages. */
+    typedef struct SharedRegion
+    {
+        ListItem_t xListItem;     /* Links the region into the regions in progress. */
+        size_t xEnd;              /* Index following the region. */
+        UBaseType_t uxMessages;   /* Number of messages in the region. */
+    } SharedRegion_t;
+
+#endif /* configUSE_SHARED_MESSAGE_BUFFERS */
+
 /*
  * The number of bytes available to be read from the buffer.
  */
 static size_t prvBytesInBuffer( const StreamBuffer_t * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
 
 /*
- * Add xCount bytes from pucData into the pxStreamBuffer message buffer.
- * Returns the number of bytes written, which will either equal xCount in the
- * success case, or 0 if there was not enough space in the buffer (in which case
- * no data is written into the buffer).
+ * Add xCount bytes from pucData into the pxStreamBuffer message buffer,
+ * starting at index xHead.  The caller has checked there is space for them.
+ * Returns the index following the bytes written, which the caller publishes
+ * as the new head once everything it writes is in the buffer.
  */
 static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer,
                                      const uint8_t * pucData,
-                                     size_t xCount ) PRIVILEGED_FUNCTION;
+                                     size_t xCount,
+                                     size_t xHead ) PRIVILEGED_FUNCTION;
+
+/*
+ * Gathers the first xCount bytes described by pxVectors into the buffer,
+ * starting at index xHead, using prvWriteBytesToBuffer().  Returns the index
+ * following the bytes written.
+ */
+static size_t prvWriteVectorsToBuffer( StreamBuffer_t * const pxStreamBuffer,
+                                       const StreamBufferVector_t * pxVectors,
+                                       size_t xCount,
+                                       size_t xHead ) PRIVILEGED_FUNCTION;
+
+/*
+ * Scatters xCount bytes, starting at index xTail, into the buffers described
+ * by pxVectors, using prvReadBytesFromBuffer().  Returns the index following
+ * the bytes read.
+ */
+static size_t prvReadVectorsFromBuffer( StreamBuffer_t * pxStreamBuffer,
+                                        const StreamBufferVector_t * pxVectors,
+                                        size_t xCount,
+                                        size_t xTail ) PRIVILEGED_FUNCTION;
+
+/*
+ * Blocks the calling task for up to xTicksToWait ticks until there are at
+ * least xRequiredSpace bytes free in the buffer.  Returns the free space.
+ */
+static size_t prvWaitForSpace( StreamBuffer_t * const pxStreamBuffer,
+                               size_t xRequiredSpace,
+                               TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Blocks the calling task for up to xTicksToWait ticks until there are more
+ * than xBytesToStoreMessageLength bytes in the buffer.  Returns the number of
+ * bytes in the buffer.
+ */
+static size_t prvWaitForData( StreamBuffer_t * const pxStreamBuffer,
+                              size_t xBytesToStoreMessageLength,
+                              TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Describes xCount bytes of the buffer's storage, starting at index xStart, as
+ * up to two spans, the second being the part that wraps back to the start of
+ * the storage.
+ */
+static void prvGetSpans( const StreamBuffer_t * const pxStreamBuffer,
+                         StreamBufferVector_t * const pxSpans,
+                         size_t xStart,
+                         size_t xCount ) PRIVILEGED_FUNCTION;
 
 /*
  * If the stream buffer is being used as a message buffer, then reads an entire
  * message out of the buffer.  If the stream buffer is being used as a stream
  * buffer then read as many bytes as possible from the buffer.
- * prvReadBytesFromBuffer() is called to actually extract the bytes from the
+ * prvReadVectorsFromBuffer() is called to actually extract the bytes from the
  * buffer's data storage area.
  */
 static size_t prvReadMessageFromBuffer( StreamBuffer_t * pxStreamBuffer,
-                                        void * pvRxData,
+                                        const StreamBufferVector_t * pxVectors,
                                         size_t xBufferLengthBytes,
                                         size_t xBytesAvailable,
                                         size_t xBytesToStoreMessageLength ) PRIVILEGED_FUNCTION;
@@ -185,23 +287,25 @@ static size_t prvReadMessageFromBuffer( StreamBuffer_t * pxStreamBuffer,
  * If the stream buffer is being used as a message buffer, then writes an entire
  * message to the buffer.  If the stream buffer is being used as a stream
  * buffer then write as many bytes as possible to the buffer.
- * prvWriteBytestoBuffer() is called to actually send the bytes to the buffer's
+ * prvWriteVectorsToBuffer() is called to actually send the bytes to the buffer's
  * data storage area.
  */
 static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
-                                       const void * pvTxData,
+                                       const StreamBufferVector_t * pxVectors,
                                        size_t xDataLengthBytes,
                                        size_t xSpace,
                                        size_t xRequiredSpace ) PRIVILEGED_FUNCTION;
 
 /*
- * Read xMaxCount bytes from the pxStreamBuffer message buffer and write them
- * to pucData.
+ * Read xCount bytes from the pxStreamBuffer message buffer, starting at index
+ * xTail, and write them to pucData.  The caller has checked there are that
+ * many bytes available.  Returns the index following the bytes read, which the
+ * caller publishes as the new tail to remove them from the buffer.
  */
 static size_t prvReadBytesFromBuffer( StreamBuffer_t * pxStreamBuffer,
                                       uint8_t * pucData,
-                                      size_t xMaxCount,
-                                      size_t xBytesAvailable ) PRIVILEGED_FUNCTION;
+                                      size_t xCount,
+                                      size_t xTail ) PRIVILEGED_FUNCTION;
 
 /*
  * Called by both pxStreamBufferCreate() and pxStreamBufferCreateStatic() to
@@ -213,6 +317,46 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
                                           size_t xTriggerLevelBytes,
                                           uint8_t ucFlags ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+
+/*
+ * Send to and receive from a shared message buffer.  The space for a message,
+ * or the message read, is reserved with the scheduler suspended, so several
+ * writers and readers can copy messages at the same time with the scheduler
+ * running.  The indexes that other tasks see only move once every region
+ * before them is copied too.
+ */
+    static size_t prvSendToSharedBuffer( StreamBuffer_t * const pxStreamBuffer,
+                                         const StreamBufferVector_t * pxVectors,
+                                         size_t xDataLengthBytes,
+                                         TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+    static size_t prvReceiveFromSharedBuffer( StreamBuffer_t * const pxStreamBuffer,
+                                              const StreamBufferVector_t * pxVectors,
+                                              size_t xBufferLengthBytes,
+                                              TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Removes pxRegion from the regions in progress once its messages are copied.
+ * If it is the oldest region, returns the number of messages the head or tail
+ * can move past and sets *pxEnd to the index to move it to.  Otherwise hands
+ * its messages on to the region in front of it, which moves the index past
+ * them when it is copied in turn, and returns 0.  Must be called with the
+ * scheduler suspended.
+ */
+    static UBaseType_t prvEndSharedRegion( List_t * const pxRegionsInProgress,
+                                           SharedRegion_t * const pxRegion,
+                                           size_t * const pxEnd ) PRIVILEGED_FUNCTION;
+
+/*
+ * The space in a shared message buffer that is neither holding messages not
+ * yet read nor reserved by a writer.  Must be called with the scheduler
+ * suspended.
+ */
+    static size_t prvSharedSpaceAvailable( const StreamBuffer_t * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_SHARED_MESSAGE_BUFFERS */
+
 /*-----------------------------------------------------------*/
 
 #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
@@ -234,6 +378,15 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
             ucFlags = sbFLAGS_IS_MESSAGE_BUFFER;
             configASSERT( xBufferSizeBytes > sbBYTES_TO_STORE_MESSAGE_LENGTH );
         }
+
+        #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+            else if( xIsMessageBuffer == sbTYPE_SHARED_MESSAGE_BUFFER )
+            {
+                /* Is a shared message buffer but not statically allocated. */
+                ucFlags = sbFLAGS_IS_MESSAGE_BUFFER | sbFLAGS_IS_SHARED;
+                configASSERT( xBufferSizeBytes > sbBYTES_TO_STORE_MESSAGE_LENGTH );
+            }
+        #endif
         else
         {
             /* Not a message buffer and not statically allocated. */
@@ -317,6 +470,19 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
         {
             /* Statically allocated message buffer. */
             ucFlags = sbFLAGS_IS_MESSAGE_BUFFER | sbFLAGS_IS_STATICALLY_ALLOCATED;
+
+            #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+                {
+                    if( xIsMessageBuffer == sbTYPE_SHARED_MESSAGE_BUFFER )
+                    {
+                        ucFlags |= sbFLAGS_IS_SHARED;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+            #endif
         }
         else
         {
@@ -423,6 +589,25 @@ BaseType_t xStreamBufferReset( StreamBufferHandle_t xStreamBuffer )
     /* Can only reset a message buffer if there are no tasks blocked on it. */
     taskENTER_CRITICAL();
     {
+        #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+            {
+                /* Nor, if it is shared, any task reading or writing it. */
+                if( ( listEVENT_LIST_IS_EMPTY( &( pxStreamBuffer->xTasksWaitingToReceive ) ) == pdFALSE ) ||
+                    ( listEVENT_LIST_IS_EMPTY( &( pxStreamBuffer->xTasksWaitingToSend ) ) == pdFALSE ) ||
+                    ( listLIST_IS_EMPTY( &( pxStreamBuffer->xWritesInProgress ) ) == pdFALSE ) ||
+                    ( listLIST_IS_EMPTY( &( pxStreamBuffer->xReadsInProgress ) ) == pdFALSE ) )
+                {
+                    taskEXIT_CRITICAL();
+
+                    return pdFAIL;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        #endif /* configUSE_SHARED_MESSAGE_BUFFERS */
+
         if( pxStreamBuffer->xTaskWaitingToReceive == NULL )
         {
             if( pxStreamBuffer->xTaskWaitingToSend == NULL )
@@ -487,8 +672,8 @@ size_t xStreamBufferSpacesAvailable( StreamBufferHandle_t xStreamBuffer )
 
     configASSERT( pxStreamBuffer );
 
-    xSpace = pxStreamBuffer->xLength + pxStreamBuffer->xTail;
-    xSpace -= pxStreamBuffer->xHead;
+    xSpace = pxStreamBuffer->xLength + sbLOAD_INDEX( &( pxStreamBuffer->xTail ) );
+    xSpace -= sbLOAD_INDEX( &( pxStreamBuffer->xHead ) );
     xSpace -= ( size_t ) 1;
 
     if( xSpace >= pxStreamBuffer->xLength )
@@ -520,19 +705,60 @@ size_t xStreamBufferSend( StreamBufferHandle_t xStreamBuffer,
                           const void * pvTxData,
                           size_t xDataLengthBytes,
                           TickType_t xTicksToWait )
+{
+    StreamBufferVector_t xVector;
+
+    configASSERT( pvTxData );
+
+    xVector.pvData = ( void * ) pvTxData; /*lint !e9005 The data is only read. */
+    xVector.xLength = xDataLengthBytes;
+
+    return xStreamBufferSendVectors( xStreamBuffer, &xVector, ( UBaseType_t ) 1, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendVectors( StreamBufferHandle_t xStreamBuffer,
+                                 const StreamBufferVector_t * pxVectors,
+                                 UBaseType_t uxVectorCount,
+                                 TickType_t xTicksToWait )
 {
     StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
-    size_t xReturn, xSpace = 0;
-    size_t xRequiredSpace = xDataLengthBytes;
-    TimeOut_t xTimeOut;
+    size_t xReturn, xSpace;
+    size_t xDataLengthBytes = 0, xRequiredSpace;
+    UBaseType_t uxVector;
 
     /* The maximum amount of space a stream buffer will ever report is its length
      * minus 1. */
     const size_t xMaxReportedSpace = pxStreamBuffer->xLength - ( size_t ) 1;
 
-    configASSERT( pvTxData );
+    configASSERT( pxVectors );
     configASSERT( pxStreamBuffer );
 
+    /* The data sent is the data of each vector in turn. */
+    for( uxVector = ( UBaseType_t ) 0; uxVector < uxVectorCount; uxVector++ )
+    {
+        configASSERT( ( pxVectors[ uxVector ].pvData != NULL ) || ( pxVectors[ uxVector ].xLength == ( size_t ) 0 ) );
+        xDataLengthBytes += pxVectors[ uxVector ].xLength;
+
+        /* Overflow? */
+        configASSERT( xDataLengthBytes >= pxVectors[ uxVector ].xLength );
+    }
+
+    xRequiredSpace = xDataLengthBytes;
+
+    #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+        {
+            if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_SHARED ) != ( uint8_t ) 0 )
+            {
+                return prvSendToSharedBuffer( pxStreamBuffer, pxVectors, xDataLengthBytes, xTicksToWait );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    #endif /* configUSE_SHARED_MESSAGE_BUFFERS */
+
     /* This send function is used to write to both message buffers and stream
      * buffers.  If this is a message buffer then the space needed must be
      * increased by the amount of bytes needed to store the length of the
@@ -572,55 +798,8 @@ size_t xStreamBufferSend( StreamBufferHandle_t xStreamBuffer,
         }
     }
 
-    if( xTicksToWait != ( TickType_t ) 0 )
-    {
-        vTaskSetTimeOutState( &xTimeOut );
-
-        do
-        {
-            /* Wait until the required number of bytes are free in the message
-             * buffer. */
-            taskENTER_CRITICAL();
-            {
-                xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
-
-                if( xSpace < xRequiredSpace )
-                {
-                    /* Clear notification state as going to wait for space. */
-                    ( void ) xTaskNotifyStateClear( NULL );
-
-                    /* Should only be one writer. */
-                    configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
-                    pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
-                }
-                else
-                {
-                    taskEXIT_CRITICAL();
-                    break;
-                }
-            }
-            taskEXIT_CRITICAL();
-
-            traceBLOCKING_ON_STREAM_BUFFER_SEND( xStreamBuffer );
-            ( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
-            pxStreamBuffer->xTaskWaitingToSend = NULL;
-        } while( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE );
-    }
-    else
-    {
-        mtCOVERAGE_TEST_MARKER();
-    }
-
-    if( xSpace == ( size_t ) 0 )
-    {
-        xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
-    }
-    else
-    {
-        mtCOVERAGE_TEST_MARKER();
-    }
-
-    xReturn = prvWriteMessageToBuffer( pxStreamBuffer, pvTxData, xDataLengthBytes, xSpace, xRequiredSpace );
+    xSpace = prvWaitForSpace( pxStreamBuffer, xRequiredSpace, xTicksToWait );
+    xReturn = prvWriteMessageToBuffer( pxStreamBuffer, pxVectors, xDataLengthBytes, xSpace, xRequiredSpace );
 
     if( xReturn > ( size_t ) 0 )
     {
@@ -654,9 +833,14 @@ size_t xStreamBufferSendFromISR( StreamBufferHandle_t xStreamBuffer,
     StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
     size_t xReturn, xSpace;
     size_t xRequiredSpace = xDataLengthBytes;
+    StreamBufferVector_t xVector;
 
     configASSERT( pvTxData );
     configASSERT( pxStreamBuffer );
+    #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+        /* Only tasks can use a shared message buffer. */
+        configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_SHARED ) == ( uint8_t ) 0 );
+    #endif
 
     /* This send function is used to write to both message buffers and stream
      * buffers.  If this is a message buffer then the space needed must be
@@ -671,8 +855,11 @@ size_t xStreamBufferSendFromISR( StreamBufferHandle_t xStreamBuffer,
         mtCOVERAGE_TEST_MARKER();
     }
 
+    xVector.pvData = ( void * ) pvTxData; /*lint !e9005 The data is only read. */
+    xVector.xLength = xDataLengthBytes;
+
     xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
-    xReturn = prvWriteMessageToBuffer( pxStreamBuffer, pvTxData, xDataLengthBytes, xSpace, xRequiredSpace );
+    xReturn = prvWriteMessageToBuffer( pxStreamBuffer, &xVector, xDataLengthBytes, xSpace, xRequiredSpace );
 
     if( xReturn > ( size_t ) 0 )
     {
@@ -697,14 +884,84 @@ size_t xStreamBufferSendFromISR( StreamBufferHandle_t xStreamBuffer,
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_LOCK_FREE_STREAM_BUFFERS == 1 )
+
+    size_t xStreamBufferSendLockFree( StreamBufferHandle_t xStreamBuffer,
+                                      const void * pvTxData,
+                                      size_t xDataLengthBytes,
+                                      BaseType_t * const pxTaskWaiting )
+    {
+        StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+        size_t xReturn, xSpace;
+        size_t xRequiredSpace = xDataLengthBytes;
+        BaseType_t xTaskWaiting = pdFALSE;
+        StreamBufferVector_t xVector;
+
+        configASSERT( pvTxData );
+        configASSERT( pxStreamBuffer );
+        configASSERT( pxTaskWaiting );
+        #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+            /* Only tasks can use a shared message buffer. */
+            configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_SHARED ) == ( uint8_t ) 0 );
+        #endif
+
+        if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+        {
+            xRequiredSpace += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        xVector.pvData = ( void * ) pvTxData; /*lint !e9005 The data is only read. */
+        xVector.xLength = xDataLengthBytes;
+
+        xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+        xReturn = prvWriteMessageToBuffer( pxStreamBuffer, &xVector, xDataLengthBytes, xSpace, xRequiredSpace );
+
+        if( xReturn > ( size_t ) 0 )
+        {
+            /* Was a task waiting for the data?  This function cannot notify
+             * it, so leaves that to xStreamBufferSendCompletedFromISR(). */
+            if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+            {
+                if( sbTASK_MAY_BE_WAITING( pxStreamBuffer->xTaskWaitingToReceive ) )
+                {
+                    xTaskWaiting = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        *pxTaskWaiting = xTaskWaiting;
+
+        return xReturn;
+    }
+
+#endif /* configUSE_LOCK_FREE_STREAM_BUFFERS */
+/*-----------------------------------------------------------*/
+
 static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
-                                       const void * pvTxData,
+                                       const StreamBufferVector_t * pxVectors,
                                        size_t xDataLengthBytes,
                                        size_t xSpace,
                                        size_t xRequiredSpace )
 {
     BaseType_t xShouldWrite;
     size_t xReturn;
+    size_t xNextHead = pxStreamBuffer->xHead;
 
     if( xSpace == ( size_t ) 0 )
     {
@@ -727,7 +984,7 @@ static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
          * into the buffer.  Start by writing the length of the data, the data
          * itself will be written later in this function. */
         xShouldWrite = pdTRUE;
-        ( void ) prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &( xDataLengthBytes ), sbBYTES_TO_STORE_MESSAGE_LENGTH );
+        xNextHead = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &( xDataLengthBytes ), sbBYTES_TO_STORE_MESSAGE_LENGTH, xNextHead );
     }
     else
     {
@@ -737,8 +994,11 @@ static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
 
     if( xShouldWrite != pdFALSE )
     {
-        /* Writes the data itself. */
-        xReturn = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) pvTxData, xDataLengthBytes ); /*lint !e9079 Storage buffer is implemented as uint8_t for ease of sizing, alignment and access. */
+        /* Writes the data itself, then publishes it together with its length,
+         * so a reader never sees one without the other. */
+        xNextHead = prvWriteVectorsToBuffer( pxStreamBuffer, pxVectors, xDataLengthBytes, xNextHead );
+        sbPUBLISH_INDEX( &( pxStreamBuffer->xHead ), xNextHead );
+        xReturn = xDataLengthBytes;
     }
     else
     {
@@ -753,76 +1013,70 @@ size_t xStreamBufferReceive( StreamBufferHandle_t xStreamBuffer,
                              void * pvRxData,
                              size_t xBufferLengthBytes,
                              TickType_t xTicksToWait )
+{
+    StreamBufferVector_t xVector;
+
+    configASSERT( pvRxData );
+
+    xVector.pvData = pvRxData;
+    xVector.xLength = xBufferLengthBytes;
+
+    return xStreamBufferReceiveVectors( xStreamBuffer, &xVector, ( UBaseType_t ) 1, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveVectors( StreamBufferHandle_t xStreamBuffer,
+                                    const StreamBufferVector_t * pxVectors,
+                                    UBaseType_t uxVectorCount,
+                                    TickType_t xTicksToWait )
 {
     StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
     size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
+    size_t xBufferLengthBytes = 0;
+    UBaseType_t uxVector;
 
-    configASSERT( pvRxData );
+    configASSERT( pxVectors );
     configASSERT( pxStreamBuffer );
 
-    /* This receive function is used by both message buffers, which store
-     * discrete messages, and stream buffers, which store a continuous stream of
-     * bytes.  Discrete messages include an additional
-     * sbBYTES_TO_STORE_MESSAGE_LENGTH bytes that hold the length of the
-     * message. */
-    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
-    {
-        xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
-    }
-    else
+    /* The data received fills the buffer of each vector in turn. */
+    for( uxVector = ( UBaseType_t ) 0; uxVector < uxVectorCount; uxVector++ )
     {
-        xBytesToStoreMessageLength = 0;
+        configASSERT( ( pxVectors[ uxVector ].pvData != NULL ) || ( pxVectors[ uxVector ].xLength == ( size_t ) 0 ) );
+        xBufferLengthBytes += pxVectors[ uxVector ].xLength;
+
+        /* Overflow? */
+        configASSERT( xBufferLengthBytes >= pxVectors[ uxVector ].xLength );
     }
 
-    if( xTicksToWait != ( TickType_t ) 0 )
-    {
-        /* Checking if there is data and clearing the notification state must be
-         * performed atomically. */
-        taskENTER_CRITICAL();
+    #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
         {
-            xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
-
-            /* If this function was invoked by a message buffer read then
-             * xBytesToStoreMessageLength holds the number of bytes used to hold
-             * the length of the next discrete message.  If this function was
-             * invoked by a stream buffer read then xBytesToStoreMessageLength will
-             * be 0. */
-            if( xBytesAvailable <= xBytesToStoreMessageLength )
+            if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_SHARED ) != ( uint8_t ) 0 )
             {
-                /* Clear notification state as going to wait for data. */
-                ( void ) xTaskNotifyStateClear( NULL );
-
-                /* Should only be one reader. */
-                configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
-                pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+                return prvReceiveFromSharedBuffer( pxStreamBuffer, pxVectors, xBufferLengthBytes, xTicksToWait );
             }
             else
             {
                 mtCOVERAGE_TEST_MARKER();
             }
         }
-        taskEXIT_CRITICAL();
-
-        if( xBytesAvailable <= xBytesToStoreMessageLength )
-        {
-            /* Wait for data to be available. */
-            traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( xStreamBuffer );
-            ( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
-            pxStreamBuffer->xTaskWaitingToReceive = NULL;
+    #endif /* configUSE_SHARED_MESSAGE_BUFFERS */
 
-            /* Recheck the data available after blocking. */
-            xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
-        }
-        else
-        {
-            mtCOVERAGE_TEST_MARKER();
-        }
+    /* This receive function is used by both message buffers, which store
+     * discrete messages, and stream buffers, which store a continuous stream of
+     * bytes.  Discrete messages include an additional
+     * sbBYTES_TO_STORE_MESSAGE_LENGTH bytes that hold the length of the
+     * message. */
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+    {
+        xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
     }
     else
     {
-        xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+        xBytesToStoreMessageLength = 0;
     }
 
+    xBytesAvailable = prvWaitForData( pxStreamBuffer, xBytesToStoreMessageLength, xTicksToWait );
+
     /* Whether receiving a discrete message (where xBytesToStoreMessageLength
      * holds the number of bytes used to store the message length) or a stream of
      * bytes (where xBytesToStoreMessageLength is zero), the number of bytes
@@ -830,7 +1084,7 @@ size_t xStreamBufferReceive( StreamBufferHandle_t xStreamBuffer,
      * read bytes from the buffer. */
     if( xBytesAvailable > xBytesToStoreMessageLength )
     {
-        xReceivedLength = prvReadMessageFromBuffer( pxStreamBuffer, pvRxData, xBufferLengthBytes, xBytesAvailable, xBytesToStoreMessageLength );
+        xReceivedLength = prvReadMessageFromBuffer( pxStreamBuffer, pxVectors, xBufferLengthBytes, xBytesAvailable, xBytesToStoreMessageLength );
 
         /* Was a task waiting for space in the buffer? */
         if( xReceivedLength != ( size_t ) 0 )
@@ -856,11 +1110,42 @@ size_t xStreamBufferReceive( StreamBufferHandle_t xStreamBuffer,
 size_t xStreamBufferNextMessageLengthBytes( StreamBufferHandle_t xStreamBuffer )
 {
     StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
-    size_t xReturn, xBytesAvailable, xOriginalTail;
+    size_t xReturn, xBytesAvailable;
     configMESSAGE_BUFFER_LENGTH_TYPE xTempReturn;
 
     configASSERT( pxStreamBuffer );
 
+    #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+        {
+            /* The next message of a shared message buffer is the next one not
+             * claimed by a reader yet. */
+            if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_SHARED ) != ( uint8_t ) 0 )
+            {
+                xReturn = 0;
+
+                vTaskSuspendAll();
+                {
+                    if( pxStreamBuffer->xClaimedTail != pxStreamBuffer->xHead )
+                    {
+                        ( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempReturn, sbBYTES_TO_STORE_MESSAGE_LENGTH, pxStreamBuffer->xClaimedTail );
+                        xReturn = ( size_t ) xTempReturn;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                ( void ) xTaskResumeAll();
+
+                return xReturn;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    #endif /* configUSE_SHARED_MESSAGE_BUFFERS */
+
     /* Ensure the stream buffer is being used as a message buffer. */
     if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
     {
@@ -871,13 +1156,9 @@ size_t xStreamBufferNextMessageLengthBytes( StreamBufferHandle_t xStreamBuffer )
             /* The number of bytes available is greater than the number of bytes
              * required to hold the length of the next message, so another message
              * is available.  Return its length without removing the length bytes
-             * from the buffer.  A copy of the tail is stored so the buffer can be
-             * returned to its prior state as the message is not actually being
-             * removed from the buffer. */
-            xOriginalTail = pxStreamBuffer->xTail;
-            ( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempReturn, sbBYTES_TO_STORE_MESSAGE_LENGTH, xBytesAvailable );
+             * from the buffer, by not publishing the tail that follows them. */
+            ( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempReturn, sbBYTES_TO_STORE_MESSAGE_LENGTH, pxStreamBuffer->xTail );
             xReturn = ( size_t ) xTempReturn;
-            pxStreamBuffer->xTail = xOriginalTail;
         }
         else
         {
@@ -905,9 +1186,14 @@ size_t xStreamBufferReceiveFromISR( StreamBufferHandle_t xStreamBuffer,
 {
     StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
     size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
+    StreamBufferVector_t xVector;
 
     configASSERT( pvRxData );
     configASSERT( pxStreamBuffer );
+    #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+        /* Only tasks can use a shared message buffer. */
+        configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_SHARED ) == ( uint8_t ) 0 );
+    #endif
 
     /* This receive function is used by both message buffers, which store
      * discrete messages, and stream buffers, which store a continuous stream of
@@ -932,7 +1218,9 @@ size_t xStreamBufferReceiveFromISR( StreamBufferHandle_t xStreamBuffer,
      * read bytes from the buffer. */
     if( xBytesAvailable > xBytesToStoreMessageLength )
     {
-        xReceivedLength = prvReadMessageFromBuffer( pxStreamBuffer, pvRxData, xBufferLengthBytes, xBytesAvailable, xBytesToStoreMessageLength );
+        xVector.pvData = pvRxData;
+        xVector.xLength = xBufferLengthBytes;
+        xReceivedLength = prvReadMessageFromBuffer( pxStreamBuffer, &xVector, xBufferLengthBytes, xBytesAvailable, xBytesToStoreMessageLength );
 
         /* Was a task waiting for space in the buffer? */
         if( xReceivedLength != ( size_t ) 0 )
@@ -955,56 +1243,697 @@ size_t xStreamBufferReceiveFromISR( StreamBufferHandle_t xStreamBuffer,
 }
 /*-----------------------------------------------------------*/
 
-static size_t prvReadMessageFromBuffer( StreamBuffer_t * pxStreamBuffer,
-                                        void * pvRxData,
-                                        size_t xBufferLengthBytes,
-                                        size_t xBytesAvailable,
-                                        size_t xBytesToStoreMessageLength )
-{
-    size_t xOriginalTail, xReceivedLength, xNextMessageLength;
-    configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
+#if ( configUSE_LOCK_FREE_STREAM_BUFFERS == 1 )
 
-    if( xBytesToStoreMessageLength != ( size_t ) 0 )
+    size_t xStreamBufferReceiveLockFree( StreamBufferHandle_t xStreamBuffer,
+                                         void * pvRxData,
+                                         size_t xBufferLengthBytes,
+                                         BaseType_t * const pxTaskWaiting )
     {
-        /* A discrete message is being received.  First receive the length
-         * of the message.  A copy of the tail is stored so the buffer can be
-         * returned to its prior state if the length of the message is too
-         * large for the provided buffer. */
-        xOriginalTail = pxStreamBuffer->xTail;
-        ( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, xBytesToStoreMessageLength, xBytesAvailable );
-        xNextMessageLength = ( size_t ) xTempNextMessageLength;
-
-        /* Reduce the number of bytes available by the number of bytes just
-         * read out. */
-        xBytesAvailable -= xBytesToStoreMessageLength;
+        StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+        size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
+        BaseType_t xTaskWaiting = pdFALSE;
+        StreamBufferVector_t xVector;
+
+        configASSERT( pvRxData );
+        configASSERT( pxStreamBuffer );
+        configASSERT( pxTaskWaiting );
+        #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+            /* Only tasks can use a shared message buffer. */
+            configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_SHARED ) == ( uint8_t ) 0 );
+        #endif
 
-        /* Check there is enough space in the buffer provided by the
-         * user. */
-        if( xNextMessageLength > xBufferLengthBytes )
+        if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+        {
+            xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
+        }
+        else
+        {
+            xBytesToStoreMessageLength = 0;
+        }
+
+        xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+        if( xBytesAvailable > xBytesToStoreMessageLength )
+        {
+            xVector.pvData = pvRxData;
+            xVector.xLength = xBufferLengthBytes;
+            xReceivedLength = prvReadMessageFromBuffer( pxStreamBuffer, &xVector, xBufferLengthBytes, xBytesAvailable, xBytesToStoreMessageLength );
+
+            /* Was a task waiting for space in the buffer?  This function
+             * cannot notify it, so leaves that to
+             * xStreamBufferReceiveCompletedFromISR(). */
+            if( xReceivedLength != ( size_t ) 0 )
+            {
+                if( sbTASK_MAY_BE_WAITING( pxStreamBuffer->xTaskWaitingToSend ) )
+                {
+                    xTaskWaiting = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        *pxTaskWaiting = xTaskWaiting;
+
+        return xReceivedLength;
+    }
+
+#endif /* configUSE_LOCK_FREE_STREAM_BUFFERS */
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferGetWritableSpans( StreamBufferHandle_t xStreamBuffer,
+                                      StreamBufferVector_t pxSpans[ 2 ],
+                                      size_t xBytesWanted,
+                                      TickType_t xTicksToWait )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xSpace;
+
+    configASSERT( pxStreamBuffer );
+    configASSERT( pxSpans );
+
+    /* Message lengths are written by the send functions, so only stream
+     * buffers hand out their storage. */
+    configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( uint8_t ) 0 );
+
+    /* The buffer never has more than its length minus 1 bytes free. */
+    xBytesWanted = configMIN( xBytesWanted, pxStreamBuffer->xLength - ( size_t ) 1 );
+
+    xSpace = prvWaitForSpace( pxStreamBuffer, xBytesWanted, xTicksToWait );
+    prvGetSpans( pxStreamBuffer, pxSpans, pxStreamBuffer->xHead, xSpace );
+
+    return xSpace;
+}
+/*-----------------------------------------------------------*/
+
+void vStreamBufferProduce( StreamBufferHandle_t xStreamBuffer,
+                           size_t xBytesWritten )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xNextHead;
+
+    configASSERT( pxStreamBuffer );
+    configASSERT( xBytesWritten <= xStreamBufferSpacesAvailable( pxStreamBuffer ) );
+
+    if( xBytesWritten > ( size_t ) 0 )
+    {
+        xNextHead = pxStreamBuffer->xHead + xBytesWritten;
+
+        if( xNextHead >= pxStreamBuffer->xLength )
+        {
+            xNextHead -= pxStreamBuffer->xLength;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        sbPUBLISH_INDEX( &( pxStreamBuffer->xHead ), xNextHead );
+        traceSTREAM_BUFFER_SEND( xStreamBuffer, xBytesWritten );
+
+        /* Was a task waiting for the data? */
+        if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+        {
+            sbSEND_COMPLETED( pxStreamBuffer );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vStreamBufferProduceFromISR( StreamBufferHandle_t xStreamBuffer,
+                                  size_t xBytesWritten,
+                                  BaseType_t * const pxHigherPriorityTaskWoken )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xNextHead;
+
+    configASSERT( pxStreamBuffer );
+    configASSERT( xBytesWritten <= xStreamBufferSpacesAvailable( pxStreamBuffer ) );
+
+    if( xBytesWritten > ( size_t ) 0 )
+    {
+        xNextHead = pxStreamBuffer->xHead + xBytesWritten;
+
+        if( xNextHead >= pxStreamBuffer->xLength )
+        {
+            xNextHead -= pxStreamBuffer->xLength;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        sbPUBLISH_INDEX( &( pxStreamBuffer->xHead ), xNextHead );
+
+        /* Was a task waiting for the data? */
+        if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+        {
+            sbSEND_COMPLETE_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    traceSTREAM_BUFFER_SEND_FROM_ISR( xStreamBuffer, xBytesWritten );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferGetReadableSpans( StreamBufferHandle_t xStreamBuffer,
+                                      StreamBufferVector_t pxSpans[ 2 ],
+                                      size_t xBytesWanted,
+                                      TickType_t xTicksToWait )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xBytesAvailable;
+
+    configASSERT( pxStreamBuffer );
+    configASSERT( pxSpans );
+    configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( uint8_t ) 0 );
+
+    /* Wait while there are fewer than xBytesWanted bytes, and at least while
+     * there are none. */
+    xBytesWanted = configMIN( xBytesWanted, pxStreamBuffer->xLength - ( size_t ) 1 );
+
+    if( xBytesWanted == ( size_t ) 0 )
+    {
+        xBytesWanted = 1;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    xBytesAvailable = prvWaitForData( pxStreamBuffer, xBytesWanted - ( size_t ) 1, xTicksToWait );
+    prvGetSpans( pxStreamBuffer, pxSpans, pxStreamBuffer->xTail, xBytesAvailable );
+
+    return xBytesAvailable;
+}
+/*-----------------------------------------------------------*/
+
+void vStreamBufferConsume( StreamBufferHandle_t xStreamBuffer,
+                           size_t xBytesRead )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xNextTail;
+
+    configASSERT( pxStreamBuffer );
+    configASSERT( xBytesRead <= prvBytesInBuffer( pxStreamBuffer ) );
+
+    if( xBytesRead > ( size_t ) 0 )
+    {
+        xNextTail = pxStreamBuffer->xTail + xBytesRead;
+
+        if( xNextTail >= pxStreamBuffer->xLength )
+        {
+            xNextTail -= pxStreamBuffer->xLength;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        sbPUBLISH_INDEX( &( pxStreamBuffer->xTail ), xNextTail );
+        traceSTREAM_BUFFER_RECEIVE( xStreamBuffer, xBytesRead );
+
+        /* Was a task waiting for space in the buffer? */
+        sbRECEIVE_COMPLETED( pxStreamBuffer );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vStreamBufferConsumeFromISR( StreamBufferHandle_t xStreamBuffer,
+                                  size_t xBytesRead,
+                                  BaseType_t * const pxHigherPriorityTaskWoken )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xNextTail;
+
+    configASSERT( pxStreamBuffer );
+    configASSERT( xBytesRead <= prvBytesInBuffer( pxStreamBuffer ) );
+
+    if( xBytesRead > ( size_t ) 0 )
+    {
+        xNextTail = pxStreamBuffer->xTail + xBytesRead;
+
+        if( xNextTail >= pxStreamBuffer->xLength )
+        {
+            xNextTail -= pxStreamBuffer->xLength;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        sbPUBLISH_INDEX( &( pxStreamBuffer->xTail ), xNextTail );
+
+        /* Was a task waiting for space in the buffer? */
+        sbRECEIVE_COMPLETED_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    traceSTREAM_BUFFER_RECEIVE_FROM_ISR( xStreamBuffer, xBytesRead );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReadMessageFromBuffer( StreamBuffer_t * pxStreamBuffer,
+                                        const StreamBufferVector_t * pxVectors,
+                                        size_t xBufferLengthBytes,
+                                        size_t xBytesAvailable,
+                                        size_t xBytesToStoreMessageLength )
+{
+    size_t xReceivedLength, xNextMessageLength;
+    size_t xNextTail = pxStreamBuffer->xTail;
+    configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
+
+    if( xBytesToStoreMessageLength != ( size_t ) 0 )
+    {
+        /* A discrete message is being received.  First receive the length
+         * of the message.  The tail is only published once the message is
+         * read, so the length stays in the buffer if the message is too large
+         * for the provided buffer. */
+        xNextTail = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, xBytesToStoreMessageLength, xNextTail );
+        xNextMessageLength = ( size_t ) xTempNextMessageLength;
+
+        /* Reduce the number of bytes available by the number of bytes just
+         * read out. */
+        xBytesAvailable -= xBytesToStoreMessageLength;
+
+        /* Check there is enough space in the buffer provided by the
+         * user. */
+        if( xNextMessageLength > xBufferLengthBytes )
         {
             /* The user has provided insufficient space to read the message
-             * so return the buffer to its previous state (so the length of
-             * the message is in the buffer again). */
-            pxStreamBuffer->xTail = xOriginalTail;
+             * so leave it in the buffer. */
             xNextMessageLength = 0;
         }
         else
         {
-            mtCOVERAGE_TEST_MARKER();
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        /* A stream of bytes is being received (as opposed to a discrete
+         * message), so read as many bytes as possible. */
+        xNextMessageLength = xBufferLengthBytes;
+    }
+
+    /* Use the minimum of the wanted bytes and the available bytes. */
+    xReceivedLength = configMIN( xBytesAvailable, xNextMessageLength );
+
+    if( xReceivedLength > ( size_t ) 0 )
+    {
+        /* Read the actual data, then publish the tail to remove it, and its
+         * length, from the buffer. */
+        xNextTail = prvReadVectorsFromBuffer( pxStreamBuffer, pxVectors, xReceivedLength, xNextTail );
+        sbPUBLISH_INDEX( &( pxStreamBuffer->xTail ), xNextTail );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReceivedLength;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+
+    static size_t prvSendToSharedBuffer( StreamBuffer_t * const pxStreamBuffer,
+                                         const StreamBufferVector_t * pxVectors,
+                                         size_t xDataLengthBytes,
+                                         TickType_t xTicksToWait )
+    {
+        SharedRegion_t xRegion;
+        TimeOut_t xTimeOut;
+        BaseType_t xEntryTimeSet = pdFALSE;
+        size_t xReturn = 0, xSpace, xStart = 0, xNextHead;
+        const size_t xRequiredSpace = xDataLengthBytes + sbBYTES_TO_STORE_MESSAGE_LENGTH;
+        UBaseType_t uxMessages;
+
+        configASSERT( xDataLengthBytes > ( size_t ) 0 );
+
+        /* A message larger than the buffer will never fit, so is not waited
+         * for.  Overflow of xRequiredSpace is caught here too. */
+        if( ( xRequiredSpace >= pxStreamBuffer->xLength ) || ( xRequiredSpace < xDataLengthBytes ) )
+        {
+            xTicksToWait = ( TickType_t ) 0;
+            xDataLengthBytes = pxStreamBuffer->xLength;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        vTaskSuspendAll();
+
+        for( ; ; )
+        {
+            xSpace = prvSharedSpaceAvailable( pxStreamBuffer );
+
+            if( ( xSpace >= xRequiredSpace ) && ( xDataLengthBytes < pxStreamBuffer->xLength ) )
+            {
+                /* Reserve the space, and queue the region behind the regions
+                 * other writers have reserved and not written yet. */
+                xStart = pxStreamBuffer->xReservedHead;
+                xNextHead = xStart + xRequiredSpace;
+
+                if( xNextHead >= pxStreamBuffer->xLength )
+                {
+                    xNextHead -= pxStreamBuffer->xLength;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                pxStreamBuffer->xReservedHead = xNextHead;
+
+                vListInitialiseItem( &( xRegion.xListItem ) );
+                listSET_LIST_ITEM_OWNER( &( xRegion.xListItem ), &xRegion );
+                xRegion.xEnd = xNextHead;
+                xRegion.uxMessages = ( UBaseType_t ) 1;
+                vListInsertEnd( &( pxStreamBuffer->xWritesInProgress ), &( xRegion.xListItem ) );
+
+                xReturn = xDataLengthBytes;
+                break;
+            }
+            else if( xTicksToWait == ( TickType_t ) 0 )
+            {
+                break;
+            }
+            else if( xEntryTimeSet == pdFALSE )
+            {
+                vTaskInternalSetTimeOutState( &xTimeOut );
+                xEntryTimeSet = pdTRUE;
+            }
+            else if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+            {
+                break;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* Wait for a reader to free space.  No interrupt uses the event
+             * list, so the scheduler being suspended is enough to place the
+             * task on it.  Readers only wake the writers once there is as
+             * much space as the least any of them wants. */
+            if( ( listEVENT_LIST_IS_EMPTY( &( pxStreamBuffer->xTasksWaitingToSend ) ) != pdFALSE ) ||
+                ( xRequiredSpace < pxStreamBuffer->xSpaceWanted ) )
+            {
+                pxStreamBuffer->xSpaceWanted = xRequiredSpace;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            traceBLOCKING_ON_STREAM_BUFFER_SEND( pxStreamBuffer );
+            vTaskPlaceOnEventList( &( pxStreamBuffer->xTasksWaitingToSend ), xTicksToWait );
+
+            if( xTaskResumeAll() == pdFALSE )
+            {
+                portYIELD_WITHIN_API();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            vTaskSuspendAll();
+        }
+
+        ( void ) xTaskResumeAll();
+
+        if( xReturn > ( size_t ) 0 )
+        {
+            /* Copy the message in with the scheduler running. */
+            xNextHead = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &( xDataLengthBytes ), sbBYTES_TO_STORE_MESSAGE_LENGTH, xStart );
+            ( void ) prvWriteVectorsToBuffer( pxStreamBuffer, pxVectors, xDataLengthBytes, xNextHead );
+
+            vTaskSuspendAll();
+            {
+                uxMessages = prvEndSharedRegion( &( pxStreamBuffer->xWritesInProgress ), &xRegion, &xNextHead );
+
+                if( uxMessages > ( UBaseType_t ) 0 )
+                {
+                    pxStreamBuffer->xHead = xNextHead;
+
+                    /* Each message can unblock one reader. */
+                    while( ( uxMessages > ( UBaseType_t ) 0 ) &&
+                           ( listEVENT_LIST_IS_EMPTY( &( pxStreamBuffer->xTasksWaitingToReceive ) ) == pdFALSE ) )
+                    {
+                        taskENTER_CRITICAL();
+                        {
+                            ( void ) xTaskRemoveFromEventList( &( pxStreamBuffer->xTasksWaitingToReceive ) );
+                        }
+                        taskEXIT_CRITICAL();
+                        uxMessages--;
+                    }
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            ( void ) xTaskResumeAll();
+
+            traceSTREAM_BUFFER_SEND( pxStreamBuffer, xReturn );
+        }
+        else
+        {
+            traceSTREAM_BUFFER_SEND_FAILED( pxStreamBuffer );
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static size_t prvReceiveFromSharedBuffer( StreamBuffer_t * const pxStreamBuffer,
+                                              const StreamBufferVector_t * pxVectors,
+                                              size_t xBufferLengthBytes,
+                                              TickType_t xTicksToWait )
+    {
+        SharedRegion_t xRegion;
+        TimeOut_t xTimeOut;
+        BaseType_t xEntryTimeSet = pdFALSE;
+        size_t xReceivedLength = 0, xStart = 0, xNextTail;
+        configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
+
+        vTaskSuspendAll();
+
+        for( ; ; )
+        {
+            if( pxStreamBuffer->xClaimedTail != pxStreamBuffer->xHead )
+            {
+                /* A message is available.  If it fits, claim it, and queue the
+                 * region behind the messages other readers have claimed and
+                 * not read yet.  If it does not, leave it for a reader with a
+                 * larger buffer. */
+                xStart = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, pxStreamBuffer->xClaimedTail );
+
+                if( ( size_t ) xTempNextMessageLength <= xBufferLengthBytes )
+                {
+                    xReceivedLength = ( size_t ) xTempNextMessageLength;
+                    xNextTail = xStart + xReceivedLength;
+
+                    if( xNextTail >= pxStreamBuffer->xLength )
+                    {
+                        xNextTail -= pxStreamBuffer->xLength;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+
+                    pxStreamBuffer->xClaimedTail = xNextTail;
+
+                    vListInitialiseItem( &( xRegion.xListItem ) );
+                    listSET_LIST_ITEM_OWNER( &( xRegion.xListItem ), &xRegion );
+                    xRegion.xEnd = xNextTail;
+                    xRegion.uxMessages = ( UBaseType_t ) 1;
+                    vListInsertEnd( &( pxStreamBuffer->xReadsInProgress ), &( xRegion.xListItem ) );
+                }
+                else if( listEVENT_LIST_IS_EMPTY( &( pxStreamBuffer->xTasksWaitingToReceive ) ) == pdFALSE )
+                {
+                    /* This task may have been unblocked for the message, so
+                     * pass that on to another reader. */
+                    taskENTER_CRITICAL();
+                    {
+                        ( void ) xTaskRemoveFromEventList( &( pxStreamBuffer->xTasksWaitingToReceive ) );
+                    }
+                    taskEXIT_CRITICAL();
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                break;
+            }
+            else if( xTicksToWait == ( TickType_t ) 0 )
+            {
+                break;
+            }
+            else if( xEntryTimeSet == pdFALSE )
+            {
+                vTaskInternalSetTimeOutState( &xTimeOut );
+                xEntryTimeSet = pdTRUE;
+            }
+            else if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+            {
+                break;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* Wait for a writer to send a message. */
+            traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( pxStreamBuffer );
+            vTaskPlaceOnEventList( &( pxStreamBuffer->xTasksWaitingToReceive ), xTicksToWait );
+
+            if( xTaskResumeAll() == pdFALSE )
+            {
+                portYIELD_WITHIN_API();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            vTaskSuspendAll();
+        }
+
+        ( void ) xTaskResumeAll();
+
+        if( xReceivedLength > ( size_t ) 0 )
+        {
+            /* Copy the message out with the scheduler running. */
+            ( void ) prvReadVectorsFromBuffer( pxStreamBuffer, pxVectors, xReceivedLength, xStart );
+
+            vTaskSuspendAll();
+            {
+                if( prvEndSharedRegion( &( pxStreamBuffer->xReadsInProgress ), &xRegion, &xNextTail ) > ( UBaseType_t ) 0 )
+                {
+                    pxStreamBuffer->xTail = xNextTail;
+
+                    /* The writers wait for different amounts of space, so once
+                     * the least of them fits, all of them check again. */
+                    if( prvSharedSpaceAvailable( pxStreamBuffer ) >= pxStreamBuffer->xSpaceWanted )
+                    {
+                        while( listEVENT_LIST_IS_EMPTY( &( pxStreamBuffer->xTasksWaitingToSend ) ) == pdFALSE )
+                        {
+                            taskENTER_CRITICAL();
+                            {
+                                ( void ) xTaskRemoveFromEventList( &( pxStreamBuffer->xTasksWaitingToSend ) );
+                            }
+                            taskEXIT_CRITICAL();
+                        }
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            ( void ) xTaskResumeAll();
+
+            traceSTREAM_BUFFER_RECEIVE( pxStreamBuffer, xReceivedLength );
+        }
+        else
+        {
+            traceSTREAM_BUFFER_RECEIVE_FAILED( pxStreamBuffer );
         }
+
+        return xReceivedLength;
     }
-    else
+/*-----------------------------------------------------------*/
+
+    static UBaseType_t prvEndSharedRegion( List_t * const pxRegionsInProgress,
+                                           SharedRegion_t * const pxRegion,
+                                           size_t * const pxEnd )
     {
-        /* A stream of bytes is being received (as opposed to a discrete
-         * message), so read as many bytes as possible. */
-        xNextMessageLength = xBufferLengthBytes;
+        SharedRegion_t * pxRegionInFront;
+        UBaseType_t uxMessages;
+
+        if( listGET_HEAD_ENTRY( pxRegionsInProgress ) == &( pxRegion->xListItem ) )
+        {
+            *pxEnd = pxRegion->xEnd;
+            uxMessages = pxRegion->uxMessages;
+        }
+        else
+        {
+            pxRegionInFront = ( SharedRegion_t * ) listGET_LIST_ITEM_OWNER( pxRegion->xListItem.pxPrevious );
+            pxRegionInFront->xEnd = pxRegion->xEnd;
+            pxRegionInFront->uxMessages += pxRegion->uxMessages;
+            uxMessages = 0;
+        }
+
+        ( void ) uxListRemove( &( pxRegion->xListItem ) );
+
+        return uxMessages;
     }
+/*-----------------------------------------------------------*/
 
-    /* Read the actual data. */
-    xReceivedLength = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) pvRxData, xNextMessageLength, xBytesAvailable ); /*lint !e9079 Data storage area is implemented as uint8_t array for ease of sizing, indexing and alignment. */
+    static size_t prvSharedSpaceAvailable( const StreamBuffer_t * const pxStreamBuffer )
+    {
+        size_t xSpace;
 
-    return xReceivedLength;
-}
+        xSpace = pxStreamBuffer->xLength + pxStreamBuffer->xTail;
+        xSpace -= pxStreamBuffer->xReservedHead + ( size_t ) 1;
+
+        if( xSpace >= pxStreamBuffer->xLength )
+        {
+            xSpace -= pxStreamBuffer->xLength;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return xSpace;
+    }
+
+#endif /* configUSE_SHARED_MESSAGE_BUFFERS */
 /*-----------------------------------------------------------*/
 
 BaseType_t xStreamBufferIsEmpty( StreamBufferHandle_t xStreamBuffer )
@@ -1016,9 +1945,9 @@ BaseType_t xStreamBufferIsEmpty( StreamBufferHandle_t xStreamBuffer )
     configASSERT( pxStreamBuffer );
 
     /* True if no bytes are available. */
-    xTail = pxStreamBuffer->xTail;
+    xTail = sbLOAD_INDEX( &( pxStreamBuffer->xTail ) );
 
-    if( pxStreamBuffer->xHead == xTail )
+    if( sbLOAD_INDEX( &( pxStreamBuffer->xHead ) ) == xTail )
     {
         xReturn = pdTRUE;
     }
@@ -1130,22 +2059,21 @@ BaseType_t xStreamBufferReceiveCompletedFromISR( StreamBufferHandle_t xStreamBuf
 
 static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer,
                                      const uint8_t * pucData,
-                                     size_t xCount )
+                                     size_t xCount,
+                                     size_t xHead )
 {
-    size_t xNextHead, xFirstLength;
+    size_t xFirstLength;
 
     configASSERT( xCount > ( size_t ) 0 );
 
-    xNextHead = pxStreamBuffer->xHead;
-
     /* Calculate the number of bytes that can be added in the first write -
      * which may be less than the total number of bytes that need to be added if
      * the buffer will wrap back to the beginning. */
-    xFirstLength = configMIN( pxStreamBuffer->xLength - xNextHead, xCount );
+    xFirstLength = configMIN( pxStreamBuffer->xLength - xHead, xCount );
 
     /* Write as many bytes as can be written in the first write. */
-    configASSERT( ( xNextHead + xFirstLength ) <= pxStreamBuffer->xLength );
-    ( void ) memcpy( ( void * ) ( &( pxStreamBuffer->pucBuffer[ xNextHead ] ) ), ( const void * ) pucData, xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+    configASSERT( ( xHead + xFirstLength ) <= pxStreamBuffer->xLength );
+    ( void ) memcpy( ( void * ) ( &( pxStreamBuffer->pucBuffer[ xHead ] ) ), ( const void * ) pucData, xFirstLength ); /*lint !e9087 memcpy() requires void *. */
 
     /* If the number of bytes written was less than the number that could be
      * written in the first write... */
@@ -1160,78 +2088,127 @@ static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer,
         mtCOVERAGE_TEST_MARKER();
     }
 
-    xNextHead += xCount;
+    xHead += xCount;
 
-    if( xNextHead >= pxStreamBuffer->xLength )
+    if( xHead >= pxStreamBuffer->xLength )
     {
-        xNextHead -= pxStreamBuffer->xLength;
+        xHead -= pxStreamBuffer->xLength;
     }
     else
     {
         mtCOVERAGE_TEST_MARKER();
     }
 
-    pxStreamBuffer->xHead = xNextHead;
-
-    return xCount;
+    return xHead;
 }
 /*-----------------------------------------------------------*/
 
-static size_t prvReadBytesFromBuffer( StreamBuffer_t * pxStreamBuffer,
-                                      uint8_t * pucData,
-                                      size_t xMaxCount,
-                                      size_t xBytesAvailable )
+static size_t prvWriteVectorsToBuffer( StreamBuffer_t * const pxStreamBuffer,
+                                       const StreamBufferVector_t * pxVectors,
+                                       size_t xCount,
+                                       size_t xHead )
 {
-    size_t xCount, xFirstLength, xNextTail;
+    size_t xVectorLength;
 
-    /* Use the minimum of the wanted bytes and the available bytes. */
-    xCount = configMIN( xBytesAvailable, xMaxCount );
+    configASSERT( xCount > ( size_t ) 0 );
 
-    if( xCount > ( size_t ) 0 )
+    while( xCount > ( size_t ) 0 )
     {
-        xNextTail = pxStreamBuffer->xTail;
+        xVectorLength = configMIN( pxVectors->xLength, xCount );
 
-        /* Calculate the number of bytes that can be read - which may be
-         * less than the number wanted if the data wraps around to the start of
-         * the buffer. */
-        xFirstLength = configMIN( pxStreamBuffer->xLength - xNextTail, xCount );
-
-        /* Obtain the number of bytes it is possible to obtain in the first
-         * read.  Asserts check bounds of read and write. */
-        configASSERT( xFirstLength <= xMaxCount );
-        configASSERT( ( xNextTail + xFirstLength ) <= pxStreamBuffer->xLength );
-        ( void ) memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xNextTail ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
-
-        /* If the total number of wanted bytes is greater than the number
-         * that could be read in the first read... */
-        if( xCount > xFirstLength )
+        if( xVectorLength > ( size_t ) 0 )
         {
-            /*...then read the remaining bytes from the start of the buffer. */
-            configASSERT( xCount <= xMaxCount );
-            ( void ) memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( void * ) ( pxStreamBuffer->pucBuffer ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+            xHead = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) pxVectors->pvData, xVectorLength, xHead ); /*lint !e9079 Storage buffer is implemented as uint8_t for ease of sizing, alignment and access. */
+            xCount -= xVectorLength;
         }
         else
         {
             mtCOVERAGE_TEST_MARKER();
         }
 
-        /* Move the tail pointer to effectively remove the data read from
-         * the buffer. */
-        xNextTail += xCount;
+        pxVectors++;
+    }
 
-        if( xNextTail >= pxStreamBuffer->xLength )
-        {
-            xNextTail -= pxStreamBuffer->xLength;
-        }
+    return xHead;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReadBytesFromBuffer( StreamBuffer_t * pxStreamBuffer,
+                                      uint8_t * pucData,
+                                      size_t xCount,
+                                      size_t xTail )
+{
+    size_t xFirstLength;
+
+    configASSERT( xCount > ( size_t ) 0 );
+
+    /* Calculate the number of bytes that can be read - which may be
+     * less than the number wanted if the data wraps around to the start of
+     * the buffer. */
+    xFirstLength = configMIN( pxStreamBuffer->xLength - xTail, xCount );
+
+    /* Obtain the number of bytes it is possible to obtain in the first
+     * read.  Asserts check bounds of read and write. */
+    configASSERT( ( xTail + xFirstLength ) <= pxStreamBuffer->xLength );
+    ( void ) memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xTail ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+
+    /* If the total number of wanted bytes is greater than the number
+     * that could be read in the first read... */
+    if( xCount > xFirstLength )
+    {
+        /*...then read the remaining bytes from the start of the buffer. */
+        configASSERT( ( xCount - xFirstLength ) <= pxStreamBuffer->xLength );
+        ( void ) memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( void * ) ( pxStreamBuffer->pucBuffer ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
 
-        pxStreamBuffer->xTail = xNextTail;
+    /* Move the tail index past the data read.  The caller publishes it to
+     * effectively remove the data from the buffer. */
+    xTail += xCount;
+
+    if( xTail >= pxStreamBuffer->xLength )
+    {
+        xTail -= pxStreamBuffer->xLength;
     }
     else
     {
         mtCOVERAGE_TEST_MARKER();
     }
 
-    return xCount;
+    return xTail;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReadVectorsFromBuffer( StreamBuffer_t * pxStreamBuffer,
+                                        const StreamBufferVector_t * pxVectors,
+                                        size_t xCount,
+                                        size_t xTail )
+{
+    size_t xVectorLength;
+
+    configASSERT( xCount > ( size_t ) 0 );
+
+    while( xCount > ( size_t ) 0 )
+    {
+        xVectorLength = configMIN( pxVectors->xLength, xCount );
+
+        if( xVectorLength > ( size_t ) 0 )
+        {
+            xTail = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) pxVectors->pvData, xVectorLength, xTail ); /*lint !e9079 Data storage area is implemented as uint8_t array for ease of sizing, indexing and alignment. */
+            xCount -= xVectorLength;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        pxVectors++;
+    }
+
+    return xTail;
 }
 /*-----------------------------------------------------------*/
 
@@ -1240,8 +2217,8 @@ static size_t prvBytesInBuffer( const StreamBuffer_t * const pxStreamBuffer )
 /* Returns the distance between xTail and xHead. */
     size_t xCount;
 
-    xCount = pxStreamBuffer->xLength + pxStreamBuffer->xHead;
-    xCount -= pxStreamBuffer->xTail;
+    xCount = pxStreamBuffer->xLength + sbLOAD_INDEX( &( pxStreamBuffer->xHead ) );
+    xCount -= sbLOAD_INDEX( &( pxStreamBuffer->xTail ) );
 
     if( xCount >= pxStreamBuffer->xLength )
     {
@@ -1256,6 +2233,190 @@ static size_t prvBytesInBuffer( const StreamBuffer_t * const pxStreamBuffer )
 }
 /*-----------------------------------------------------------*/
 
+static size_t prvWaitForSpace( StreamBuffer_t * const pxStreamBuffer,
+                               size_t xRequiredSpace,
+                               TickType_t xTicksToWait )
+{
+    size_t xSpace;
+    TimeOut_t xTimeOut;
+
+    /* Only the writer takes space, so there is no need to enter a critical
+     * section, even to note the time, while there is enough. */
+    xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+
+    if( ( xSpace < xRequiredSpace ) && ( xTicksToWait != ( TickType_t ) 0 ) )
+    {
+        vTaskSetTimeOutState( &xTimeOut );
+
+        do
+        {
+            /* Wait until the required number of bytes are free in the message
+             * buffer. */
+            taskENTER_CRITICAL();
+            {
+                xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+
+                if( xSpace < xRequiredSpace )
+                {
+                    /* Clear notification state as going to wait for space. */
+                    ( void ) xTaskNotifyStateClear( NULL );
+
+                    /* Should only be one writer. */
+                    configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
+                    pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
+                }
+                else
+                {
+                    taskEXIT_CRITICAL();
+                    break;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            #if ( configUSE_LOCK_FREE_STREAM_BUFFERS == 1 )
+                {
+                    /* A reader that does not enter critical sections may
+                     * have made room without seeing this task waiting. */
+                    Atomic_FullBarrier();
+                    xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+
+                    if( xSpace >= xRequiredSpace )
+                    {
+                        pxStreamBuffer->xTaskWaitingToSend = NULL;
+                        break;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+            #endif /* configUSE_LOCK_FREE_STREAM_BUFFERS */
+
+            traceBLOCKING_ON_STREAM_BUFFER_SEND( pxStreamBuffer );
+            ( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+            pxStreamBuffer->xTaskWaitingToSend = NULL;
+        } while( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xSpace;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvWaitForData( StreamBuffer_t * const pxStreamBuffer,
+                              size_t xBytesToStoreMessageLength,
+                              TickType_t xTicksToWait )
+{
+    size_t xBytesAvailable;
+
+    if( xTicksToWait != ( TickType_t ) 0 )
+    {
+        /* Only the reader takes data, so there is no need to enter a critical
+         * section while there is some.  When reading a message buffer
+         * xBytesToStoreMessageLength holds the number of bytes used to hold
+         * the length of the next discrete message.  When reading a stream
+         * buffer it is 0. */
+        xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+        if( xBytesAvailable <= xBytesToStoreMessageLength )
+        {
+            /* Checking if there is data and clearing the notification state
+             * must be performed atomically. */
+            taskENTER_CRITICAL();
+            {
+                xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+                if( xBytesAvailable <= xBytesToStoreMessageLength )
+                {
+                    /* Clear notification state as going to wait for data. */
+                    ( void ) xTaskNotifyStateClear( NULL );
+
+                    /* Should only be one reader. */
+                    configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+                    pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            #if ( configUSE_LOCK_FREE_STREAM_BUFFERS == 1 )
+                {
+                    /* A writer that does not enter critical sections may have
+                     * sent data without seeing this task waiting. */
+                    if( xBytesAvailable <= xBytesToStoreMessageLength )
+                    {
+                        Atomic_FullBarrier();
+                        xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+                        if( xBytesAvailable > xBytesToStoreMessageLength )
+                        {
+                            pxStreamBuffer->xTaskWaitingToReceive = NULL;
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+            #endif /* configUSE_LOCK_FREE_STREAM_BUFFERS */
+
+            if( xBytesAvailable <= xBytesToStoreMessageLength )
+            {
+                /* Wait for data to be available. */
+                traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( pxStreamBuffer );
+                ( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+                pxStreamBuffer->xTaskWaitingToReceive = NULL;
+
+                /* Recheck the data available after blocking. */
+                xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+    }
+
+    return xBytesAvailable;
+}
+/*-----------------------------------------------------------*/
+
+static void prvGetSpans( const StreamBuffer_t * const pxStreamBuffer,
+                         StreamBufferVector_t * const pxSpans,
+                         size_t xStart,
+                         size_t xCount )
+{
+    size_t xFirstLength;
+
+    /* The first span runs up to the end of the storage at most, the second
+     * holds the rest from the start of the storage. */
+    xFirstLength = configMIN( pxStreamBuffer->xLength - xStart, xCount );
+
+    pxSpans[ 0 ].pvData = ( void * ) &( pxStreamBuffer->pucBuffer[ xStart ] );
+    pxSpans[ 0 ].xLength = xFirstLength;
+    pxSpans[ 1 ].pvData = ( void * ) pxStreamBuffer->pucBuffer;
+    pxSpans[ 1 ].xLength = xCount - xFirstLength;
+}
+/*-----------------------------------------------------------*/
+
 static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
                                           uint8_t * const pucBuffer,
                                           size_t xBufferSizeBytes,
@@ -1280,6 +2441,15 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
     pxStreamBuffer->xLength = xBufferSizeBytes;
     pxStreamBuffer->xTriggerLevelBytes = xTriggerLevelBytes;
     pxStreamBuffer->ucFlags = ucFlags;
+
+    #if ( configUSE_SHARED_MESSAGE_BUFFERS == 1 )
+        {
+            vListInitialise( &( pxStreamBuffer->xWritesInProgress ) );
+            vListInitialise( &( pxStreamBuffer->xReadsInProgress ) );
+            vListInitialiseEventList( &( pxStreamBuffer->xTasksWaitingToSend ) );
+            vListInitialiseEventList( &( pxStreamBuffer->xTasksWaitingToReceive ) );
+        }
+    #endif
 }
 
 #if ( configUSE_TRACE_FACILITY == 1 )
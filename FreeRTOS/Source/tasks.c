@@ -113,7 +113,7 @@
     #define configIDLE_TASK_NAME    "IDLE"
 #endif
 
-#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
+#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 ) && ( configUSE_BITMAP_TASK_SELECTION == 0 )
 
 /* If configUSE_PORT_OPTIMISED_TASK_SELECTION is 0 then task selection is
  * performed in a generic way that is not optimised to any particular
@@ -156,6 +156,61 @@
     #define taskRESET_READY_PRIORITY( uxPriority )
     #define portRESET_READY_PRIORITY( uxPriority, uxTopReadyPriority )
 
+#elif ( configUSE_BITMAP_TASK_SELECTION == 1 )
+
+/* If configUSE_BITMAP_TASK_SELECTION is 1 then bit ( uxPriority % taskBITMAP_BITS )
+ * of uxReadyPriorities[ uxPriority / taskBITMAP_BITS ] is set while priority
+ * uxPriority has ready tasks, and bit n of uxTopReadyPriority is set while
+ * uxReadyPriorities[ n ] is not 0.  The highest ready priority is then found
+ * with two count leading zeros, whatever the number of priorities. */
+    #define taskBITMAP_BITS             ( sizeof( UBaseType_t ) * ( size_t ) 8 )
+    #define taskBITMAP_WORDS            ( ( configMAX_PRIORITIES + taskBITMAP_BITS - 1 ) / taskBITMAP_BITS )
+    #define taskBITMAP_BIT( uxBit )     ( ( UBaseType_t ) 1 << ( uxBit ) )
+    #define taskBITMAP_TOP( uxBits )    ( ( UBaseType_t ) ( 63 - __builtin_clzll( ( unsigned long long ) ( uxBits ) ) ) )
+
+    #define taskRECORD_READY_PRIORITY( uxPriority )                                                             \
+    {                                                                                                           \
+        uxReadyPriorities[ ( uxPriority ) / taskBITMAP_BITS ] |= taskBITMAP_BIT( ( uxPriority ) % taskBITMAP_BITS ); \
+        uxTopReadyPriority |= taskBITMAP_BIT( ( uxPriority ) / taskBITMAP_BITS );                                \
+    } /* taskRECORD_READY_PRIORITY */
+
+/*-----------------------------------------------------------*/
+
+    #define taskSELECT_HIGHEST_PRIORITY_TASK()                                                  \
+    {                                                                                           \
+        UBaseType_t uxTopWord;                                                                  \
+        UBaseType_t uxTopPriority;                                                              \
+                                                                                                \
+        /* Find the highest priority list that contains ready tasks.  The idle \
+         * task is always ready. */                                                             \
+        configASSERT( uxTopReadyPriority != 0 );                                                \
+        uxTopWord = taskBITMAP_TOP( uxTopReadyPriority );                                       \
+        uxTopPriority = ( uxTopWord * taskBITMAP_BITS ) + taskBITMAP_TOP( uxReadyPriorities[ uxTopWord ] ); \
+        configASSERT( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ uxTopPriority ] ) ) > 0 ); \
+        listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );   \
+    } /* taskSELECT_HIGHEST_PRIORITY_TASK() */
+
+/*-----------------------------------------------------------*/
+
+/* Only called once the ready list of uxPriority is known to be empty. */
+    #define portRESET_READY_PRIORITY( uxPriority, uxTopReadyPriority )                                           \
+    {                                                                                                            \
+        uxReadyPriorities[ ( uxPriority ) / taskBITMAP_BITS ] &= ~taskBITMAP_BIT( ( uxPriority ) % taskBITMAP_BITS ); \
+                                                                                                                 \
+        if( uxReadyPriorities[ ( uxPriority ) / taskBITMAP_BITS ] == ( UBaseType_t ) 0 )                        \
+        {                                                                                                        \
+            ( uxTopReadyPriority ) &= ~taskBITMAP_BIT( ( uxPriority ) / taskBITMAP_BITS );                       \
+        }                                                                                                        \
+    }
+
+    #define taskRESET_READY_PRIORITY( uxPriority )                                                     \
+    {                                                                                                  \
+        if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ ( uxPriority ) ] ) ) == ( UBaseType_t ) 0 ) \
+        {                                                                                              \
+            portRESET_READY_PRIORITY( ( uxPriority ), ( uxTopReadyPriority ) );                        \
+        }                                                                                              \
+    }
+
 #else /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
 
 /* If configUSE_PORT_OPTIMISED_TASK_SELECTION is 1 then task selection is
@@ -212,6 +267,51 @@
 
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+/* Each level of the timing wheel has taskWHEEL_SLOTS slots.  A level 0 slot
+ * holds the tasks waking at one tick, a level 1 slot the tasks waking in one
+ * span of taskWHEEL_SLOTS ticks.  One bit per slot records the slots that may
+ * hold tasks. */
+    #define taskWHEEL_SLOTS           ( ( UBaseType_t ) 1U << configTIMING_WHEEL_BITS )
+    #define taskWHEEL_MASK            ( taskWHEEL_SLOTS - ( UBaseType_t ) 1U )
+    #define taskWHEEL_BITMAP_WORDS    ( taskWHEEL_SLOTS / ( UBaseType_t ) 32U )
+
+/* Tasks waking within taskWHEEL_SPAN ticks go in the wheel, the others in the
+ * sorted delayed lists. */
+    #define taskWHEEL_SPAN            ( ( TickType_t ) taskWHEEL_SLOTS * ( TickType_t ) taskWHEEL_SLOTS )
+
+/* uxWheelSlotsUsed counts the bits set in both levels, so that an empty
+ * wheel is known without reading the whole bitmap. */
+    #define taskWHEEL_SLOT_BIT( uxSlot )    ( 1UL << ( ( uxSlot ) & 31U ) )
+
+    #define taskWHEEL_SET_SLOT_BIT( uxLevel, uxSlot )                                                   \
+    {                                                                                                   \
+        if( ( ulWheelBitmap[ ( uxLevel ) ][ ( uxSlot ) >> 5 ] & taskWHEEL_SLOT_BIT( uxSlot ) ) == 0U )  \
+        {                                                                                               \
+            ulWheelBitmap[ ( uxLevel ) ][ ( uxSlot ) >> 5 ] |= taskWHEEL_SLOT_BIT( uxSlot );            \
+            uxWheelSlotsUsed++;                                                                         \
+        }                                                                                               \
+    }
+
+    #define taskWHEEL_CLEAR_SLOT_BIT( uxLevel, uxSlot )                                                 \
+    {                                                                                                   \
+        if( ( ulWheelBitmap[ ( uxLevel ) ][ ( uxSlot ) >> 5 ] & taskWHEEL_SLOT_BIT( uxSlot ) ) != 0U )  \
+        {                                                                                               \
+            ulWheelBitmap[ ( uxLevel ) ][ ( uxSlot ) >> 5 ] &= ~taskWHEEL_SLOT_BIT( uxSlot );           \
+            uxWheelSlotsUsed--;                                                                         \
+        }                                                                                               \
+    }
+
+/* Is pxList one of the slots of the timing wheel? */
+    #define taskLIST_IS_WHEEL_SLOT( pxList )                                 \
+    ( ( ( pxList ) >= &( xWheelSlots[ 0 ][ 0 ] ) ) &&                      \
+      ( ( pxList ) <= &( xWheelSlots[ 1 ][ taskWHEEL_MASK ] ) ) )
+
+#endif /* configUSE_TIMING_WHEEL */
+
+/*-----------------------------------------------------------*/
+
 /*
  * Place the task represented by pxTCB into the appropriate ready list for
  * the task.  It is inserted at the end of the list.
@@ -348,6 +448,15 @@ PRIVILEGED_DATA static List_t * volatile pxDelayedTaskList;              /*< Poi
 PRIVILEGED_DATA static List_t * volatile pxOverflowDelayedTaskList;      /*< Points to the delayed task list currently being used to hold tasks that have overflowed the current tick count. */
 PRIVILEGED_DATA static List_t xPendingReadyList;                         /*< Tasks that have been readied while the scheduler was suspended.  They will be moved to the ready list when the scheduler is resumed. */
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+    PRIVILEGED_DATA static List_t xWheelSlots[ 2 ][ taskWHEEL_SLOTS ];           /*< Delayed tasks waking within taskWHEEL_SPAN ticks, level 0 by tick and level 1 by span of taskWHEEL_SLOTS ticks. */
+    PRIVILEGED_DATA static uint32_t ulWheelBitmap[ 2 ][ taskWHEEL_BITMAP_WORDS ]; /*< Slots that may not be empty.  Bits are cleared when an empty slot is found. */
+    PRIVILEGED_DATA static UBaseType_t uxWheelSlotsUsed = ( UBaseType_t ) 0U;     /*< Bits set in ulWheelBitmap. */
+    PRIVILEGED_DATA static TickType_t xWheelTime = ( TickType_t ) 0U;              /*< The wheel has been advanced up to this tick. */
+
+#endif
+
 #if ( INCLUDE_vTaskDelete == 1 )
 
     PRIVILEGED_DATA static List_t xTasksWaitingTermination; /*< Tasks that have been deleted - but their memory not yet freed. */
@@ -371,6 +480,9 @@ PRIVILEGED_DATA static List_t xPendingReadyList;                         /*< Tas
 PRIVILEGED_DATA static volatile UBaseType_t uxCurrentNumberOfTasks = ( UBaseType_t ) 0U;
 PRIVILEGED_DATA static volatile TickType_t xTickCount = ( TickType_t ) configINITIAL_TICK_COUNT;
 PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriority = tskIDLE_PRIORITY;
+#if ( configUSE_BITMAP_TASK_SELECTION == 1 )
+    PRIVILEGED_DATA static volatile UBaseType_t uxReadyPriorities[ taskBITMAP_WORDS ] = { 0 };
+#endif
 PRIVILEGED_DATA static volatile BaseType_t xSchedulerRunning = pdFALSE;
 PRIVILEGED_DATA static volatile TickType_t xPendedTicks = ( TickType_t ) 0U;
 PRIVILEGED_DATA static volatile BaseType_t xYieldPending = pdFALSE;
@@ -525,6 +637,32 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
  */
 static void prvResetNextTaskUnblockTime( void ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+/*
+ * Places a delayed list item in the timing wheel, in O(1), and brings
+ * xNextTaskUnblockTime forward if needed.  Returns pdFALSE, leaving the item
+ * alone, if xTimeToWake is too far ahead for the wheel.
+ */
+    static BaseType_t prvWheelInsert( ListItem_t * pxItem,
+                                      TickType_t xTimeToWake,
+                                      TickType_t xConstTickCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Unblocks the tasks of the wheel that are due at xConstTickCount.  Returns
+ * pdTRUE if a context switch is required.
+ */
+    static BaseType_t prvWheelAdvance( TickType_t xConstTickCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns the earliest tick at which the wheel may have a task to unblock, or
+ * portMAX_DELAY if there is none before the tick count overflows.  Can be
+ * earlier than the wake time of any task, which is harmless.
+ */
+    static TickType_t prvWheelNextUnblockTime( void ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMING_WHEEL */
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
 
 /*
@@ -1408,6 +1546,13 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                 eReturn = eBlocked;
             }
 
+            #if ( configUSE_TIMING_WHEEL == 1 )
+                else if( taskLIST_IS_WHEEL_SLOT( pxStateList ) )
+                {
+                    eReturn = eBlocked;
+                }
+            #endif
+
             #if ( INCLUDE_vTaskSuspend == 1 )
                 else if( pxStateList == &xSuspendedTaskList )
                 {
@@ -2155,7 +2300,15 @@ void vTaskSuspendAll( void )
          * configUSE_PREEMPTION is 0, so there may be tasks above the idle priority
          * task that are in the Ready state, even though the idle task is
          * running. */
-        #if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
+        #if ( configUSE_BITMAP_TASK_SELECTION == 1 )
+            {
+                /* Any bit but the one of the idle priority. */
+                if( ( uxTopReadyPriority > ( UBaseType_t ) 0x01 ) || ( uxReadyPriorities[ 0 ] > ( UBaseType_t ) 0x01 ) )
+                {
+                    uxHigherPriorityReadyTasks = pdTRUE;
+                }
+            }
+        #elif ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
             {
                 if( uxTopReadyPriority > tskIDLE_PRIORITY )
                 {
@@ -2489,6 +2642,17 @@ char * pcTaskGetName( TaskHandle_t xTaskToQuery ) /*lint !e971 Unqualified char
                 pxTCB = prvSearchForNameWithinSingleList( ( List_t * ) pxOverflowDelayedTaskList, pcNameToQuery );
             }
 
+            #if ( configUSE_TIMING_WHEEL == 1 )
+                {
+                    UBaseType_t uxSlot;
+
+                    for( uxSlot = 0; ( uxSlot < ( taskWHEEL_SLOTS * 2U ) ) && ( pxTCB == NULL ); uxSlot++ )
+                    {
+                        pxTCB = prvSearchForNameWithinSingleList( &( xWheelSlots[ uxSlot / taskWHEEL_SLOTS ][ uxSlot & taskWHEEL_MASK ] ), pcNameToQuery );
+                    }
+                }
+            #endif
+
             #if ( INCLUDE_vTaskSuspend == 1 )
                 {
                     if( pxTCB == NULL )
@@ -2543,6 +2707,17 @@ char * pcTaskGetName( TaskHandle_t xTaskToQuery ) /*lint !e971 Unqualified char
                 uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxDelayedTaskList, eBlocked );
                 uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxOverflowDelayedTaskList, eBlocked );
 
+                #if ( configUSE_TIMING_WHEEL == 1 )
+                    {
+                        UBaseType_t uxSlot;
+
+                        for( uxSlot = 0; uxSlot < ( taskWHEEL_SLOTS * 2U ); uxSlot++ )
+                        {
+                            uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &( xWheelSlots[ uxSlot / taskWHEEL_SLOTS ][ uxSlot & taskWHEEL_MASK ] ), eBlocked );
+                        }
+                    }
+                #endif
+
                 #if ( INCLUDE_vTaskDelete == 1 )
                     {
                         /* Fill in an TaskStatus_t structure with information on
@@ -2832,6 +3007,26 @@ BaseType_t xTaskIncrementTick( void )
                     #endif /* configUSE_PREEMPTION */
                 }
             }
+
+            #if ( configUSE_TIMING_WHEEL == 1 )
+                {
+                    /* The loop above only handles the tasks too far ahead for
+                     * the wheel. */
+                    TickType_t xWheelNext;
+
+                    if( prvWheelAdvance( xConstTickCount ) != pdFALSE )
+                    {
+                        xSwitchRequired = pdTRUE;
+                    }
+
+                    xWheelNext = prvWheelNextUnblockTime();
+
+                    if( xWheelNext < xNextTaskUnblockTime )
+                    {
+                        xNextTaskUnblockTime = xWheelNext;
+                    }
+                }
+            #endif /* configUSE_TIMING_WHEEL */
         }
 
         /* Tasks of equal priority to the currently running task will share
@@ -3083,7 +3278,7 @@ void vTaskSwitchContext( void )
 }
 /*-----------------------------------------------------------*/
 
-void vTaskPlaceOnEventList( List_t * const pxEventList,
+void vTaskPlaceOnEventList( EventList_t * const pxEventList,
                             const TickType_t xTicksToWait )
 {
     configASSERT( pxEventList );
@@ -3095,7 +3290,15 @@ void vTaskPlaceOnEventList( List_t * const pxEventList,
      * This is placed in the list in priority order so the highest priority task
      * is the first to be woken by the event.  The queue that contains the event
      * list is locked, preventing simultaneous access from interrupts. */
-    vListInsert( pxEventList, &( pxCurrentTCB->xEventListItem ) );
+    #if ( configUSE_PRIORITY_EVENT_LISTS == 1 )
+        {
+            vListInsertEventList( pxEventList, &( pxCurrentTCB->xEventListItem ), pxCurrentTCB->uxPriority );
+        }
+    #else
+        {
+            vListInsert( pxEventList, &( pxCurrentTCB->xEventListItem ) );
+        }
+    #endif
 
     prvAddCurrentTaskToDelayedList( xTicksToWait, pdTRUE );
 }
@@ -3129,7 +3332,7 @@ void vTaskPlaceOnUnorderedEventList( List_t * pxEventList,
 
 #if ( configUSE_TIMERS == 1 )
 
-    void vTaskPlaceOnEventListRestricted( List_t * const pxEventList,
+    void vTaskPlaceOnEventListRestricted( EventList_t * const pxEventList,
                                           TickType_t xTicksToWait,
                                           const BaseType_t xWaitIndefinitely )
     {
@@ -3145,7 +3348,15 @@ void vTaskPlaceOnUnorderedEventList( List_t * pxEventList,
          * In this case it is assume that this is the only task that is going to
          * be waiting on this event list, so the faster vListInsertEnd() function
          * can be used in place of vListInsert. */
-        vListInsertEnd( pxEventList, &( pxCurrentTCB->xEventListItem ) );
+        #if ( configUSE_PRIORITY_EVENT_LISTS == 1 )
+            {
+                vListInsertEventList( pxEventList, &( pxCurrentTCB->xEventListItem ), pxCurrentTCB->uxPriority );
+            }
+        #else
+            {
+                vListInsertEnd( pxEventList, &( pxCurrentTCB->xEventListItem ) );
+            }
+        #endif
 
         /* If the task should block indefinitely then set the block time to a
          * value that will be recognised as an indefinite delay inside the
@@ -3162,7 +3373,7 @@ void vTaskPlaceOnUnorderedEventList( List_t * pxEventList,
 #endif /* configUSE_TIMERS */
 /*-----------------------------------------------------------*/
 
-BaseType_t xTaskRemoveFromEventList( const List_t * const pxEventList )
+BaseType_t xTaskRemoveFromEventList( const EventList_t * const pxEventList )
 {
     TCB_t * pxUnblockedTCB;
     BaseType_t xReturn;
@@ -3179,8 +3390,9 @@ BaseType_t xTaskRemoveFromEventList( const List_t * const pxEventList )
      * means exclusive access to the event list is guaranteed here.
      *
      * This function assumes that a check has already been made to ensure that
-     * pxEventList is not empty. */
-    pxUnblockedTCB = listGET_OWNER_OF_HEAD_ENTRY( pxEventList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+     * pxEventList is not empty.  With configUSE_PRIORITY_EVENT_LISTS set to 1
+     * the head is that of the list of the highest waiting priority. */
+    pxUnblockedTCB = listGET_OWNER_OF_HEAD_ENTRY( listGET_HEAD_EVENT_LIST( pxEventList ) ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
     configASSERT( pxUnblockedTCB );
     ( void ) uxListRemove( &( pxUnblockedTCB->xEventListItem ) );
 
@@ -3649,6 +3861,11 @@ static void prvInitialiseTaskLists( void )
 {
     UBaseType_t uxPriority;
 
+    #if ( configUSE_BITMAP_TASK_SELECTION == 1 )
+        /* uxTopReadyPriority has a bit per word of the bitmap. */
+        configASSERT( taskBITMAP_WORDS <= taskBITMAP_BITS );
+    #endif
+
     for( uxPriority = ( UBaseType_t ) 0U; uxPriority < ( UBaseType_t ) configMAX_PRIORITIES; uxPriority++ )
     {
         vListInitialise( &( pxReadyTasksLists[ uxPriority ] ) );
@@ -3658,6 +3875,20 @@ static void prvInitialiseTaskLists( void )
     vListInitialise( &xDelayedTaskList2 );
     vListInitialise( &xPendingReadyList );
 
+    #if ( configUSE_TIMING_WHEEL == 1 )
+        {
+            UBaseType_t uxSlot;
+
+            for( uxSlot = 0; uxSlot < taskWHEEL_SLOTS; uxSlot++ )
+            {
+                vListInitialise( &( xWheelSlots[ 0 ][ uxSlot ] ) );
+                vListInitialise( &( xWheelSlots[ 1 ][ uxSlot ] ) );
+            }
+
+            xWheelTime = xTickCount;
+        }
+    #endif /* configUSE_TIMING_WHEEL */
+
     #if ( INCLUDE_vTaskDelete == 1 )
         {
             vListInitialise( &xTasksWaitingTermination );
@@ -4003,9 +4234,337 @@ static void prvResetNextTaskUnblockTime( void )
          * from the Blocked state. */
         xNextTaskUnblockTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxDelayedTaskList );
     }
+
+    #if ( configUSE_TIMING_WHEEL == 1 )
+        {
+            TickType_t xWheelNext = prvWheelNextUnblockTime();
+
+            if( xWheelNext < xNextTaskUnblockTime )
+            {
+                xNextTaskUnblockTime = xWheelNext;
+            }
+        }
+    #endif
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+/* Index of the lowest bit set in a word that is not zero, by de Bruijn
+ * multiplication so that it takes the same time on every port. */
+    static UBaseType_t prvWheelLowestBit( uint32_t ulWord )
+    {
+        static const uint8_t ucPositions[ 32 ] =
+        {
+            0U,  1U,  28U, 2U,  29U, 14U, 24U, 3U, 30U, 22U, 20U, 15U, 25U, 17U, 4U,  8U,
+            31U, 27U, 13U, 23U, 21U, 19U, 16U, 7U, 26U, 12U, 18U, 6U,  11U, 5U,  10U, 9U
+        };
+
+        return ( UBaseType_t ) ucPositions[ ( uint32_t ) ( ( ulWord & ( ( uint32_t ) 0U - ulWord ) ) * 0x077CB531UL ) >> 27 ];
+    }
+/*-----------------------------------------------------------*/
+
+/* Offset from uxStart, going round the wheel, of the first slot of uxLevel
+ * that is not empty, or taskWHEEL_SLOTS if they all are. */
+    static UBaseType_t prvWheelFindSlot( UBaseType_t uxLevel,
+                                         UBaseType_t uxStart )
+    {
+        UBaseType_t uxOffset = 0U;
+        UBaseType_t uxSlot;
+        uint32_t ulBits;
+
+        while( uxOffset < taskWHEEL_SLOTS )
+        {
+            uxSlot = ( uxStart + uxOffset ) & taskWHEEL_MASK;
+            ulBits = ulWheelBitmap[ uxLevel ][ uxSlot >> 5 ] >> ( uxSlot & 31U );
+
+            if( ulBits == 0U )
+            {
+                /* Nothing left in this word, on to the next one. */
+                uxOffset += 32U - ( uxSlot & 31U );
+            }
+            else
+            {
+                uxOffset += prvWheelLowestBit( ulBits );
+                uxSlot = ( uxStart + uxOffset ) & taskWHEEL_MASK;
+
+                if( listLIST_IS_EMPTY( &( xWheelSlots[ uxLevel ][ uxSlot ] ) ) == pdFALSE )
+                {
+                    break;
+                }
+
+                /* The tasks of this slot left the Blocked state early. */
+                taskWHEEL_CLEAR_SLOT_BIT( uxLevel, uxSlot );
+            }
+        }
+
+        return ( uxOffset < taskWHEEL_SLOTS ) ? uxOffset : taskWHEEL_SLOTS;
+    }
+/*-----------------------------------------------------------*/
+
+/* Ticks from xFrom to the next tick at which the wheel has to be advanced,
+ * or portMAX_DELAY if it is empty. */
+    static TickType_t prvWheelNextEvent( TickType_t xFrom )
+    {
+        TickType_t xTicks = portMAX_DELAY;
+        TickType_t xSpan;
+        UBaseType_t uxOffset;
+
+        uxOffset = prvWheelFindSlot( 0U, ( UBaseType_t ) ( ( xFrom + ( TickType_t ) 1U ) & taskWHEEL_MASK ) );
+
+        if( uxOffset < taskWHEEL_SLOTS )
+        {
+            xTicks = ( TickType_t ) uxOffset + ( TickType_t ) 1U;
+        }
+
+        /* A level 1 slot is moved down to level 0 at the start of its span. */
+        xSpan = ( xFrom >> configTIMING_WHEEL_BITS ) + ( TickType_t ) 1U;
+        uxOffset = prvWheelFindSlot( 1U, ( UBaseType_t ) ( xSpan & taskWHEEL_MASK ) );
+
+        if( uxOffset < taskWHEEL_SLOTS )
+        {
+            xSpan = ( ( xSpan + ( TickType_t ) uxOffset ) << configTIMING_WHEEL_BITS ) - xFrom;
+
+            if( xSpan < xTicks )
+            {
+                xTicks = xSpan;
+            }
+        }
+
+        return xTicks;
+    }
+/*-----------------------------------------------------------*/
+
+/* Moves the tasks of the level 1 slot whose span starts at xTime down to
+ * level 0. */
+    static void prvWheelCascade( TickType_t xTime )
+    {
+        const UBaseType_t uxSlot = ( UBaseType_t ) ( ( xTime >> configTIMING_WHEEL_BITS ) & taskWHEEL_MASK );
+        List_t * const pxSlot = &( xWheelSlots[ 1 ][ uxSlot ] );
+        ListItem_t * pxItem = listGET_HEAD_ENTRY( pxSlot );
+        ListItem_t * pxNext;
+        TickType_t xTimeToWake;
+        UBaseType_t uxTarget;
+
+        while( pxItem != listGET_END_MARKER( pxSlot ) )
+        {
+            pxNext = listGET_NEXT( pxItem );
+            xTimeToWake = listGET_LIST_ITEM_VALUE( pxItem );
+
+            /* Tasks a whole turn of the wheel ahead stay where they are. */
+            if( ( TickType_t ) ( xTimeToWake - xTime ) < ( TickType_t ) taskWHEEL_SLOTS )
+            {
+                uxTarget = ( UBaseType_t ) ( xTimeToWake & taskWHEEL_MASK );
+                ( void ) uxListRemove( pxItem );
+                vListInsertEnd( &( xWheelSlots[ 0 ][ uxTarget ] ), pxItem );
+                taskWHEEL_SET_SLOT_BIT( 0U, uxTarget );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            pxItem = pxNext;
+        }
+
+        if( listLIST_IS_EMPTY( pxSlot ) != pdFALSE )
+        {
+            taskWHEEL_CLEAR_SLOT_BIT( 1U, uxSlot );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+/* Unblocks the tasks of the level 0 slot of xTime that wake at xTime, in the
+ * order they were delayed.  Returns pdTRUE if a context switch is required. */
+    static BaseType_t prvWheelExpire( TickType_t xTime )
+    {
+        const UBaseType_t uxSlot = ( UBaseType_t ) ( xTime & taskWHEEL_MASK );
+        List_t * const pxSlot = &( xWheelSlots[ 0 ][ uxSlot ] );
+        ListItem_t * pxItem = listGET_HEAD_ENTRY( pxSlot );
+        ListItem_t * pxNext;
+        TCB_t * pxTCB;
+        BaseType_t xSwitchRequired = pdFALSE;
+
+        while( pxItem != listGET_END_MARKER( pxSlot ) )
+        {
+            pxNext = listGET_NEXT( pxItem );
+
+            if( listGET_LIST_ITEM_VALUE( pxItem ) == xTime )
+            {
+                pxTCB = listGET_LIST_ITEM_OWNER( pxItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+                ( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+
+                /* Is the task waiting on an event also?  If so remove it from
+                 * the event list. */
+                if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
+                {
+                    ( void ) uxListRemove( &( pxTCB->xEventListItem ) );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                prvAddTaskToReadyList( pxTCB );
+
+                #if ( configUSE_PREEMPTION == 1 )
+                    {
+                        if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+                        {
+                            xSwitchRequired = pdTRUE;
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
+                #endif /* configUSE_PREEMPTION */
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            pxItem = pxNext;
+        }
+
+        if( listLIST_IS_EMPTY( pxSlot ) != pdFALSE )
+        {
+            taskWHEEL_CLEAR_SLOT_BIT( 0U, uxSlot );
+        }
+
+        return xSwitchRequired;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvWheelInsert( ListItem_t * pxItem,
+                                      TickType_t xTimeToWake,
+                                      TickType_t xConstTickCount )
+    {
+        const TickType_t xTicksToWait = xTimeToWake - xConstTickCount;
+        TickType_t xUnblockTime;
+        UBaseType_t uxLevel;
+        UBaseType_t uxSlot;
+
+        if( xTicksToWait >= taskWHEEL_SPAN )
+        {
+            return pdFALSE;
+        }
+
+        if( uxWheelSlotsUsed == ( UBaseType_t ) 0U )
+        {
+            /* The wheel is empty, so there is no need to go through the ticks
+             * it has not been advanced for. */
+            xWheelTime = xConstTickCount;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( xTicksToWait < ( TickType_t ) taskWHEEL_SLOTS )
+        {
+            uxLevel = 0U;
+            uxSlot = ( UBaseType_t ) ( xTimeToWake & taskWHEEL_MASK );
+            xUnblockTime = xTimeToWake;
+        }
+        else
+        {
+            uxLevel = 1U;
+            uxSlot = ( UBaseType_t ) ( ( xTimeToWake >> configTIMING_WHEEL_BITS ) & taskWHEEL_MASK );
+            xUnblockTime = xTimeToWake & ~( ( TickType_t ) taskWHEEL_MASK );
+        }
+
+        vListInsertEnd( &( xWheelSlots[ uxLevel ][ uxSlot ] ), pxItem );
+        taskWHEEL_SET_SLOT_BIT( uxLevel, uxSlot );
+
+        /* Times that overflowed the tick count are taken into account when
+         * the delayed lists are switched. */
+        if( ( xUnblockTime >= xConstTickCount ) && ( xUnblockTime < xNextTaskUnblockTime ) )
+        {
+            xNextTaskUnblockTime = xUnblockTime;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return pdTRUE;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvWheelAdvance( TickType_t xConstTickCount )
+    {
+        BaseType_t xSwitchRequired = pdFALSE;
+        TickType_t xTicks;
+
+        while( xWheelTime != xConstTickCount )
+        {
+            xTicks = prvWheelNextEvent( xWheelTime );
+
+            if( xTicks > ( TickType_t ) ( xConstTickCount - xWheelTime ) )
+            {
+                /* Nothing is due before xConstTickCount. */
+                xWheelTime = xConstTickCount;
+            }
+            else
+            {
+                xWheelTime += xTicks;
+
+                if( ( xWheelTime & taskWHEEL_MASK ) == 0U )
+                {
+                    prvWheelCascade( xWheelTime );
+                }
+
+                if( prvWheelExpire( xWheelTime ) != pdFALSE )
+                {
+                    xSwitchRequired = pdTRUE;
+                }
+            }
+        }
+
+        return xSwitchRequired;
+    }
+/*-----------------------------------------------------------*/
+
+    static TickType_t prvWheelNextUnblockTime( void )
+    {
+        const TickType_t xConstTickCount = xTickCount;
+        const TickType_t xTicks = prvWheelNextEvent( xWheelTime );
+        TickType_t xNext;
+
+        if( xTicks == portMAX_DELAY )
+        {
+            xNext = portMAX_DELAY;
+        }
+        else if( xTicks <= ( TickType_t ) ( xConstTickCount - xWheelTime ) )
+        {
+            /* The wheel has not been advanced to the tick count yet and may
+             * have something due. */
+            xNext = xConstTickCount;
+        }
+        else
+        {
+            xNext = xWheelTime + xTicks;
+
+            if( xNext < xConstTickCount )
+            {
+                /* After the tick count overflows, this is looked at again
+                 * when the delayed lists are switched. */
+                xNext = portMAX_DELAY;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        return xNext;
+    }
+
+#endif /* configUSE_TIMING_WHEEL */
+/*-----------------------------------------------------------*/
+
 #if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) )
 
     TaskHandle_t xTaskGetCurrentTaskHandle( void )
@@ -5307,6 +5866,14 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
                 /* The list item will be inserted in wake time order. */
                 listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xStateListItem ), xTimeToWake );
 
+                #if ( configUSE_TIMING_WHEEL == 1 )
+                    if( prvWheelInsert( &( pxCurrentTCB->xStateListItem ), xTimeToWake, xConstTickCount ) != pdFALSE )
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                    else
+                #endif
+
                 if( xTimeToWake < xConstTickCount )
                 {
                     /* Wake time has overflowed.  Place this item in the overflow
@@ -5343,6 +5910,14 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
             /* The list item will be inserted in wake time order. */
             listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xStateListItem ), xTimeToWake );
 
+            #if ( configUSE_TIMING_WHEEL == 1 )
+                if( prvWheelInsert( &( pxCurrentTCB->xStateListItem ), xTimeToWake, xConstTickCount ) != pdFALSE )
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+                else
+            #endif
+
             if( xTimeToWake < xConstTickCount )
             {
                 /* Wake time has overflowed.  Place this item in the overflow list. */
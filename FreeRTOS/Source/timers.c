@@ -68,6 +68,44 @@
     #define tmrSTATUS_IS_STATICALLY_ALLOCATED    ( ( uint8_t ) 0x02 )
     #define tmrSTATUS_IS_AUTORELOAD              ( ( uint8_t ) 0x04 )
 
+    #if ( configUSE_TIMER_WHEEL == 1 )
+
+/* Each level of the timer wheel has tmrWHEEL_SLOTS slots.  A level 0 slot
+ * holds the timers expiring at one tick, a level 1 slot the timers expiring in
+ * one span of tmrWHEEL_SLOTS ticks.  One bit per slot records the slots that
+ * may hold timers. */
+        #define tmrWHEEL_SLOTS           ( ( UBaseType_t ) 1U << configTIMER_WHEEL_BITS )
+        #define tmrWHEEL_MASK            ( tmrWHEEL_SLOTS - ( UBaseType_t ) 1U )
+        #define tmrWHEEL_BITMAP_WORDS    ( tmrWHEEL_SLOTS / ( UBaseType_t ) 32U )
+
+/* Timers expiring within tmrWHEEL_SPAN ticks go in the wheel, the others in
+ * the active timer lists. */
+        #define tmrWHEEL_SPAN            ( ( TickType_t ) tmrWHEEL_SLOTS * ( TickType_t ) tmrWHEEL_SLOTS )
+
+/* uxTimerWheelSlotsUsed counts the bits set in both levels, so that an empty
+ * wheel is known without reading the whole bitmap. */
+        #define tmrWHEEL_SLOT_BIT( uxSlot )    ( 1UL << ( ( uxSlot ) & 31U ) )
+
+        #define tmrWHEEL_SET_SLOT_BIT( uxLevel, uxSlot )                                                         \
+    {                                                                                                            \
+        if( ( ulTimerWheelBitmap[ ( uxLevel ) ][ ( uxSlot ) >> 5 ] & tmrWHEEL_SLOT_BIT( uxSlot ) ) == 0U )       \
+        {                                                                                                        \
+            ulTimerWheelBitmap[ ( uxLevel ) ][ ( uxSlot ) >> 5 ] |= tmrWHEEL_SLOT_BIT( uxSlot );                 \
+            uxTimerWheelSlotsUsed++;                                                                             \
+        }                                                                                                        \
+    }
+
+        #define tmrWHEEL_CLEAR_SLOT_BIT( uxLevel, uxSlot )                                                       \
+    {                                                                                                            \
+        if( ( ulTimerWheelBitmap[ ( uxLevel ) ][ ( uxSlot ) >> 5 ] & tmrWHEEL_SLOT_BIT( uxSlot ) ) != 0U )       \
+        {                                                                                                        \
+            ulTimerWheelBitmap[ ( uxLevel ) ][ ( uxSlot ) >> 5 ] &= ~tmrWHEEL_SLOT_BIT( uxSlot );                \
+            uxTimerWheelSlotsUsed--;                                                                             \
+        }                                                                                                        \
+    }
+
+    #endif /* configUSE_TIMER_WHEEL */
+
 /* The definition of the timers themselves. */
     typedef struct tmrTimerControl                  /* The old naming convention is used to prevent breaking kernel aware debuggers. */
     {
@@ -136,6 +174,13 @@
     PRIVILEGED_DATA static List_t * pxCurrentTimerList;
     PRIVILEGED_DATA static List_t * pxOverflowTimerList;
 
+    #if ( configUSE_TIMER_WHEEL == 1 )
+        PRIVILEGED_DATA static List_t xTimerWheelSlots[ 2 ][ tmrWHEEL_SLOTS ];            /*< Active timers expiring within tmrWHEEL_SPAN ticks, level 0 by tick and level 1 by span of tmrWHEEL_SLOTS ticks. */
+        PRIVILEGED_DATA static uint32_t ulTimerWheelBitmap[ 2 ][ tmrWHEEL_BITMAP_WORDS ]; /*< Slots that may not be empty.  Bits are cleared when an empty slot is found. */
+        PRIVILEGED_DATA static UBaseType_t uxTimerWheelSlotsUsed = ( UBaseType_t ) 0U;    /*< Bits set in ulTimerWheelBitmap. */
+        PRIVILEGED_DATA static TickType_t xTimerWheelTime = ( TickType_t ) 0U;           /*< The wheel has been advanced up to this tick. */
+    #endif
+
 /* A queue that is used to send commands to the timer service task. */
     PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
     PRIVILEGED_DATA static TaskHandle_t xTimerTaskHandle = NULL;
@@ -179,6 +224,39 @@
     static void prvProcessExpiredTimer( const TickType_t xNextExpireTime,
                                         const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
 
+/*
+ * Does the work of prvProcessExpiredTimer() for the timer pxTimer, that
+ * expired at xExpiredTime.
+ */
+    static void prvExpireTimer( Timer_t * const pxTimer,
+                                const TickType_t xExpiredTime,
+                                const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+    #if ( configUSE_TIMER_WHEEL == 1 )
+
+/*
+ * Places an active timer in the timer wheel, in O(1).  Returns pdFALSE,
+ * leaving the timer alone, if xNextExpiryTime is too far ahead for the wheel.
+ */
+        static BaseType_t prvTimerWheelInsert( Timer_t * const pxTimer,
+                                               const TickType_t xNextExpiryTime,
+                                               const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+/*
+ * Advances the timer wheel up to xTimeNow, processing the timers that expire
+ * on the way, all the timers of a tick in one pass over its slot.
+ */
+        static void prvTimerWheelAdvance( const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns the number of ticks from xTimeNow to the next tick at which the
+ * wheel has to be advanced, 0 if that tick has been reached, or portMAX_DELAY
+ * if the wheel is empty.
+ */
+        static TickType_t prvTimerWheelTicksToNextEvent( const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+    #endif /* configUSE_TIMER_WHEEL */
+
 /*
  * The tick count has overflowed.  Switch the timer lists after ensuring the
  * current timer list does not still reference some timers.
@@ -508,12 +586,21 @@
     static void prvProcessExpiredTimer( const TickType_t xNextExpireTime,
                                         const TickType_t xTimeNow )
     {
-        BaseType_t xResult;
         Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 
-        /* Remove the timer from the list of active timers.  A check has already
-         * been performed to ensure the list is not empty. */
+        /* A check has already been performed to ensure the list is not
+         * empty. */
+        prvExpireTimer( pxTimer, xNextExpireTime, xTimeNow );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvExpireTimer( Timer_t * const pxTimer,
+                                const TickType_t xExpiredTime,
+                                const TickType_t xTimeNow )
+    {
+        BaseType_t xResult;
 
+        /* Remove the timer from the list of active timers. */
         ( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
         traceTIMER_EXPIRED( pxTimer );
 
@@ -524,11 +611,11 @@
             /* The timer is inserted into a list using a time relative to anything
              * other than the current time.  It will therefore be inserted into the
              * correct list relative to the time this task thinks it is now. */
-            if( prvInsertTimerInActiveList( pxTimer, ( xNextExpireTime + pxTimer->xTimerPeriodInTicks ), xTimeNow, xNextExpireTime ) != pdFALSE )
+            if( prvInsertTimerInActiveList( pxTimer, ( xExpiredTime + pxTimer->xTimerPeriodInTicks ), xTimeNow, xExpiredTime ) != pdFALSE )
             {
                 /* The timer expired before it was added to the active timer
                  * list.  Reload it now.  */
-                xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xNextExpireTime, NULL, tmrNO_DELAY );
+                xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xExpiredTime, NULL, tmrNO_DELAY );
                 configASSERT( xResult );
                 ( void ) xResult;
             }
@@ -570,6 +657,15 @@
 
         for( ; ; )
         {
+            #if ( configUSE_TIMER_WHEEL == 1 )
+                {
+                    /* Process the timers of the wheel that have expired.  The
+                     * lists are switched first if the tick count overflowed,
+                     * as auto-reload timers can be reloaded into them. */
+                    prvTimerWheelAdvance( prvSampleTimeNow( &xListWasEmpty ) );
+                }
+            #endif /* configUSE_TIMER_WHEEL */
+
             /* Query the timers list to see if it contains any timers, and if so,
              * obtain the time at which the next timer will expire. */
             xNextExpireTime = prvGetNextExpireTime( &xListWasEmpty );
@@ -587,9 +683,13 @@
     static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime,
                                             BaseType_t xListWasEmpty )
     {
-        TickType_t xTimeNow;
+        TickType_t xTimeNow, xTicksToWait;
         BaseType_t xTimerListsWereSwitched;
 
+        #if ( configUSE_TIMER_WHEEL == 1 )
+            TickType_t xWheelTicks;
+        #endif
+
         vTaskSuspendAll();
         {
             /* Obtain the time now to make an assessment as to whether the timer
@@ -601,12 +701,28 @@
 
             if( xTimerListsWereSwitched == pdFALSE )
             {
+                #if ( configUSE_TIMER_WHEEL == 1 )
+                    {
+                        xWheelTicks = prvTimerWheelTicksToNextEvent( xTimeNow );
+                    }
+                #endif
+
                 /* The tick count has not overflowed, has the timer expired? */
                 if( ( xListWasEmpty == pdFALSE ) && ( xNextExpireTime <= xTimeNow ) )
                 {
                     ( void ) xTaskResumeAll();
                     prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
                 }
+
+                #if ( configUSE_TIMER_WHEEL == 1 )
+                    else if( xWheelTicks == ( TickType_t ) 0U )
+                    {
+                        /* Timers of the wheel expired since the wheel was
+                         * advanced.  They are processed when this function
+                         * returns. */
+                        ( void ) xTaskResumeAll();
+                    }
+                #endif
                 else
                 {
                     /* The tick count has not overflowed, and the next expire
@@ -622,7 +738,24 @@
                         xListWasEmpty = listLIST_IS_EMPTY( pxOverflowTimerList );
                     }
 
-                    vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
+                    xTicksToWait = xNextExpireTime - xTimeNow;
+
+                    #if ( configUSE_TIMER_WHEEL == 1 )
+                        {
+                            /* Also unblock when the wheel has to be advanced. */
+                            if( ( xWheelTicks != portMAX_DELAY ) && ( ( xListWasEmpty != pdFALSE ) || ( xWheelTicks < xTicksToWait ) ) )
+                            {
+                                xTicksToWait = xWheelTicks;
+                                xListWasEmpty = pdFALSE;
+                            }
+                            else
+                            {
+                                mtCOVERAGE_TEST_MARKER();
+                            }
+                        }
+                    #endif /* configUSE_TIMER_WHEEL */
+
+                    vQueueWaitForMessageRestricted( xTimerQueue, xTicksToWait, xListWasEmpty );
 
                     if( xTaskResumeAll() == pdFALSE )
                     {
@@ -718,7 +851,12 @@
             }
             else
             {
-                vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+                #if ( configUSE_TIMER_WHEEL == 1 )
+                    if( prvTimerWheelInsert( pxTimer, xNextExpiryTime, xTimeNow ) == pdFALSE )
+                #endif
+                {
+                    vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+                }
             }
         }
         else
@@ -732,7 +870,12 @@
             }
             else
             {
-                vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+                #if ( configUSE_TIMER_WHEEL == 1 )
+                    if( prvTimerWheelInsert( pxTimer, xNextExpiryTime, xTimeNow ) == pdFALSE )
+                #endif
+                {
+                    vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+                }
             }
         }
 
@@ -950,6 +1093,264 @@
     }
 /*-----------------------------------------------------------*/
 
+    #if ( configUSE_TIMER_WHEEL == 1 )
+
+/* Index of the lowest bit set in a word that is not zero, by de Bruijn
+ * multiplication so that it takes the same time on every port. */
+        static UBaseType_t prvTimerWheelLowestBit( uint32_t ulWord )
+        {
+            static const uint8_t ucPositions[ 32 ] =
+            {
+                0U,  1U,  28U, 2U,  29U, 14U, 24U, 3U, 30U, 22U, 20U, 15U, 25U, 17U, 4U,  8U,
+                31U, 27U, 13U, 23U, 21U, 19U, 16U, 7U, 26U, 12U, 18U, 6U,  11U, 5U,  10U, 9U
+            };
+
+            return ( UBaseType_t ) ucPositions[ ( uint32_t ) ( ( ulWord & ( ( uint32_t ) 0U - ulWord ) ) * 0x077CB531UL ) >> 27 ];
+        }
+/*-----------------------------------------------------------*/
+
+/* Offset from uxStart, going round the wheel, of the first slot of uxLevel
+ * that is not empty, or tmrWHEEL_SLOTS if they all are. */
+        static UBaseType_t prvTimerWheelFindSlot( UBaseType_t uxLevel,
+                                                  UBaseType_t uxStart )
+        {
+            UBaseType_t uxOffset = 0U;
+            UBaseType_t uxSlot;
+            uint32_t ulBits;
+
+            while( uxOffset < tmrWHEEL_SLOTS )
+            {
+                uxSlot = ( uxStart + uxOffset ) & tmrWHEEL_MASK;
+                ulBits = ulTimerWheelBitmap[ uxLevel ][ uxSlot >> 5 ] >> ( uxSlot & 31U );
+
+                if( ulBits == 0U )
+                {
+                    /* Nothing left in this word, on to the next one. */
+                    uxOffset += 32U - ( uxSlot & 31U );
+                }
+                else
+                {
+                    uxOffset += prvTimerWheelLowestBit( ulBits );
+                    uxSlot = ( uxStart + uxOffset ) & tmrWHEEL_MASK;
+
+                    if( listLIST_IS_EMPTY( &( xTimerWheelSlots[ uxLevel ][ uxSlot ] ) ) == pdFALSE )
+                    {
+                        break;
+                    }
+
+                    /* The timers of this slot were stopped, changed or
+                     * deleted. */
+                    tmrWHEEL_CLEAR_SLOT_BIT( uxLevel, uxSlot );
+                }
+            }
+
+            return ( uxOffset < tmrWHEEL_SLOTS ) ? uxOffset : tmrWHEEL_SLOTS;
+        }
+/*-----------------------------------------------------------*/
+
+/* Ticks from xFrom to the next tick at which the wheel has to be advanced,
+ * or portMAX_DELAY if it is empty. */
+        static TickType_t prvTimerWheelNextEvent( TickType_t xFrom )
+        {
+            TickType_t xTicks = portMAX_DELAY;
+            TickType_t xSpan;
+            UBaseType_t uxOffset;
+
+            uxOffset = prvTimerWheelFindSlot( 0U, ( UBaseType_t ) ( ( xFrom + ( TickType_t ) 1U ) & tmrWHEEL_MASK ) );
+
+            if( uxOffset < tmrWHEEL_SLOTS )
+            {
+                xTicks = ( TickType_t ) uxOffset + ( TickType_t ) 1U;
+            }
+
+            /* A level 1 slot is moved down to level 0 at the start of its span. */
+            xSpan = ( xFrom >> configTIMER_WHEEL_BITS ) + ( TickType_t ) 1U;
+            uxOffset = prvTimerWheelFindSlot( 1U, ( UBaseType_t ) ( xSpan & tmrWHEEL_MASK ) );
+
+            if( uxOffset < tmrWHEEL_SLOTS )
+            {
+                xSpan = ( ( xSpan + ( TickType_t ) uxOffset ) << configTIMER_WHEEL_BITS ) - xFrom;
+
+                if( xSpan < xTicks )
+                {
+                    xTicks = xSpan;
+                }
+            }
+
+            return xTicks;
+        }
+/*-----------------------------------------------------------*/
+
+/* Moves the timers of the level 1 slot whose span starts at xTime down to
+ * level 0. */
+        static void prvTimerWheelCascade( TickType_t xTime )
+        {
+            const UBaseType_t uxSlot = ( UBaseType_t ) ( ( xTime >> configTIMER_WHEEL_BITS ) & tmrWHEEL_MASK );
+            List_t * const pxSlot = &( xTimerWheelSlots[ 1 ][ uxSlot ] );
+            ListItem_t * pxItem = listGET_HEAD_ENTRY( pxSlot );
+            ListItem_t * pxNext;
+            TickType_t xExpiryTime;
+            UBaseType_t uxTarget;
+
+            while( pxItem != listGET_END_MARKER( pxSlot ) )
+            {
+                pxNext = listGET_NEXT( pxItem );
+                xExpiryTime = listGET_LIST_ITEM_VALUE( pxItem );
+
+                /* Timers a whole turn of the wheel ahead stay where they are. */
+                if( ( TickType_t ) ( xExpiryTime - xTime ) < ( TickType_t ) tmrWHEEL_SLOTS )
+                {
+                    uxTarget = ( UBaseType_t ) ( xExpiryTime & tmrWHEEL_MASK );
+                    ( void ) uxListRemove( pxItem );
+                    vListInsertEnd( &( xTimerWheelSlots[ 0 ][ uxTarget ] ), pxItem );
+                    tmrWHEEL_SET_SLOT_BIT( 0U, uxTarget );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                pxItem = pxNext;
+            }
+
+            if( listLIST_IS_EMPTY( pxSlot ) != pdFALSE )
+            {
+                tmrWHEEL_CLEAR_SLOT_BIT( 1U, uxSlot );
+            }
+        }
+/*-----------------------------------------------------------*/
+
+/* Processes the timers of the level 0 slot of xTime that expire at xTime, in
+ * the order they were started. */
+        static void prvTimerWheelExpire( TickType_t xTime,
+                                         const TickType_t xTimeNow )
+        {
+            const UBaseType_t uxSlot = ( UBaseType_t ) ( xTime & tmrWHEEL_MASK );
+            List_t * const pxSlot = &( xTimerWheelSlots[ 0 ][ uxSlot ] );
+            ListItem_t * pxItem = listGET_HEAD_ENTRY( pxSlot );
+            ListItem_t * pxNext;
+
+            /* Auto-reload timers reloaded into this slot expire at a later
+             * turn of the wheel, so are passed over. */
+            while( pxItem != listGET_END_MARKER( pxSlot ) )
+            {
+                pxNext = listGET_NEXT( pxItem );
+
+                if( listGET_LIST_ITEM_VALUE( pxItem ) == xTime )
+                {
+                    prvExpireTimer( ( Timer_t * ) listGET_LIST_ITEM_OWNER( pxItem ), xTime, xTimeNow ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                pxItem = pxNext;
+            }
+
+            if( listLIST_IS_EMPTY( pxSlot ) != pdFALSE )
+            {
+                tmrWHEEL_CLEAR_SLOT_BIT( 0U, uxSlot );
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvTimerWheelInsert( Timer_t * const pxTimer,
+                                               const TickType_t xNextExpiryTime,
+                                               const TickType_t xTimeNow )
+        {
+            const TickType_t xTicksToExpiry = xNextExpiryTime - xTimeNow;
+            UBaseType_t uxLevel;
+            UBaseType_t uxSlot;
+
+            if( xTicksToExpiry >= tmrWHEEL_SPAN )
+            {
+                return pdFALSE;
+            }
+
+            if( uxTimerWheelSlotsUsed == ( UBaseType_t ) 0U )
+            {
+                /* The wheel is empty, so there is no need to go through the
+                 * ticks it has not been advanced for. */
+                xTimerWheelTime = xTimeNow;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            if( xTicksToExpiry < ( TickType_t ) tmrWHEEL_SLOTS )
+            {
+                uxLevel = 0U;
+                uxSlot = ( UBaseType_t ) ( xNextExpiryTime & tmrWHEEL_MASK );
+            }
+            else
+            {
+                uxLevel = 1U;
+                uxSlot = ( UBaseType_t ) ( ( xNextExpiryTime >> configTIMER_WHEEL_BITS ) & tmrWHEEL_MASK );
+            }
+
+            vListInsertEnd( &( xTimerWheelSlots[ uxLevel ][ uxSlot ] ), &( pxTimer->xTimerListItem ) );
+            tmrWHEEL_SET_SLOT_BIT( uxLevel, uxSlot );
+
+            return pdTRUE;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvTimerWheelAdvance( const TickType_t xTimeNow )
+        {
+            TickType_t xTicks;
+
+            while( xTimerWheelTime != xTimeNow )
+            {
+                xTicks = prvTimerWheelNextEvent( xTimerWheelTime );
+
+                if( xTicks > ( TickType_t ) ( xTimeNow - xTimerWheelTime ) )
+                {
+                    /* Nothing expires before xTimeNow. */
+                    xTimerWheelTime = xTimeNow;
+                }
+                else
+                {
+                    xTimerWheelTime += xTicks;
+
+                    if( ( xTimerWheelTime & tmrWHEEL_MASK ) == 0U )
+                    {
+                        prvTimerWheelCascade( xTimerWheelTime );
+                    }
+
+                    prvTimerWheelExpire( xTimerWheelTime, xTimeNow );
+                }
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        static TickType_t prvTimerWheelTicksToNextEvent( const TickType_t xTimeNow )
+        {
+            const TickType_t xTicks = prvTimerWheelNextEvent( xTimerWheelTime );
+            const TickType_t xElapsed = xTimeNow - xTimerWheelTime;
+            TickType_t xReturn;
+
+            if( xTicks == portMAX_DELAY )
+            {
+                xReturn = portMAX_DELAY;
+            }
+            else if( xTicks <= xElapsed )
+            {
+                xReturn = ( TickType_t ) 0U;
+            }
+            else
+            {
+                xReturn = xTicks - xElapsed;
+            }
+
+            return xReturn;
+        }
+/*-----------------------------------------------------------*/
+
+    #endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
     static void prvCheckForValidListAndQueue( void )
     {
         /* Check that the list from which active timers are referenced, and the
@@ -964,6 +1365,20 @@
                 pxCurrentTimerList = &xActiveTimerList1;
                 pxOverflowTimerList = &xActiveTimerList2;
 
+                #if ( configUSE_TIMER_WHEEL == 1 )
+                    {
+                        UBaseType_t uxSlot;
+
+                        for( uxSlot = 0U; uxSlot < tmrWHEEL_SLOTS; uxSlot++ )
+                        {
+                            vListInitialise( &( xTimerWheelSlots[ 0 ][ uxSlot ] ) );
+                            vListInitialise( &( xTimerWheelSlots[ 1 ][ uxSlot ] ) );
+                        }
+
+                        xTimerWheelTime = xTaskGetTickCount();
+                    }
+                #endif /* configUSE_TIMER_WHEEL */
+
                 #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
                     {
                         /* The timer queue is allocated statically in case